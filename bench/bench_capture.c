@@ -0,0 +1,55 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-10-19
+ */
+#include <tapi/tapi.h>
+
+/*! @uses tapi_capture_make, tapi_capture_end, tapi_capture_destroy. */
+#include <tapi/capture.h>
+
+/*! @uses tapi_bench_t, etc... */
+#include <tapi/bench.h>
+
+/*! @uses fwrite, stdout. */
+#include <stdio.h>
+
+/*! @uses memset. */
+#include <string.h>
+
+/* the outputs written while capturing; the large one has to fit in a pipe (64 kib). */
+static char l_small[64u], l_large[32768u];
+
+/* the sink everything is captured into. */
+static tapi_sink_t* l_sink;
+
+/* region for all of the benchmark bodies. */
+#pragma region bench bodies
+void bench_capture(tapi_bench_state_t* state) {
+    l_sink->buffer.length = 0u;
+    tapi_capture_t* capture = tapi_capture_make(l_sink, stdout);
+    fwrite(state->data, 1u, state->size, stdout);
+    tapi_capture_end(capture);
+    tapi_capture_destroy(capture);
+}
+#pragma endregion
+
+/* make a capture benchmark writing an output. */
+static void
+add_bench(const char* name, char* output, size_t size) {
+    tapi_bench_t* bench = tapi_bench_make(name, bench_capture);
+    /* NOLINTNEXTLINE */
+    memset(output, 'x', size);
+    bench->data = output;
+    bench->size = size;
+    tapi_bench_add(bench);
+}
+
+int main() {
+    l_sink = tapi_sink_make();
+    tapi_sink_setdbf(l_sink, sizeof l_large);
+    add_bench("tapi_capture/64b", l_small, sizeof l_small);
+    add_bench("tapi_capture/32kib", l_large, sizeof l_large);
+    int result = tapi_bench_run();
+    tapi_sink_destroy(l_sink);
+    return result;
+}
@@ -0,0 +1,129 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-10-19
+ */
+#include <tapi/tapi.h>
+
+/*! @uses dyna_t, dyna_create, dyna_push, dyna_pop, dyna_free, dyna_define. */
+#include <tapi/dyna.h>
+
+/*! @uses tapi_bench_t, etc... */
+#include <tapi/bench.h>
+
+/* a typed vector of pointers, compared against dyna_t. */
+dyna_define(ptrs, void*, 16u)
+
+/* the arrays pushed to and popped from, kept at a steady length between operations. */
+static dyna_t* l_array;
+static ptrs_t l_vector;
+
+/* region for all of the benchmark bodies. */
+#pragma region bench bodies
+void bench_push_pop_back(tapi_bench_state_t* state) {
+    dyna_push(l_array, state);
+    tapi_bench_keep(dyna_pop(l_array, l_array->length - 1u));
+}
+
+void bench_push_pop_front(tapi_bench_state_t* state) {
+    dyna_push(l_array, state);
+    tapi_bench_keep(dyna_pop(l_array, 0u));
+}
+
+void bench_fill(tapi_bench_state_t* state) {
+    dyna_t* array = dyna_create();
+    for (size_t i = 0u; i < 1024u; i++)
+        dyna_push(array, state);
+    dyna_free(array);
+}
+
+void bench_scan(tapi_bench_state_t* state) {
+    (void) state;
+    size_t sum = 0u;
+    _foreach(l_array, char*, item)
+        sum += (size_t) item;
+    _endforeach;
+    tapi_bench_keep(sum);
+}
+
+void bench_vec_push_pop_back(tapi_bench_state_t* state) {
+    ptrs_push(&l_vector, state);
+    tapi_bench_keep(ptrs_pop(&l_vector));
+}
+
+void bench_vec_swap_remove_front(tapi_bench_state_t* state) {
+    ptrs_push(&l_vector, state);
+    tapi_bench_keep(ptrs_swap_remove(&l_vector, 0u));
+}
+
+void bench_vec_fill(tapi_bench_state_t* state) {
+    ptrs_t vector = { 0 };
+    for (size_t i = 0u; i < 1024u; i++)
+        ptrs_push(&vector, state);
+    ptrs_free(&vector);
+}
+
+void bench_vec_fill_reserved(tapi_bench_state_t* state) {
+    ptrs_t vector = { 0 };
+    ptrs_reserve(&vector, 1024u);
+    for (size_t i = 0u; i < 1024u; i++)
+        ptrs_push(&vector, state);
+    ptrs_free(&vector);
+}
+
+void bench_vec_scan(tapi_bench_state_t* state) {
+    (void) state;
+    size_t sum = 0u;
+    _vforeach(&l_vector, char*, item)
+        sum += (size_t) item;
+    _endforeach;
+    tapi_bench_keep(sum);
+}
+#pragma endregion
+
+/* region for the setup of the steady arrays. */
+#pragma region setup
+void setup_array(void) {
+    l_array = dyna_create();
+    for (size_t i = 0u; i < 256u; i++)
+        dyna_push(l_array, &l_array);
+}
+
+void teardown_array(void) {
+    dyna_free(l_array);
+}
+
+void setup_vector(void) {
+    for (size_t i = 0u; i < 256u; i++)
+        ptrs_push(&l_vector, &l_vector);
+}
+
+void teardown_vector(void) {
+    ptrs_free(&l_vector);
+}
+#pragma endregion
+
+/* make a benchmark against a steady array. */
+static void
+add_bench(const char* name, tapi_bench_func_t function, tapi_gen_func_t setup,
+          tapi_gen_func_t teardown) {
+    tapi_bench_t* bench = tapi_bench_make(name, function);
+    bench->setup = setup;
+    bench->teardown = teardown;
+    tapi_bench_add(bench);
+}
+
+int main() {
+    add_bench("dyna_push+pop/back/256", bench_push_pop_back, setup_array, teardown_array);
+    add_bench("dyna_push+pop/front/256", bench_push_pop_front, setup_array, teardown_array);
+    add_bench("dyna_push/1024", bench_fill, setup_array, teardown_array);
+    add_bench("dyna_scan/256", bench_scan, setup_array, teardown_array);
+    add_bench("vec_push+pop/back/256", bench_vec_push_pop_back, setup_vector,
+              teardown_vector);
+    add_bench("vec_push+swap_remove/front/256", bench_vec_swap_remove_front, setup_vector,
+              teardown_vector);
+    add_bench("vec_push/1024", bench_vec_fill, setup_vector, teardown_vector);
+    add_bench("vec_push/reserved/1024", bench_vec_fill_reserved, setup_vector,
+              teardown_vector);
+    add_bench("vec_scan/256", bench_vec_scan, setup_vector, teardown_vector);
+    return tapi_bench_run();
+}
@@ -0,0 +1,126 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-10-19
+ */
+#include <tapi/tapi.h>
+
+/*! @uses tapi_mock_create, tapi_mock_apply, tapi_mock_restore, tapi_mock_apply_all, etc... */
+#include <tapi/mock.h>
+
+/*! @uses tapi_bench_t, etc... */
+#include <tapi/bench.h>
+
+/*! @uses det_function_size, det_call_target, det_decode. */
+#include "det.h"
+
+/* region for the functions that are analyzed and mocked. */
+#pragma region call targets
+#define X4(s) s s s s
+#define X16(s) X4(X4(s))
+#define X128(s) X4(X4(X4(X4(s)))) X4(X4(X4(X4(s))))
+
+volatile int counter;
+
+__attribute__((noinline)) int target_function(void) {
+    return counter + 1;
+}
+
+__attribute__((noinline)) int mocked_function(void) {
+    return 0;
+}
+
+/* the call is at the end of each function, so it is found last; the increment after it
+ *  keeps it from becoming a tail call. */
+__attribute__((noinline)) int function_small(void) {
+    int result = target_function();
+    counter++;
+    return result;
+}
+
+__attribute__((noinline)) int function_medium(void) {
+    X16(counter++;)
+    int result = target_function();
+    counter++;
+    return result;
+}
+
+__attribute__((noinline)) int function_large(void) {
+    X128(counter++;)
+    int result = target_function();
+    counter++;
+    return result;
+}
+#pragma endregion
+
+/* region for all of the benchmark bodies. */
+#pragma region bench bodies
+void bench_function_size(tapi_bench_state_t* state) {
+    tapi_bench_keep(det_function_size(state->data, 0x1000));
+}
+
+void bench_call_target(tapi_bench_state_t* state) {
+    det_call_t call;
+    tapi_bench_keep(det_call_target(state->data, (void*) target_function, &call));
+}
+
+/* the uncached path, every call decodes the function again. */
+void bench_decode(tapi_bench_state_t* state) {
+    det_scan_t scan;
+    tapi_bench_keep(det_decode(state->data, det_function_size(state->data, 0x1000), &scan));
+}
+
+void bench_mock_create(tapi_bench_state_t* state) {
+    (void) state;
+    tapi_bench_keep(tapi_mock_create((void*) function_medium, (void*) target_function,
+                                     (void*) mocked_function));
+}
+
+void bench_mock_cycle(tapi_bench_state_t* state) {
+    tapi_mock_apply(state->data);
+    tapi_mock_restore(state->data);
+}
+
+/* one mock per caller, applied one by one and then as a single batch. */
+static tapi_mock_t* l_mocks[3u];
+
+void bench_mock_cycle_each(tapi_bench_state_t* state) {
+    (void) state;
+    for (size_t i = 0u; i < 3u; i++)
+        tapi_mock_apply(l_mocks[i]);
+    for (size_t i = 0u; i < 3u; i++)
+        tapi_mock_restore(l_mocks[i]);
+}
+
+void bench_mock_cycle_all(tapi_bench_state_t* state) {
+    (void) state;
+    tapi_mock_apply_all(l_mocks, 3u);
+    tapi_mock_restore_all(l_mocks, 3u);
+}
+#pragma endregion
+
+/* make a benchmark with data. */
+static tapi_bench_t*
+add_bench(const char* name, tapi_bench_func_t function, void* data) {
+    tapi_bench_t* bench = tapi_bench_make(name, function);
+    bench->data = data;
+    tapi_bench_add(bench);
+    return bench;
+}
+
+int main() {
+    add_bench("det_function_size/small", bench_function_size, (void*) function_small);
+    add_bench("det_function_size/medium", bench_function_size, (void*) function_medium);
+    add_bench("det_function_size/large", bench_function_size, (void*) function_large);
+    add_bench("det_call_target/small", bench_call_target, (void*) function_small);
+    add_bench("det_call_target/medium", bench_call_target, (void*) function_medium);
+    add_bench("det_call_target/large", bench_call_target, (void*) function_large);
+    add_bench("det_decode/small", bench_decode, (void*) function_small);
+    add_bench("det_decode/medium", bench_decode, (void*) function_medium);
+    add_bench("det_decode/large", bench_decode, (void*) function_large);
+    /* mocks live until the program exits, so creation runs a fixed number of times. */
+    add_bench("tapi_mock_create", bench_mock_create, 0x0)->iterations = 1000u;
+    add_bench("tapi_mock_apply+restore", bench_mock_cycle,
+              tapi_mock_create((void*) function_medium, (void*) target_function,
+                               (void*) mocked_function));
+    return tapi_bench_run();
+}
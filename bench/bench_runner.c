@@ -0,0 +1,71 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-10-19
+ */
+/* we have to define this to use fileno() and dup(). */
+#define _POSIX_C_SOURCE 200809L
+
+#include <tapi/tapi.h>
+
+/*! @uses tapi_bench_t, etc... */
+#include <tapi/bench.h>
+
+/*! @uses fflush, stdout. */
+#include <stdio.h>
+
+/*! @uses open, O_WRONLY. */
+#include <fcntl.h>
+
+/*! @uses dup, dup2, close. */
+#include <unistd.h>
+
+/* number of empty tests in the suite; a run of the suite is one operation. */
+#define EMPTY_TESTS 16u
+
+/* the saved stdout, while the runner writes to /dev/null. */
+static int l_stdout = -1;
+
+/* region for the empty tests and the benchmark body. */
+#pragma region bench bodies
+e_tapi_test_result_t test_empty() {
+    return E_TAPI_TEST_RESULT_PASSED;
+}
+
+void bench_runner(tapi_bench_state_t* state) {
+    (void) state;
+    tapi_test_run();
+}
+#pragma endregion
+
+/* region for silencing the runner. */
+#pragma region setup
+void setup_silence(void) {
+    fflush(stdout);
+    l_stdout = dup(fileno(stdout));
+    int null = open("/dev/null", O_WRONLY);
+    dup2(null, fileno(stdout));
+    close(null);
+}
+
+void teardown_silence(void) {
+    fflush(stdout);
+    dup2(l_stdout, fileno(stdout));
+    close(l_stdout);
+}
+#pragma endregion
+
+int main() {
+    /* the per-test overhead is the time of an operation divided by EMPTY_TESTS. */
+    tapi_test_t* tests[EMPTY_TESTS];
+    for (size_t i = 0u; i < EMPTY_TESTS; i++)
+        tests[i] = tapi_test_make("test_empty", test_empty);
+    tapi_test_setup(tests, EMPTY_TESTS);
+
+    tapi_bench_t* bench = tapi_bench_make("tapi_test_run/16_empty", bench_runner);
+    bench->setup = setup_silence;
+    bench->teardown = teardown_silence;
+    tapi_bench_add(bench);
+    int result = tapi_bench_run();
+    tapi_test_destroy(tests, EMPTY_TESTS);
+    return result;
+}
@@ -0,0 +1,103 @@
+/**
+ * \cond
+ * @author Sean Hobeck
+ * @date 2026-10-19
+ */
+#ifndef TAPI_ARENA_H
+#define TAPI_ARENA_H
+
+/*! @uses TAPI_EXPORT. */
+#include <tapi/tapi.h>
+
+/*! @uses size_t. */
+#include <stddef.h>
+/** \endcond */
+
+/** a single mmap'd chunk of an arena; the header lives at the start of the chunk. */
+typedef struct tapi_arena_chunk {
+    /** the next chunk, reused after a reset. */
+    struct tapi_arena_chunk* next;
+    /** size of the chunk (including this header), and bytes handed out of it. */
+    size_t size, used;
+} tapi_arena_chunk_t;
+
+/**
+ * @brief a bump-pointer arena for scratch memory.
+ *
+ * `tapi_arena_t` hands out memory by bumping a pointer through mmap'd chunks; nothing is freed
+ *   on its own, instead the whole arena is reset at once, which keeps its chunks for reuse. the
+ *   runner resets the arena returned by tapi_arena() after every test, so tests and fixtures
+ *   can allocate scratch data from it without any free bookkeeping.
+ *
+ * @see tapi_arena()
+ * @see tapi_arena_make()
+ * @see tapi_arena_alloc()
+ * @see tapi_arena_reset()
+ * @see tapi_arena_destroy()
+ */
+typedef struct {
+    /** the first chunk, and the one being bumped through. */
+    tapi_arena_chunk_t* first, *current;
+    /** the size of a new chunk. */
+    size_t chunk_size;
+} tapi_arena_t;
+
+/**
+ * @brief make an empty arena; chunks are mapped on first use.
+ *
+ * @param chunk_size the size of a chunk (rounded up to pages), 0 for 1 MiB.
+ * @return a pointer to an allocated arena.
+ */
+TAPI_EXPORT tapi_arena_t*
+tapi_arena_make(size_t chunk_size);
+
+/**
+ * @brief allocate memory from an arena, aligned to 16 bytes; allocations larger than a chunk
+ *  get a chunk of their own.
+ *
+ * @param arena the arena to allocate from.
+ * @param size the number of bytes.
+ * @return a pointer to the memory, or 0x0 if a chunk could not be mapped.
+ */
+TAPI_EXPORT void*
+tapi_arena_alloc(tapi_arena_t* arena, size_t size);
+
+/**
+ * @brief allocate aligned memory from an arena.
+ *
+ * @param arena the arena to allocate from.
+ * @param size the number of bytes.
+ * @param alignment the alignment, a power of two.
+ * @return a pointer to the memory, or 0x0 if a chunk could not be mapped.
+ */
+TAPI_EXPORT void*
+tapi_arena_alloc_aligned(tapi_arena_t* arena, size_t size, size_t alignment);
+
+/**
+ * @brief release everything allocated from an arena at once, keeping its chunks.
+ *
+ * @param arena the arena to be reset.
+ */
+TAPI_EXPORT void
+tapi_arena_reset(tapi_arena_t* arena);
+
+/**
+ * @brief unmap every chunk of an arena and free it.
+ *
+ * @param arena the arena to be destroyed.
+ */
+TAPI_EXPORT void
+tapi_arena_destroy(tapi_arena_t* arena);
+
+/**
+ * @brief get the arena of the test suite, which the runner resets after every test.
+ *
+ * @return the arena of the test suite.
+ */
+TAPI_EXPORT tapi_arena_t*
+tapi_arena(void);
+
+/** allocate a number of objects of a type from the arena of the test suite. */
+#define tapi_arena_new(type, count) \
+    ((type*) tapi_arena_alloc_aligned(tapi_arena(), sizeof(type) * (count), _Alignof(type)))
+#endif /* TAPI_ARENA_H */
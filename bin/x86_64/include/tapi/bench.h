@@ -0,0 +1,410 @@
+/**
+ * \cond
+ * @author Sean Hobeck
+ * @date 2026-10-19
+ */
+#ifndef TAPI_BENCH_H
+#define TAPI_BENCH_H
+
+/*! @uses TAPI_EXPORT, e_tapi_test_result_t, tapi_gen_func_t. */
+#include <tapi/tapi.h>
+
+/*! @uses tapi_hist_t, tapi_stream_t. */
+#include <tapi/hist.h>
+
+/*! @uses size_t. */
+#include <stddef.h>
+/** \endcond */
+
+/**
+ * @brief the per-operation state handed to a benchmark body.
+ *
+ * `tapi_bench_state_t` is passed to every call of a benchmark function; the harness calls the
+ *   body once per measured operation, and owns the timing loop around it.
+ */
+typedef struct {
+    /** index of the current operation within the sample. */
+    size_t index;
+    /** the input size of the current point of a sweep (see tapi_bench_sweep()), 0 o.w. */
+    size_t size;
+    /** user data attached to the benchmark (see tapi_bench_t::data). */
+    void* data;
+    /** index of the thread running the body, and the number of threads running it. */
+    size_t thread, threads;
+} tapi_bench_state_t;
+
+/** a function pointer type for benchmark bodies, called once per operation. */
+typedef void (*tapi_bench_func_t)(tapi_bench_state_t* state);
+
+/** enum for what a benchmark run does with the baseline file. */
+typedef enum {
+    E_TAPI_BENCH_BASELINE_NONE = 0x0, /** do not use a baseline. */
+    E_TAPI_BENCH_BASELINE_SAVE, /** write the results of this run to the baseline. */
+    E_TAPI_BENCH_BASELINE_COMPARE, /** compare the results of this run against the baseline. */
+} e_tapi_bench_baseline_t;
+
+/** enum for the isolation a benchmark run asks for, besides pinning to a cpu. */
+typedef enum {
+    E_TAPI_BENCH_ISOLATE_NONE = 0x0, /** no isolation. */
+    E_TAPI_BENCH_ISOLATE_FIFO = 0x1, /** run under the SCHED_FIFO real-time policy. */
+    E_TAPI_BENCH_ISOLATE_MLOCK = 0x2, /** lock all current and future memory with mlockall. */
+} e_tapi_bench_isolate_t;
+
+/** enum for the conditions a benchmark ran under; the first three are applied isolation,
+ *  the rest are sources of noise that were detected. */
+typedef enum {
+    E_TAPI_BENCH_ENV_PINNED = 0x1, /** the thread was pinned to a single cpu. */
+    E_TAPI_BENCH_ENV_FIFO = 0x2, /** the thread ran under SCHED_FIFO. */
+    E_TAPI_BENCH_ENV_MLOCK = 0x4, /** memory was locked. */
+    E_TAPI_BENCH_ENV_GOVERNOR = 0x8, /** the cpu frequency governor is not 'performance'. */
+    E_TAPI_BENCH_ENV_TURBO = 0x10, /** turbo/ boost frequencies are enabled. */
+    E_TAPI_BENCH_ENV_SMT = 0x20, /** the cpu has an active smt (hyper-thread) sibling. */
+    E_TAPI_BENCH_ENV_LOADED = 0x40, /** the machine was loaded by other work. */
+} e_tapi_bench_env_t;
+
+/** enum for the cache state a benchmark is timed in. */
+typedef enum {
+    E_TAPI_BENCH_CACHE_WARM = 0x0, /** back-to-back operations, the caches stay warm. */
+    E_TAPI_BENCH_CACHE_COLD, /** the caches are evicted before every operation. */
+    E_TAPI_BENCH_CACHE_BOTH, /** timed warm (compared against the baseline) and cold. */
+} e_tapi_bench_cache_t;
+
+/** the environment a benchmark ran in, recorded next to its results. */
+typedef struct {
+    /** the cpu the benchmark ran on. */
+    int cpu;
+    /** the frequency governor of that cpu ("" if unknown). */
+    char governor[32];
+    /** the 1-minute load average when the benchmark ran. */
+    double load;
+    /** the conditions the benchmark ran under, see e_tapi_bench_env_t. */
+    unsigned int flags;
+} tapi_bench_env_t;
+
+/** enum for the complexity classes a size sweep is fitted against. */
+typedef enum {
+    E_TAPI_BENCH_O_NONE = 0x0, /** not fitted. */
+    E_TAPI_BENCH_O_1, /** constant. */
+    E_TAPI_BENCH_O_LOGN, /** logarithmic. */
+    E_TAPI_BENCH_O_N, /** linear. */
+    E_TAPI_BENCH_O_NLOGN, /** linearithmic. */
+    E_TAPI_BENCH_O_N2, /** quadratic. */
+} e_tapi_bench_complexity_t;
+
+/** the result of fitting a size sweep to a complexity class, t(n) = coef * f(n). */
+typedef struct {
+    /** the best fitting class. */
+    e_tapi_bench_complexity_t complexity;
+    /** the coefficient in nanoseconds, and the root-mean-square relative error. */
+    double coef, rms;
+} tapi_bench_fit_t;
+
+/** a single point of a size sweep. */
+typedef struct {
+    /** the input size, and the median time per operation at it. */
+    size_t size;
+    double median;
+} tapi_bench_point_t;
+
+/** the throughput of a benchmark at a single thread count. */
+typedef struct {
+    /** the number of threads. */
+    size_t threads;
+    /** operations per second over all threads. */
+    double throughput;
+    /** throughput relative to a single thread, and that divided by the thread count. */
+    double speedup, efficiency;
+    /** the median and 99th percentile latency of an operation over all threads, in ns. */
+    uint64_t p50, p99;
+} tapi_bench_scale_t;
+
+/** summary statistics over the samples of a benchmark, in nanoseconds per operation. */
+typedef struct {
+    double min, median, mean, max;
+} tapi_bench_stats_t;
+
+/**
+ * @brief a singular benchmark within a benchmark suite.
+ *
+ * `tapi_bench_t` is a data structure for benchmarks within tapi. the body is timed over a
+ *   number of repetitions (samples), each sample running the body for a number of iterations;
+ *   when no iteration count is given it is calibrated so that each sample runs for roughly
+ *   `min_time` nanoseconds. after the samples, each operation of one more sample is timed on
+ *   its own into a latency histogram, so tail percentiles can be reported next to the median.
+ *   benchmarks with mocks are timed twice, with the real dependencies and isolated from them.
+ *   benchmarks with a size sweep are timed at every size, fitted to a complexity class, and
+ *   report the samples of their largest size. cold benchmarks evict the caches before every
+ *   operation and time each operation on its own, leaving the eviction out of the timing.
+ *   threaded benchmarks are also run on 1, 2, 4, ... up to `threads` threads released from a
+ *   barrier at once, and report the throughput and scaling efficiency at every count.
+ *
+ * @see tapi_bench_make()
+ * @see tapi_bench_add()
+ * @see tapi_bench_run()
+ * @see tapi_bench_add_mock()
+ * @see tapi_bench_sweep()
+ * @see tapi_bench_cache()
+ * @see tapi_bench_threads()
+ * @see tapi_bench_destroy()
+ */
+typedef struct {
+    /** name of the benchmark. */
+    char* name;
+    /** pointer to the benchmark body. */
+    tapi_bench_func_t function;
+    /** pointer to the setup and teardown functions. */
+    tapi_gen_func_t setup, teardown;
+    /** user data handed to the body through its state. */
+    void* data;
+    /** number of samples, and operations per sample (0 to calibrate). */
+    size_t repetitions, iterations;
+    /** target duration of a single sample when calibrating, in nanoseconds. */
+    double min_time;
+    /** per-sample results, in nanoseconds per operation. */
+    double* samples;
+    /** summary statistics over the samples (isolated from the mocked dependencies). */
+    tapi_bench_stats_t stats;
+    /** input size handed to the body, the current point of a sweep. */
+    size_t size;
+    /** geometric sweep of the input size; low, high (inclusive) and growth factor. */
+    struct {
+        size_t low, high;
+        double factor;
+    } sweep;
+    /** the points of the sweep, and the complexity fitted to them. */
+    tapi_bench_point_t* points;
+    size_t point_count;
+    tapi_bench_fit_t fit;
+    /** the cache state the benchmark is timed in, and statistics with cold caches. */
+    e_tapi_bench_cache_t cache;
+    tapi_bench_stats_t cold;
+    /** the input flushed out of the caches before a cold operation (0x0 to stream the llc). */
+    const void* input;
+    size_t input_size;
+    /** the largest thread count to scale to (0 for none), and the efficiency below which the
+     *  benchmark fails. */
+    size_t threads;
+    double efficiency;
+    /** the throughput at every thread count. */
+    tapi_bench_scale_t* scaling;
+    size_t scale_count;
+    /** dynamic array of mock pointers, and statistics with the real dependencies. */
+    dyna_t* mocks;
+    tapi_bench_stats_t real;
+    /** per-operation latency histogram, in nanoseconds. */
+    tapi_hist_t* hist;
+    /** the environment the benchmark ran in. */
+    tapi_bench_env_t env;
+    /** p-value and relative median change against the baseline (if compared). */
+    double p_value, change;
+    /** result of the benchmark, failed if it regressed against the baseline. */
+    e_tapi_test_result_t result;
+} tapi_bench_t;
+
+/**
+ * @brief set up many benchmarks to be run in concession.
+ *
+ * @param benches the array of benchmarks to be set up.
+ * @param count the number of benchmarks to be set up.
+ */
+TAPI_EXPORT void
+tapi_bench_setup(tapi_bench_t** benches, size_t count);
+
+/**
+ * @brief add a benchmark to your benchmark suite.
+ *
+ * @param bench the benchmark to be added.
+ */
+TAPI_EXPORT void
+tapi_bench_add(tapi_bench_t* bench);
+
+/**
+ * @brief remove a benchmark from your benchmark suite; a benchmark has to be removed before it
+ *  is destroyed, or later runs would time it again.
+ *
+ * @param bench the benchmark to be removed.
+ */
+TAPI_EXPORT void
+tapi_bench_remove(tapi_bench_t* bench);
+
+/**
+ * @brief remove every benchmark from your benchmark suite, the benchmarks themselves are kept.
+ */
+TAPI_EXPORT void
+tapi_bench_clear(void);
+
+/**
+ * @brief run all the benchmarks set up in concession, saving to or comparing against the
+ *  baseline if one is configured.
+ *
+ * @return EXIT_SUCCESS, or EXIT_FAILURE if any benchmark regressed against the baseline.
+ */
+TAPI_EXPORT int
+tapi_bench_run(void);
+
+/**
+ * @brief make a new benchmark given minimal information.
+ *
+ * @param name the name of the benchmark.
+ * @param function the benchmark body to be timed.
+ * @return an allocated benchmark structure.
+ */
+TAPI_EXPORT tapi_bench_t*
+tapi_bench_make(const char* name, tapi_bench_func_t function);
+
+/**
+ * @brief add a mock to a benchmark; mocks are applied once before the isolated samples are
+ *  timed and restored after, the benchmark is also timed without them for comparison.
+ *
+ * @param bench the benchmark to be altered.
+ * @param tested the tested function to search through.
+ * @param target the target address to redirect to mock.
+ * @param mocked the mocked result to be redirected to.
+ */
+TAPI_EXPORT void
+tapi_bench_add_mock(tapi_bench_t* bench, void* tested, void* target, void* mocked);
+
+/**
+ * @brief sweep the input size of a benchmark geometrically from low to high; each size is
+ *  timed and the results are fitted to O(1), O(log n), O(n), O(n log n) and O(n^2). when
+ *  compared against a baseline, a change of the fitted class fails the benchmark.
+ *
+ * @param bench the benchmark to be altered.
+ * @param low the smallest input size (at least 1).
+ * @param high the largest input size.
+ * @param factor the growth factor between sizes (e.g. 2.0).
+ */
+TAPI_EXPORT void
+tapi_bench_sweep(tapi_bench_t* bench, size_t low, size_t high, double factor);
+
+/**
+ * @brief time a benchmark with cold caches, warm caches, or both side by side. before every
+ *  cold operation the input is flushed out of every cache level (clflush on x86, dc civac on
+ *  aarch64); without an input, or where user space cannot flush (arm32), a buffer twice the
+ *  size of the last level cache is streamed instead. cold samples run `iterations` operations
+ *  if set, and 8 o.w., since every eviction is costly.
+ *
+ * @param bench the benchmark to be altered.
+ * @param cache the cache state to time in.
+ * @param input the data the body reads, to be flushed (may be 0x0).
+ * @param size the size of the input in bytes.
+ */
+TAPI_EXPORT void
+tapi_bench_cache(tapi_bench_t* bench, e_tapi_bench_cache_t cache, const void* input,
+                 size_t size);
+
+/**
+ * @brief scale a benchmark over 1, 2, 4, ... up to `threads` threads. at every count the
+ *  threads wait on a spin barrier and are released at once, then run the body for `min_time`
+ *  nanoseconds, counting operations and latencies in their own cache lines. the benchmark
+ *  fails if the scaling efficiency (speedup / threads) at any count drops below `efficiency`.
+ *  the body is told its thread through tapi_bench_state_t::thread.
+ *
+ * @param bench the benchmark to be altered.
+ * @param threads the largest number of threads.
+ * @param efficiency the lowest tolerated efficiency in [0, 1], 0 to never fail.
+ */
+TAPI_EXPORT void
+tapi_bench_threads(tapi_bench_t* bench, size_t threads, double efficiency);
+
+/**
+ * @brief fit measured times to every complexity class by least squares on the relative
+ *  error, t(n) = coef * f(n), and pick the class with the smallest error.
+ *
+ * @param sizes the input sizes.
+ * @param times the time per operation at each size.
+ * @param count the number of sizes.
+ * @return the best fit.
+ */
+TAPI_EXPORT tapi_bench_fit_t
+tapi_bench_fit(const size_t* sizes, const double* times, size_t count);
+
+/**
+ * @brief get a readable name of a complexity class, e.g. "O(n log n)".
+ *
+ * @param complexity the complexity class.
+ * @return the name of the class.
+ */
+TAPI_EXPORT const char*
+tapi_bench_complexity_name(e_tapi_bench_complexity_t complexity);
+
+/**
+ * @brief set the baseline file and what to do with it; the environment variables
+ *  `TAPI_BENCH_BASELINE` (path) and `TAPI_BENCH_SAVE` (=1 to save) override these.
+ *
+ * @param path the path of the baseline file.
+ * @param mode whether to save to, or compare against the baseline.
+ */
+TAPI_EXPORT void
+tapi_bench_baseline(const char* path, e_tapi_bench_baseline_t mode);
+
+/**
+ * @brief set the regression gate; a benchmark fails when its median slowed down by more than
+ *  `threshold` (relative, e.g. 0.05 for 5%) and the slowdown is significant at level `alpha`.
+ *
+ * @param threshold the relative median slowdown that is tolerated.
+ * @param alpha the significance level of the mann-whitney u test.
+ */
+TAPI_EXPORT void
+tapi_bench_threshold(double threshold, double alpha);
+
+/**
+ * @brief control sources of noise before benchmarks run; pin the thread to a cpu, and
+ *  optionally raise it to SCHED_FIFO and lock its memory. everything is undone when the run
+ *  ends. the environment variable `TAPI_BENCH_CPU` overrides the cpu.
+ *
+ * @param cpu the cpu to pin to, or -1 to not pin.
+ * @param flags the extra isolation to apply, see e_tapi_bench_isolate_t.
+ */
+TAPI_EXPORT void
+tapi_bench_isolate(int cpu, unsigned int flags);
+
+/**
+ * @brief set a stream to export the results of every benchmark to as json lines (one object
+ *  per benchmark, including its latency histogram); 0x0 to disable. the environment variable
+ *  `TAPI_BENCH_REPORT` overrides this with a file the results are appended to.
+ *
+ * @param stream the stream to export results to.
+ */
+TAPI_EXPORT void
+tapi_bench_report(tapi_stream_t stream);
+
+/**
+ * @brief one-sided mann-whitney u test that the current samples are larger (slower) than the
+ *  baseline samples; uses the normal approximation with tie and continuity correction.
+ *
+ * @param base the baseline samples.
+ * @param n_base the number of baseline samples.
+ * @param cur the current samples.
+ * @param n_cur the number of current samples.
+ * @return the p-value of the test.
+ */
+TAPI_EXPORT double
+tapi_bench_mwu(const double* base, size_t n_base, const double* cur, size_t n_cur);
+
+/**
+ * @brief free and destroy a list of benchmarks after they have been ran, and removed from the
+ *  suite (see tapi_bench_remove()).
+ *
+ * @param benches the benchmarks to be freed.
+ * @param length the number of benchmarks to be freed.
+ */
+TAPI_EXPORT void
+tapi_bench_destroy(tapi_bench_t** benches, size_t length);
+
+/** quickly make a benchmark. */
+#define tapi_quick_bench(name, function) \
+    tapi_bench_add(tapi_bench_make(name, function));
+
+/** quickly make a benchmark with a mocked dependency. */
+#define tapi_quick_bench_and_mock(name, function, tested, target, mocked) \
+    do { \
+        tapi_bench_t* _tapi_bench = tapi_bench_make(name, function); \
+        tapi_bench_add_mock(_tapi_bench, tested, target, mocked); \
+        tapi_bench_add(_tapi_bench); \
+    } while (0);
+
+/** prevent the compiler from optimizing away a value computed in a benchmark body. */
+#define tapi_bench_keep(value) \
+    __asm__ volatile("" : : "g"(value) : "memory")
+#endif /* TAPI_BENCH_H */
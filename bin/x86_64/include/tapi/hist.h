@@ -0,0 +1,166 @@
+/**
+ * \cond
+ * @author Sean Hobeck
+ * @date 2026-10-19
+ */
+#ifndef TAPI_HIST_H
+#define TAPI_HIST_H
+
+/*! @uses TAPI_EXPORT, tapi_assert. */
+#include <tapi/tapi.h>
+
+/*! @uses tapi_stream_t. */
+#include <tapi/sink.h>
+
+/*! @uses uint64_t. */
+#include <stdint.h>
+/** \endcond */
+
+/** number of linear sub-buckets per power of two is 2^(TAPI_HIST_SUB_BITS - 1). */
+#define TAPI_HIST_SUB_BITS 7u
+
+/** total number of buckets needed to cover every 64-bit value. */
+#define TAPI_HIST_BUCKETS ((64u - TAPI_HIST_SUB_BITS + 2u) << (TAPI_HIST_SUB_BITS - 1u))
+
+/**
+ * @brief a log-linear (hdr-style) latency histogram.
+ *
+ * `tapi_hist_t` is a fixed-size histogram of unsigned 64-bit values (most often nanoseconds).
+ *   values below 2^TAPI_HIST_SUB_BITS are counted exactly, larger values fall into one of 64
+ *   linear sub-buckets per power of two, which bounds the relative error to under 1.6%.
+ *   recording is O(1) and never allocates; histograms recorded on separate threads can be
+ *   combined with tapi_hist_merge().
+ *
+ * @see tapi_hist_make()
+ * @see tapi_hist_record()
+ * @see tapi_hist_percentile()
+ * @see tapi_hist_merge()
+ * @see tapi_hist_destroy()
+ */
+typedef struct {
+    /** number of recorded values, and the smallest and largest one. */
+    uint64_t count, min, max;
+    /** sum of all recorded values (for the mean). */
+    uint64_t sum;
+    /** the bucket counts. */
+    uint64_t buckets[TAPI_HIST_BUCKETS];
+} tapi_hist_t;
+
+/**
+ * @brief make an empty histogram.
+ *
+ * @return a pointer to an allocated histogram.
+ */
+TAPI_EXPORT tapi_hist_t*
+tapi_hist_make(void);
+
+/**
+ * @brief clear every recorded value from a histogram.
+ *
+ * @param hist the histogram to be reset.
+ */
+TAPI_EXPORT void
+tapi_hist_reset(tapi_hist_t* hist);
+
+/**
+ * @brief record a value into a histogram.
+ *
+ * @param hist the histogram to record into.
+ * @param value the value to be recorded.
+ */
+TAPI_EXPORT void
+tapi_hist_record(tapi_hist_t* hist, uint64_t value);
+
+/**
+ * @brief record a value into a histogram shared between threads, using atomic increments.
+ *
+ * @param hist the histogram to record into.
+ * @param value the value to be recorded.
+ */
+TAPI_EXPORT void
+tapi_hist_record_atomic(tapi_hist_t* hist, uint64_t value);
+
+/**
+ * @brief add every value recorded in one histogram into another.
+ *
+ * @param dst the histogram to merge into.
+ * @param src the histogram to merge from.
+ */
+TAPI_EXPORT void
+tapi_hist_merge(tapi_hist_t* dst, const tapi_hist_t* src);
+
+/**
+ * @brief get the value at a percentile of the recorded values; the result is the highest
+ *  value equivalent to the bucket the percentile falls into, capped to the largest value.
+ *
+ * @param hist the histogram to be read.
+ * @param percentile the percentile in [0, 100], e.g. 99.9.
+ * @return the value at the percentile, or 0 if the histogram is empty.
+ */
+TAPI_EXPORT uint64_t
+tapi_hist_percentile(const tapi_hist_t* hist, double percentile);
+
+/**
+ * @brief get the mean of the recorded values.
+ *
+ * @param hist the histogram to be read.
+ * @return the mean, or 0 if the histogram is empty.
+ */
+TAPI_EXPORT double
+tapi_hist_mean(const tapi_hist_t* hist);
+
+/**
+ * @brief print a human-readable percentile summary of a histogram on a single line.
+ *
+ * @param hist the histogram to be printed.
+ * @param stream the stream to print to.
+ */
+TAPI_EXPORT void
+tapi_hist_print(const tapi_hist_t* hist, tapi_stream_t stream);
+
+/**
+ * @brief export a histogram as a json object, with its percentiles and every non-empty
+ *  bucket as [lowest value, highest value, count].
+ *
+ * @param hist the histogram to be exported.
+ * @param stream the stream to export to.
+ */
+TAPI_EXPORT void
+tapi_hist_export(const tapi_hist_t* hist, tapi_stream_t stream);
+
+/** @return the current monotonic time in nanoseconds, for use with tapi_hist_record(). */
+TAPI_EXPORT uint64_t
+tapi_hist_now(void);
+
+/**
+ * @brief free a histogram.
+ *
+ * @param hist the histogram to be freed.
+ */
+TAPI_EXPORT void
+tapi_hist_destroy(tapi_hist_t* hist);
+
+/** time a statement and record its latency in nanoseconds into a histogram. */
+#define tapi_hist_time(hist, stmt) \
+    do { \
+        uint64_t _tapi_start = tapi_hist_now(); \
+        stmt; \
+        tapi_hist_record(hist, tapi_hist_now() - _tapi_start); \
+    } while (0)
+
+/** assert that a percentile of a histogram is at or below a budget. */
+#define tapi_assert_percentile_below(hist, percentile, budget) \
+    tapi_assert(tapi_hist_percentile(hist, percentile) <= (uint64_t)(budget))
+
+/** assert that the median of a histogram is at or below a budget. */
+#define tapi_assert_p50_below(hist, budget) \
+    tapi_assert_percentile_below(hist, 50.0, budget)
+
+/** assert that the 99th percentile of a histogram is at or below a budget. */
+#define tapi_assert_p99_below(hist, budget) \
+    tapi_assert_percentile_below(hist, 99.0, budget)
+
+/** assert that the 99.9th percentile of a histogram is at or below a budget. */
+#define tapi_assert_p999_below(hist, budget) \
+    tapi_assert_percentile_below(hist, 99.9, budget)
+#endif /* TAPI_HIST_H */
@@ -0,0 +1,153 @@
+/**
+ * \cond
+ * @author Sean Hobeck
+ * @date 2026-10-19
+ */
+#ifndef TAPI_SPY_H
+#define TAPI_SPY_H
+
+/*! @uses TAPI_EXPORT, tapi_assert. */
+#include <tapi/tapi.h>
+
+/*! @uses tapi_mock_t. */
+#include <tapi/mock.h>
+
+/*! @uses uint64_t, uintptr_t. */
+#include <stdint.h>
+/** \endcond */
+
+/** number of calls a spy keeps; older ones are overwritten. */
+#define TAPI_SPY_RING 256u
+
+/** number of integer/ pointer arguments kept per call. */
+#define TAPI_SPY_ARGS 4u
+
+/** a call seen by a spy. */
+typedef struct {
+    /** the first integer/ pointer arguments (on i386, the first words on the stack). */
+    uintptr_t args[TAPI_SPY_ARGS];
+    /** the cycle counter (tsc, cntvct_el0) when it was made, 0 where there is none. */
+    uint64_t time;
+    /** the site it was made from, an index into the sites of the mock. */
+    size_t site;
+    /** 2n + 2 once call n is written, 2n + 1 while it is being written. */
+    uint64_t sequence;
+} tapi_spy_call_t;
+
+/**
+ * @brief the calls recorded by a spy mock.
+ *
+ * `tapi_spy_t` counts every call through a spy, per site and in total, and keeps the arguments
+ *   of the last TAPI_SPY_RING calls in a ring; recording is lock-free, so calls can be made from
+ *   any number of threads (when two calls a lap of the ring apart are recorded at once, one of
+ *   them is only counted). the counts and the ring are reset whenever the spy is applied.
+ *
+ * @see tapi_mock_create_spy()
+ * @see tapi_spy_count()
+ * @see tapi_spy_call()
+ * @see tapi_spy_reset()
+ */
+typedef struct tapi_spy {
+    /** number of calls since the spy was applied, or reset. */
+    uint64_t count;
+    /** number of calls from each site. */
+    uint64_t* counts;
+    /** where the calls go once recorded, the mocked function or the target. */
+    void* forward;
+    /** the stub each site is patched to. */
+    void** stubs;
+    /** the last TAPI_SPY_RING calls, call n at n % TAPI_SPY_RING. */
+    tapi_spy_call_t ring[TAPI_SPY_RING];
+} tapi_spy_t;
+
+/**
+ * @brief spy on every call to a target within a function (or from anywhere in the program); each
+ *  call is counted and recorded by a stub, and then goes on to a mocked function, or the target.
+ *
+ * @param orig the original function to search for target in, or 0x0 for every caller.
+ * @param target the target function to be spied on.
+ * @param mocked the function the calls go to, or 0x0 for the target itself.
+ * @return a spy mock of every call site, ready to be applied, or 0x0 if nothing calls target, no
+ *  stub could be placed, or every call is thumb code; it is owned by tapi and released when the
+ *  program exits.
+ */
+TAPI_EXPORT tapi_mock_t*
+tapi_mock_create_spy(void* orig, void* target, void* mocked);
+
+/**
+ * @brief get the number of calls a spy has seen.
+ *
+ * @param mock the spy mock.
+ * @return the number of calls since it was applied, or reset.
+ */
+TAPI_EXPORT uint64_t
+tapi_spy_count(const tapi_mock_t* mock);
+
+/**
+ * @brief get the number of calls a spy has seen from one site.
+ *
+ * @param mock the spy mock.
+ * @param site the index of the site.
+ * @return the number of calls from the site, 0 if there is no such site.
+ */
+TAPI_EXPORT uint64_t
+tapi_spy_site_count(const tapi_mock_t* mock, size_t site);
+
+/**
+ * @brief copy a call recorded by a spy.
+ *
+ * @param mock the spy mock.
+ * @param n the call, 0 for the first since it was applied, or reset.
+ * @param call the call to be filled in.
+ * @return if the call was made, and is still in the ring.
+ */
+TAPI_EXPORT bool
+tapi_spy_call(const tapi_mock_t* mock, uint64_t n, tapi_spy_call_t* call);
+
+/**
+ * @brief was a call made with a value as one of its arguments?
+ *
+ * @param mock the spy mock.
+ * @param n the call, 0 for the first since it was applied, or reset.
+ * @param arg the index of the argument, below TAPI_SPY_ARGS.
+ * @param value the value.
+ * @return if the call is in the ring, and had the value.
+ */
+TAPI_EXPORT bool
+tapi_spy_called_with(const tapi_mock_t* mock, uint64_t n, size_t arg, uintptr_t value);
+
+/**
+ * @brief were exactly a number of calls made, with a sequence of values as one of their
+ *  arguments?
+ *
+ * @param mock the spy mock.
+ * @param arg the index of the argument, below TAPI_SPY_ARGS.
+ * @param values the value of the argument in each call, in order.
+ * @param count the number of values.
+ * @return if the spy saw count calls, each of them still in the ring and with its value.
+ */
+TAPI_EXPORT bool
+tapi_spy_sequence(const tapi_mock_t* mock, size_t arg, const uintptr_t* values, size_t count);
+
+/**
+ * @brief forget every call a spy has seen; nothing may call through the spy meanwhile, a call
+ *  recorded while it is reset can be left half forgotten.
+ *
+ * @param mock the spy mock.
+ */
+TAPI_EXPORT void
+tapi_spy_reset(tapi_mock_t* mock);
+
+/** assert that a spy saw a number of calls. */
+#define tapi_assert_calls(mock, n) \
+    tapi_assert(tapi_spy_count(mock) == (uint64_t)(n))
+
+/** assert that call n through a spy had a value as one of its arguments. */
+#define tapi_assert_call_arg(mock, n, arg, value) \
+    tapi_assert(tapi_spy_called_with(mock, n, arg, (uintptr_t)(value)))
+
+/** assert that the calls through a spy had a sequence of values as one of their arguments. */
+#define tapi_assert_arg_sequence(mock, arg, ...) \
+    tapi_assert(tapi_spy_sequence(mock, arg, (const uintptr_t[]) { __VA_ARGS__ }, \
+                                  sizeof((const uintptr_t[]) { __VA_ARGS__ }) / sizeof(uintptr_t)))
+#endif /* TAPI_SPY_H */
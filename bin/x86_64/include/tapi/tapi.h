@@ -0,0 +1,224 @@
+/**
+ * \cond
+ * @author Sean Hobeck
+ * @date 2026-03-09
+ */
+#ifndef TAPI_H
+#define TAPI_H
+
+/*! @uses dyna_define. */
+#include <tapi/dyna.h>
+
+/* for functions that are exported by tapi. */
+#if (defined(__GNUC__) || defined(__IBMC__))
+#define TAPI_EXPORT __attribute__((visibility("default")))
+#else
+/* if we are using msvc toolchain (winapi). */
+#if (defined(_MSC_VER))
+#define TAPI_EXPORT __declspec(dllexport)
+#else
+#define TAPI_EXPORT
+#endif
+#endif
+/** \endcond */
+
+/** enum for different types of results from a test. */
+typedef enum {
+    E_TAPI_TEST_RESULT_PASSED = 0x1, /** test passed. */
+    E_TAPI_TEST_RESULT_FAILED, /** test failed. */
+    E_TAPI_TEST_RESULT_SKIPPED, /** test skipped. */
+} e_tapi_test_result_t;
+
+/**
+ * @brief allocation counters of a thread (see tapi/alloc.h).
+ *
+ * `tapi_alloc_stats_t` counts the heap allocations made by a thread; the runner records them
+ *   for every test, from right before the test function is called until it returns.
+ */
+typedef struct {
+    /** number of allocations (malloc, calloc, realloc, ...) and frees. */
+    size_t allocs, frees;
+    /** bytes requested over all allocations. */
+    size_t bytes;
+    /** bytes currently live, and the most that were live at once. */
+    size_t live, peak;
+} tapi_alloc_stats_t;
+
+/* a mock of a test (see tapi/mock.h). */
+struct tapi_mock;
+
+/** a typed vector of mock pointers (see dyna_define()), the first four are kept inline. */
+dyna_define(tapi_mocks, struct tapi_mock*, 4u)
+
+/** a function pointer type for test functions. */
+typedef e_tapi_test_result_t (*tapi_test_func_t)(void);
+
+/** a function pointer type for setup and teardown functions. */
+typedef void (*tapi_gen_func_t)(void);
+
+/**
+ * @brief a singular test within a test suite.
+ *
+ * `tapi_test_t` is a data structure for tests within the tapi. this contains a name, description,
+ *   setup, and teardown functions, as well as other mocking and output capture information.
+ *
+ * @see tapi_test_setup()
+ * @see tapi_test_add()
+ * @see tapi_test_run()
+ * @see tapi_test_create()
+ * @see tapi_test_add_mock()
+ * @see tapi_test_add_mock_entry()
+ * @see tapi_test_add_mock_got()
+ * @see tapi_test_destroy()
+ */
+typedef struct {
+    /** name of the test. */
+    char* name;
+    /** pointer to the test function. */
+    tapi_test_func_t function;
+    /** pointer to the setup and teardown functions. */
+    tapi_gen_func_t setup, teardown;
+    /** vector of mock pointers. */
+    tapi_mocks_t mocks;
+    /** result of calling the test. */
+    e_tapi_test_result_t result;
+    /** allocations made by the test function. */
+    tapi_alloc_stats_t allocs;
+    /** blocks (and bytes) allocated by the test function and still live after teardown, if
+     *  leaks are checked (see tapi_leak_check()). */
+    size_t leaks, leaked;
+} tapi_test_t;
+
+/**
+ * @brief set up many tests to be run in concession.
+ *
+ * @param tests the array of tests to be set up for a test file.
+ * @param count the number of tests to be set up.
+ */
+TAPI_EXPORT void
+tapi_test_setup(tapi_test_t** tests, size_t count);
+
+/**
+ * @brief add a test to your testing suite.
+ *
+ * @param test the test to be added.
+ */
+TAPI_EXPORT void
+tapi_test_add(tapi_test_t* test);
+
+/** @brief run all the tests set up in concession. */
+TAPI_EXPORT void
+tapi_test_run(void);
+
+/**
+ * @brief make a new test given minimal information; the test and its name live in tapi's
+ *  internal arena until the program exits, the mocks are kept inline until there are many.
+ *
+ * @param name the name of the test.
+ * @param function the test function to be used.
+ */
+TAPI_EXPORT tapi_test_t*
+tapi_test_make(const char* name, tapi_test_func_t function);
+
+/**
+ * @brief add a mock to a certain test.
+ *
+ * @param test the test to be altered.
+ * @param tested the tested function to search through.
+ * @param target the target address to redirect to mock.
+ * @param mocked the mocked result to be redirected to.
+ */
+TAPI_EXPORT void
+tapi_test_add_mock(tapi_test_t* test, void* tested, void* target, void* mocked);
+
+/**
+ * @brief add a mock of every call to a target, from any function in the program, to a test.
+ *
+ * @param test the test to be altered.
+ * @param target the target address to redirect to mock.
+ * @param mocked the mocked result to be redirected to.
+ * @return the number of call sites mocked.
+ */
+TAPI_EXPORT size_t
+tapi_test_add_mock_all(tapi_test_t* test, void* target, void* mocked);
+
+/**
+ * @brief add a mock of a target to a test that patches the entry of the target itself, so every
+ *  caller is redirected (indirect and cross-library calls too).
+ *
+ * @param test the test to be altered.
+ * @param target the target function to redirect to mock.
+ * @param mocked the mocked result to be redirected to.
+ * @return the mock, whose `original` still calls the target, or 0x0 if its entry can't be
+ *  patched.
+ */
+TAPI_EXPORT struct tapi_mock*
+tapi_test_add_mock_entry(tapi_test_t* test, void* target, void* mocked);
+
+/**
+ * @brief add a mock of a shared-library function to a test, swapping the got slots it is called
+ *  through (see tapi_mock_create_got()).
+ *
+ * @param test the test to be altered.
+ * @param symbol the name of the function to redirect to mock.
+ * @param mocked the mocked result to be redirected to.
+ * @return the mock, whose `original` is the real function, or 0x0 if there is no slot to swap.
+ */
+TAPI_EXPORT struct tapi_mock*
+tapi_test_add_mock_got(tapi_test_t* test, const char* symbol, void* mocked);
+
+/**
+ * @brief add a mock of a target to a test that only applies to the thread running it, so tests
+ *  on other threads can mock the same target differently (see tapi_mock_create_dispatch()).
+ *
+ * @param test the test to be altered.
+ * @param target the target function to redirect to mock.
+ * @param mocked the mocked result to be redirected to.
+ * @return the mock, or 0x0 if nothing calls the target.
+ */
+TAPI_EXPORT struct tapi_mock*
+tapi_test_add_mock_dispatch(tapi_test_t* test, void* target, void* mocked);
+
+/**
+ * @brief add a spy of every call to a target within a tested function (or from anywhere) to a
+ *  test; each call is counted and its arguments recorded (see tapi_mock_create_spy()), then it
+ *  goes on to a mock, or the target. the counts start over every time the test runs.
+ *
+ * @param test the test to be altered.
+ * @param tested the tested function to search through, or 0x0 for every caller.
+ * @param target the target function to spy on.
+ * @param mocked the function the calls go to, or 0x0 for the target.
+ * @return the spy mock, or 0x0 if nothing calls the target.
+ */
+TAPI_EXPORT struct tapi_mock*
+tapi_test_add_mock_spy(tapi_test_t* test, void* tested, void* target, void* mocked);
+
+/**
+ * @brief free and destroy a list of tests after they have been ran; the tests, their names and
+ *  mocks themselves are released with tapi's internal arena when the program exits.
+ *
+ * @param tests the tests to be freed.
+ * @param length the number of tests to be freed.
+ */
+TAPI_EXPORT void
+tapi_test_destroy(tapi_test_t** tests, size_t length);
+
+/** assert on a condition and fail a given test if not met. */
+#define tapi_assert(cond) if (!(cond)) return E_TAPI_TEST_RESULT_FAILED;
+
+/** quickly make a test. */
+#define tapi_quick_test(name, function) \
+    tapi_test_add(tapi_test_make(name, function));
+
+/** quickly make a test with a mock value. */
+#define tapi_quick_test_and_mock(name, function, tested, target, mocked) \
+    tapi_test_add_mock(tapi_test_make(name, function), tested, target, mocked);
+
+/**
+ * quickly create a test suite; variable arguments should be used with tapi_quick_test and
+ *    tapi_quick_test_and_mock.
+ */
+#define tapi_quick_suite(...) \
+    __VA_ARGS__; \
+    tapi_test_run();
+#endif /* TAPI_H */
\ No newline at end of file
@@ -0,0 +1,66 @@
+/**
+ * \cond
+ * @author Sean Hobeck
+ * @date 2026-10-19
+ */
+#ifndef TAPI_ALLOC_H
+#define TAPI_ALLOC_H
+
+/*! @uses TAPI_EXPORT, tapi_assert, tapi_alloc_stats_t. */
+#include <tapi/tapi.h>
+/** \endcond */
+
+/**
+ * @brief get the allocation counters of the calling thread.
+ *
+ * tapi interposes malloc, calloc, realloc, free, memalign, aligned_alloc and posix_memalign
+ *   (glibc only, o.w. every counter stays 0). counters are thread-local; memory freed by
+ *   another thread than the one that allocated it is subtracted from the live bytes of the
+ *   freeing thread.
+ *
+ * @return a copy of the counters.
+ */
+TAPI_EXPORT tapi_alloc_stats_t
+tapi_alloc_stats(void);
+
+/** @brief reset the allocation counters of the calling thread. */
+TAPI_EXPORT void
+tapi_alloc_reset(void);
+
+/** enum for what the runner does with blocks a test leaked. */
+typedef enum {
+    E_TAPI_LEAK_OFF = 0x0, /** do not check for leaks. */
+    E_TAPI_LEAK_REPORT, /** report leaked blocks, grouped by the site that allocated them. */
+    E_TAPI_LEAK_FAIL, /** report leaked blocks, and fail the test. */
+} e_tapi_leak_t;
+
+/**
+ * @brief set whether blocks allocated by a test and still live after its teardown are
+ *  reported, or also fail the test; the environment variable `TAPI_LEAK_CHECK` ("report" or
+ *  "fail") sets the mode when the library is loaded, so a call made later still applies.
+ *
+ * blocks are tracked (by any thread) while the test function runs, with the address they
+ *   were allocated from; a test that first touches a lazily allocated buffer (e.g. the one of
+ *   stdout) will see it reported.
+ *
+ * @param mode the leak checking mode.
+ */
+TAPI_EXPORT void
+tapi_leak_check(e_tapi_leak_t mode);
+
+/** assert that the current test made at most n allocations so far. */
+#define tapi_assert_max_allocs(n) \
+    tapi_assert(tapi_alloc_stats().allocs <= (size_t)(n))
+
+/**
+ * assert that a scope makes no allocations, e.g. `tapi_assert_no_alloc { hot_path(); }`; the
+ *   assertion runs after the scope, so it must not be left with break or return.
+ */
+#define tapi_assert_no_alloc \
+    for (size_t _tapi_allocs = tapi_alloc_stats().allocs, _tapi_pass = 0u; _tapi_pass < 2u; \
+         _tapi_pass++) \
+        if (_tapi_pass == 1u) { \
+            tapi_assert(tapi_alloc_stats().allocs == _tapi_allocs); \
+        } \
+        else
+#endif /* TAPI_ALLOC_H */
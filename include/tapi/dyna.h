@@ -8,6 +8,9 @@
 
 /*! @uses size_t. */
 #include <stddef.h>
+
+/*! @uses bool, true, false. */
+#include <stdbool.h>
 /** \endcond */
 
 /**
@@ -99,6 +102,40 @@ dyna_shrink(dyna_t* array);
 dyna_t*
 dyna_make(void** data, size_t length);
 
+/**
+ * @brief grow the storage of a typed vector (see dyna_define()), moving its elements off of its
+ *  inline storage onto the heap the first time.
+ *
+ * @param data pointer to the storage of the vector.
+ * @param capacity pointer to the capacity of the vector.
+ * @param local the inline storage of the vector.
+ * @param length the number of elements in the vector.
+ * @param size the size of an element.
+ * @param wanted the capacity needed.
+ * @return false if the storage could not be grown, the vector is then left unchanged.
+ */
+bool
+dyna_grow(void** data, size_t* capacity, void* local, size_t length, size_t size, size_t wanted);
+
+/**
+ * @brief sort the elements of a typed vector (see dyna_define()).
+ *
+ * @param data the storage of the vector.
+ * @param length the number of elements in the vector.
+ * @param size the size of an element.
+ * @param compare the comparison function, as for qsort.
+ */
+void
+dyna_sort(void* data, size_t length, size_t size, int (*compare)(const void*, const void*));
+
+/**
+ * @brief free the heap storage of a typed vector (see dyna_define()).
+ *
+ * @param data the storage of the vector.
+ */
+void
+dyna_release(void* data);
+
 /* a get operation. */
 #define _get(array, type, index) ((type) dyna_get(array, index))
 
@@ -122,6 +159,124 @@ dyna_make(void** data, size_t length);
     for (size_t iter = (array)->length; iter != 0; iter--) { \
         type var = _get(array, type, iter - 1);
 
+/* starting an iteration over a typed vector (see dyna_define()). */
+#define _vforeach_it(vector, type, var, iter) \
+    for (size_t iter = 0; iter < (vector)->length; iter++) { \
+        type var = (vector)->data[iter];
+
+/* starting an iteration over a typed vector (see dyna_define()). */
+#define _vforeach(vector, type, var) _vforeach_it(vector, type, var, i)
+
 /* ending an iteration. */
 #define _endforeach }
+
+/**
+ * @brief define a typed vector `name##_t` of `type` with `local` elements of inline storage.
+ *
+ * unlike `dyna_t`, a typed vector stores its elements by value, contiguously, and the first
+ *   `local` of them inside the structure itself, so small vectors never touch the heap. a
+ *   zeroed vector is empty and ready to use; once something is pushed it must not be copied
+ *   by value, as `data` may point into its own inline storage. every operation is generated
+ *   as a static inline function prefixed with `name`:
+ *
+ *   name##_reserve(vector, capacity)                   -> false if out of memory.
+ *   name##_push(vector, item)                          -> false if out of memory.
+ *   name##_push_n(vector, items, count)                -> false if out of memory.
+ *   name##_pop(vector)                                 -> the last item.
+ *   name##_swap_remove(vector, index)                  -> the item, in O(1), unordered.
+ *   name##_splice(vector, index, removed, items, count) -> false if out of memory.
+ *   name##_sort(vector, compare)                       -> sorted with qsort.
+ *   name##_clear(vector), name##_free(vector).
+ *
+ * indices are not bounds checked; popping from an empty vector or splicing past its end is
+ *   undefined.
+ *
+ * @param name the prefix of the vector type and its functions.
+ * @param type the element type.
+ * @param local the number of inline elements, at least one.
+ */
+#define dyna_define(name, type, local) \
+    typedef type name##_item_t; \
+    typedef struct { \
+        name##_item_t* data; \
+        size_t length, capacity; \
+        name##_item_t inline_[local]; \
+    } name##_t; \
+    \
+    static inline bool \
+    name##_reserve(name##_t* vector, size_t capacity) { \
+        if (vector->data == 0x0) { \
+            vector->data = vector->inline_; \
+            vector->capacity = (local); \
+        } \
+        if (capacity <= vector->capacity) \
+            return true; \
+        return dyna_grow((void**) &vector->data, &vector->capacity, vector->inline_, \
+                         vector->length, sizeof(name##_item_t), capacity); \
+    } \
+    \
+    static inline bool \
+    name##_push(name##_t* vector, name##_item_t item) { \
+        if (vector->length == vector->capacity && \
+            !name##_reserve(vector, vector->length + 1u)) \
+            return false; \
+        vector->data[vector->length++] = item; \
+        return true; \
+    } \
+    \
+    static inline bool \
+    name##_push_n(name##_t* vector, const name##_item_t* items, size_t count) { \
+        if (!name##_reserve(vector, vector->length + count)) \
+            return false; \
+        if (count != 0u) \
+            __builtin_memcpy(vector->data + vector->length, items, \
+                             sizeof(name##_item_t) * count); \
+        vector->length += count; \
+        return true; \
+    } \
+    \
+    static inline name##_item_t \
+    name##_pop(name##_t* vector) { \
+        return vector->data[--vector->length]; \
+    } \
+    \
+    static inline name##_item_t \
+    name##_swap_remove(name##_t* vector, size_t index) { \
+        name##_item_t item = vector->data[index]; \
+        vector->data[index] = vector->data[--vector->length]; \
+        return item; \
+    } \
+    \
+    static inline bool \
+    name##_splice(name##_t* vector, size_t index, size_t removed, \
+                  const name##_item_t* items, size_t count) { \
+        if (count > removed && !name##_reserve(vector, vector->length - removed + count)) \
+            return false; \
+        size_t tail = vector->length - index - removed; \
+        if (tail != 0u && count != removed) \
+            __builtin_memmove(vector->data + index + count, vector->data + index + removed, \
+                              sizeof(name##_item_t) * tail); \
+        if (count != 0u) \
+            __builtin_memcpy(vector->data + index, items, sizeof(name##_item_t) * count); \
+        vector->length = vector->length - removed + count; \
+        return true; \
+    } \
+    \
+    static inline void \
+    name##_sort(name##_t* vector, int (*compare)(const void*, const void*)) { \
+        dyna_sort(vector->data, vector->length, sizeof(name##_item_t), compare); \
+    } \
+    \
+    static inline void \
+    name##_clear(name##_t* vector) { \
+        vector->length = 0u; \
+    } \
+    \
+    static inline void \
+    name##_free(name##_t* vector) { \
+        if (vector->data != vector->inline_) \
+            dyna_release(vector->data); \
+        vector->data = 0x0; \
+        vector->length = vector->capacity = 0u; \
+    }
 #endif /* TAPI_DYNA_H */
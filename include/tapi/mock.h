@@ -11,8 +11,31 @@
 
 /*! @uses size_t. */
 #include <stddef.h>
+
+/*! @uses bool. */
+#include <stdbool.h>
 /** \endcond */
 
+/** enum for what a mock patches. */
+typedef enum {
+    E_TAPI_MOCK_KIND_CALL = 0x0, /** the calls to the target. */
+    E_TAPI_MOCK_KIND_ENTRY, /** the entry of the target itself. */
+    E_TAPI_MOCK_KIND_GOT, /** the got slots a shared-library target is called through. */
+    E_TAPI_MOCK_KIND_DISPATCH, /** the mock of the calling thread, for calls through a stub. */
+    E_TAPI_MOCK_KIND_SPY, /** the calls to the target, each to a stub that records it. */
+} e_tapi_mock_kind_t;
+
+/** a call (or an entry, or a got slot) patched by a mock. */
+typedef struct {
+    /** address of the call, and the size of the instruction (or of the entry patch, or slot). */
+    void* call;
+    size_t size;
+    /** if the call is a thumb instruction (arm only). */
+    bool is_thumb;
+    /** the bytes of the call before and after it was patched. */
+    unsigned char orig_bytes[16u], mocked_bytes[16u];
+} tapi_mock_site_t;
+
 /**
  * @brief a patch-based runtime mock for redirecting calls within a tested function.
  *
@@ -20,38 +43,133 @@
  *   is mainly used for isolation from other functions, and to primarily test your functions logic,
  *   arithmetic, and functionality. mocks/ stub functions can be as simple as returning a
  *   value, or as complex as you need them to be; complexity is completely left up to the user.
+ *   every call to the target within the tested function is redirected, and restored, together.
+ *   an entry mock patches the start of the target itself instead, so every caller is redirected
+ *   at once (indirect and cross-library calls too), and the original stays callable through
+ *   `original`. a got mock swaps the got slots a shared-library function is called through, in
+ *   the executable and every loaded object, without decoding anything. a dispatch mock only
+ *   applies to the thread that applied it, so threads can mock the same target differently.
+ *   a spy mock routes each call through a stub that counts it and records its arguments (see
+ *   spy.h) before going on to the mocked function, or the target.
  *
  * @see tapi_mock_create()
+ * @see tapi_mock_create_entry()
+ * @see tapi_mock_create_got()
+ * @see tapi_mock_create_dispatch()
+ * @see tapi_mock_create_spy()
  * @see tapi_mock_apply()
  * @see tapi_mock_restore()
  */
-typedef struct {
-    /** original, mocked, and target functions. */
+typedef struct tapi_mock {
+    /** original (0x0 for every caller), mocked, and target functions. */
     void* orig, *mocked, *target;
-    /** address of the call in the original function. */
-    void* call;
-    /** size of the patch and function. */
-    size_t size, fun_size;
-    /** first 32 bytes of the original target function. */
-    unsigned char orig_bytes[32u];
-    /** first 32 bytes of the mocked function. */
-    unsigned char mocked_bytes[32u];
+    /** size of the original function. */
+    size_t fun_size;
+    /** the calls to target, found when the mock is created, and how many there are. */
+    tapi_mock_site_t* sites;
+    size_t count;
+    /** if the calls are currently patched. */
+    bool applied;
+    /** what is patched; an entry mock has one site, the entry, a got mock one per slot. */
+    e_tapi_mock_kind_t kind;
+    /** the original target; for an entry mock its trampoline, for a got mock the target. */
+    void* original;
+    /** the slot of the target, for a dispatch mock, and the mock of the thread it replaced. */
+    size_t slot;
+    const void* previous;
+    /** the calls recorded by a spy mock. */
+    struct tapi_spy* spy;
 } tapi_mock_t;
 
 /**
- * @brief mock the first call occurrence to a target with a call
- *  to a mocked function instead.
+ * @brief mock every call to a target within a function with a call to a mocked function instead.
  *
  * @param orig the original function to search for target in.
  * @param target the target address to be replaced.
  * @param mocked the function to replace the target call with.
- * @return an allocated mock structure with all data, ready to be applied.
+ * @return a mock structure with all data, ready to be applied, or 0x0 if it couldn't be
+ *  allocated; it is owned by tapi and released when the program exits.
  */
 TAPI_EXPORT tapi_mock_t*
 tapi_mock_create(void* orig, void* target, void* mocked);
 
 /**
- * @brief apply the mocks patch in memory; write stub to route to
+ * @brief mock every call to a target, from any function in the program, with a call to a mocked
+ *  function instead; the callers are found in an index of every call site in the executable
+ *  (and in loaded shared objects, with TAPI_MOCK_SHARED=1), built once on first use.
+ *
+ * @param target the target address to be replaced.
+ * @param mocked the function to replace the target calls with.
+ * @return a mock of every call site, ready to be applied, or 0x0 if nothing calls target; it is
+ *  owned by tapi and released when the program exits.
+ */
+TAPI_EXPORT tapi_mock_t*
+tapi_mock_create_all(void* target, void* mocked);
+
+/**
+ * @brief mock a target for every caller by patching its entry with a jump to a mocked function;
+ *  the instructions displaced by the jump are relocated into a trampoline, so the original can
+ *  still be called through `original`. the cost doesn't depend on the number of callers.
+ *
+ * @param target the target function to be replaced.
+ * @param mocked the function to jump to instead.
+ * @return a mock of the entry of target, ready to be applied, or 0x0 if its prologue can't be
+ *  relocated; it is owned by tapi and released when the program exits.
+ */
+TAPI_EXPORT tapi_mock_t*
+tapi_mock_create_entry(void* target, void* mocked);
+
+/**
+ * @brief mock a shared-library function (e.g. read, malloc or clock_gettime) by swapping the got
+ *  slots it is called through, in the executable and every loaded shared object but tapi; the
+ *  slots are found from the relocations of each object, nothing is decoded, and relro is
+ *  unprotected only while a slot is written.
+ *
+ * @param symbol the name of the function to be replaced.
+ * @param mocked the function to call instead.
+ * @return a mock of every slot, ready to be applied, or 0x0 if the function isn't called through
+ *  any; it is owned by tapi and released when the program exits.
+ */
+TAPI_EXPORT tapi_mock_t*
+tapi_mock_create_got(const char* symbol, void* mocked);
+
+/**
+ * @brief mock a target for the calling thread only; every call to it in the program is routed,
+ *  once, through a stub that calls the mock applied by the calling thread, or the target if it
+ *  applied none. threads can apply different mocks of the same target at the same time, and
+ *  applying or restoring one patches nothing; restoring one puts back the mock it replaced.
+ *
+ * @param target the target function to be replaced.
+ * @param mocked the function to call instead, on the thread that applies the mock.
+ * @return a mock of the target, ready to be applied, or 0x0 if nothing calls target, or no call
+ *  to it could be routed; it is owned by tapi and released when the program exits.
+ */
+TAPI_EXPORT tapi_mock_t*
+tapi_mock_create_dispatch(void* target, void* mocked);
+
+/**
+ * @brief apply many mocks at once; every call site of every mock is written in a single batch,
+ *  with one protection change per range of pages rather than two per call.
+ *
+ * @param mocks the mocks to be applied.
+ * @param count the number of mocks.
+ */
+TAPI_EXPORT void
+tapi_mock_apply_all(tapi_mock_t** mocks, size_t count);
+
+/**
+ * @brief restore many mocks at once, in a single batch like tapi_mock_apply_all(); every site gets
+ *  the bytes it had before it was applied back, nothing is decoded again. a site whose bytes are
+ *  no longer the ones the mock wrote has been changed by something else, and is left as it is.
+ *
+ * @param mocks the mocks to be restored.
+ * @param count the number of mocks.
+ */
+TAPI_EXPORT void
+tapi_mock_restore_all(tapi_mock_t** mocks, size_t count);
+
+/**
+ * @brief apply the mocks patch in memory; every call site is routed to
  *  the given mocked function pointer.
  *
  * @param mock the mock to be applied.
@@ -60,13 +178,32 @@ TAPI_EXPORT void
 tapi_mock_apply(tapi_mock_t* mock);
 
 /**
- * @brief restore the contents of a function and free the mock.
+ * @brief restore every call site of a mock; the mock is kept, and can be applied again.
  *
- * @param mock the mock structure to be freed and restored.
+ * @param mock the mock structure to be restored.
  */
 TAPI_EXPORT void
 tapi_mock_restore(tapi_mock_t* mock);
 
+/**
+ * @brief restore every mock that is still applied, the last one applied first; dispatch mocks
+ *  are left to the threads that applied them. this is done when the program exits, before the
+ *  code the mocks jump through is released.
+ */
+TAPI_EXPORT void
+tapi_mock_restore_applied(void);
+
+/**
+ * @brief patch safely while other threads could be running the patched code (off unless
+ *  TAPI_MOCK_LIVE=1), e.g. to apply mocks under a running thread pool. a call is rewritten with a
+ *  single atomic store on arm, and behind an int3 breakpoint on x86; an entry patch is written
+ *  with every other thread stopped outside of it (by SIGRTMIN, which they must not block).
+ *
+ * @param live is patching to be safe?
+ */
+TAPI_EXPORT void
+tapi_mock_set_live(bool live);
+
 /** create a simple mock to return a given value. */
 #define tapi_mock_return(func_name, return_type, return_value) \
     return_type func_name() { return return_value; }
@@ -6,7 +6,7 @@
 #ifndef TAPI_H
 #define TAPI_H
 
-/*! @uses dyna_t. */
+/*! @uses dyna_define. */
 #include <tapi/dyna.h>
 
 /* for functions that are exported by tapi. */
@@ -29,6 +29,27 @@ typedef enum {
     E_TAPI_TEST_RESULT_SKIPPED, /** test skipped. */
 } e_tapi_test_result_t;
 
+/**
+ * @brief allocation counters of a thread (see tapi/alloc.h).
+ *
+ * `tapi_alloc_stats_t` counts the heap allocations made by a thread; the runner records them
+ *   for every test, from right before the test function is called until it returns.
+ */
+typedef struct {
+    /** number of allocations (malloc, calloc, realloc, ...) and frees. */
+    size_t allocs, frees;
+    /** bytes requested over all allocations. */
+    size_t bytes;
+    /** bytes currently live, and the most that were live at once. */
+    size_t live, peak;
+} tapi_alloc_stats_t;
+
+/* a mock of a test (see tapi/mock.h). */
+struct tapi_mock;
+
+/** a typed vector of mock pointers (see dyna_define()), the first four are kept inline. */
+dyna_define(tapi_mocks, struct tapi_mock*, 4u)
+
 /** a function pointer type for test functions. */
 typedef e_tapi_test_result_t (*tapi_test_func_t)(void);
 
@@ -46,6 +67,8 @@ typedef void (*tapi_gen_func_t)(void);
  * @see tapi_test_run()
  * @see tapi_test_create()
  * @see tapi_test_add_mock()
+ * @see tapi_test_add_mock_entry()
+ * @see tapi_test_add_mock_got()
  * @see tapi_test_destroy()
  */
 typedef struct {
@@ -55,10 +78,15 @@ typedef struct {
     tapi_test_func_t function;
     /** pointer to the setup and teardown functions. */
     tapi_gen_func_t setup, teardown;
-    /** dynamic array of mock pointers. */
-    dyna_t* mocks;
+    /** vector of mock pointers. */
+    tapi_mocks_t mocks;
     /** result of calling the test. */
     e_tapi_test_result_t result;
+    /** allocations made by the test function. */
+    tapi_alloc_stats_t allocs;
+    /** blocks (and bytes) allocated by the test function and still live after teardown, if
+     *  leaks are checked (see tapi_leak_check()). */
+    size_t leaks, leaked;
 } tapi_test_t;
 
 /**
@@ -83,7 +111,8 @@ TAPI_EXPORT void
 tapi_test_run(void);
 
 /**
- * @brief make a new test given minimal information.
+ * @brief make a new test given minimal information; the test and its name live in tapi's
+ *  internal arena until the program exits, the mocks are kept inline until there are many.
  *
  * @param name the name of the test.
  * @param function the test function to be used.
@@ -103,9 +132,72 @@ TAPI_EXPORT void
 tapi_test_add_mock(tapi_test_t* test, void* tested, void* target, void* mocked);
 
 /**
- * @brief free and destroy a list of tests after they have been ran.
+ * @brief add a mock of every call to a target, from any function in the program, to a test.
+ *
+ * @param test the test to be altered.
+ * @param target the target address to redirect to mock.
+ * @param mocked the mocked result to be redirected to.
+ * @return the number of call sites mocked.
+ */
+TAPI_EXPORT size_t
+tapi_test_add_mock_all(tapi_test_t* test, void* target, void* mocked);
+
+/**
+ * @brief add a mock of a target to a test that patches the entry of the target itself, so every
+ *  caller is redirected (indirect and cross-library calls too).
+ *
+ * @param test the test to be altered.
+ * @param target the target function to redirect to mock.
+ * @param mocked the mocked result to be redirected to.
+ * @return the mock, whose `original` still calls the target, or 0x0 if its entry can't be
+ *  patched.
+ */
+TAPI_EXPORT struct tapi_mock*
+tapi_test_add_mock_entry(tapi_test_t* test, void* target, void* mocked);
+
+/**
+ * @brief add a mock of a shared-library function to a test, swapping the got slots it is called
+ *  through (see tapi_mock_create_got()).
+ *
+ * @param test the test to be altered.
+ * @param symbol the name of the function to redirect to mock.
+ * @param mocked the mocked result to be redirected to.
+ * @return the mock, whose `original` is the real function, or 0x0 if there is no slot to swap.
+ */
+TAPI_EXPORT struct tapi_mock*
+tapi_test_add_mock_got(tapi_test_t* test, const char* symbol, void* mocked);
+
+/**
+ * @brief add a mock of a target to a test that only applies to the thread running it, so tests
+ *  on other threads can mock the same target differently (see tapi_mock_create_dispatch()).
+ *
+ * @param test the test to be altered.
+ * @param target the target function to redirect to mock.
+ * @param mocked the mocked result to be redirected to.
+ * @return the mock, or 0x0 if nothing calls the target.
+ */
+TAPI_EXPORT struct tapi_mock*
+tapi_test_add_mock_dispatch(tapi_test_t* test, void* target, void* mocked);
+
+/**
+ * @brief add a spy of every call to a target within a tested function (or from anywhere) to a
+ *  test; each call is counted and its arguments recorded (see tapi_mock_create_spy()), then it
+ *  goes on to a mock, or the target. the counts start over every time the test runs.
+ *
+ * @param test the test to be altered.
+ * @param tested the tested function to search through, or 0x0 for every caller.
+ * @param target the target function to spy on.
+ * @param mocked the function the calls go to, or 0x0 for the target.
+ * @return the spy mock, or 0x0 if nothing calls the target.
+ */
+TAPI_EXPORT struct tapi_mock*
+tapi_test_add_mock_spy(tapi_test_t* test, void* tested, void* target, void* mocked);
+
+/**
+ * @brief free and destroy a list of tests after they have been ran; the tests, their names and
+ *  mocks themselves are released with tapi's internal arena when the program exits.
  *
- * @param tests the tests to be freed (this also frees all of its elements, including mocks).
+ * @param tests the tests to be freed.
  * @param length the number of tests to be freed.
  */
 TAPI_EXPORT void
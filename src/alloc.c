@@ -0,0 +1,161 @@
+/**
+ * \cond
+ * @author Sean Hobeck
+ * @date 2026-10-19
+ */
+#include <tapi/alloc.h>
+
+/*! @uses size_t. */
+#include <stddef.h>
+
+/*! @uses malloc_usable_size. */
+#include <malloc.h>
+
+/*! @uses errno, ENOMEM, EINVAL. */
+#include <errno.h>
+
+/*! @uses internal. */
+#include "intt.h"
+
+/*! @uses leak_track, leak_untrack. */
+#include "leak.h"
+/** \endcond */
+
+/* the counters of this thread; initial-exec so reading them never allocates. */
+static _Thread_local tapi_alloc_stats_t l_stats __attribute__((tls_model("initial-exec")));
+
+/**
+ * @brief get the allocation counters of the calling thread.
+ *
+ * @return a copy of the counters.
+ */
+tapi_alloc_stats_t
+tapi_alloc_stats(void) {
+    return l_stats;
+}
+
+/** @brief reset the allocation counters of the calling thread. */
+void
+tapi_alloc_reset(void) {
+    l_stats = (tapi_alloc_stats_t) { 0 };
+}
+
+#if defined(__GLIBC__)
+/* the allocator of glibc, which we forward to. */
+extern void* __libc_malloc(size_t size);
+extern void* __libc_calloc(size_t count, size_t size);
+extern void* __libc_realloc(void* ptr, size_t size);
+extern void __libc_free(void* ptr);
+extern void* __libc_memalign(size_t alignment, size_t size);
+
+/**
+ * @brief count an allocation, and track it for leak checking.
+ *
+ * @param ptr the allocated memory (nothing is counted if 0x0).
+ * @param size the number of bytes requested.
+ * @param site the address the allocation was made from.
+ */
+internal void
+record_alloc(void* ptr, size_t size, const void* site) {
+    if (ptr == 0x0)
+        return;
+    leak_track(ptr, size, site);
+    l_stats.allocs++;
+    l_stats.bytes += size;
+    l_stats.live += malloc_usable_size(ptr);
+    if (l_stats.live > l_stats.peak)
+        l_stats.peak = l_stats.live;
+}
+
+/**
+ * @brief count a free, before the memory is released.
+ *
+ * @param ptr the memory about to be freed (nothing is counted if 0x0).
+ */
+internal void
+record_free(void* ptr) {
+    if (ptr == 0x0)
+        return;
+    leak_untrack(ptr);
+    size_t usable = malloc_usable_size(ptr);
+    l_stats.frees++;
+    l_stats.live = l_stats.live > usable ? l_stats.live - usable : 0u;
+}
+
+TAPI_EXPORT void*
+malloc(size_t size) {
+    void* ptr = __libc_malloc(size);
+    record_alloc(ptr, size, __builtin_return_address(0));
+    return ptr;
+}
+
+TAPI_EXPORT void*
+calloc(size_t count, size_t size) {
+    void* ptr = __libc_calloc(count, size);
+    record_alloc(ptr, count * size, __builtin_return_address(0));
+    return ptr;
+}
+
+TAPI_EXPORT void*
+realloc(void* ptr, size_t size) {
+    /* a resize is counted as the old block being freed and a new one allocated. */
+    if (ptr != 0x0 && size == 0u) {
+        record_free(ptr);
+        return __libc_realloc(ptr, size);
+    }
+    size_t usable = ptr != 0x0 ? malloc_usable_size(ptr) : 0u;
+    void* result = __libc_realloc(ptr, size);
+    if (result == 0x0)
+        return 0x0;
+    if (ptr != 0x0) {
+        leak_untrack(ptr);
+        l_stats.frees++;
+        l_stats.live = l_stats.live > usable ? l_stats.live - usable : 0u;
+    }
+    record_alloc(result, size, __builtin_return_address(0));
+    return result;
+}
+
+TAPI_EXPORT void
+free(void* ptr) {
+    record_free(ptr);
+    __libc_free(ptr);
+}
+
+/**
+ * @brief aligned allocation behind memalign, aligned_alloc and posix_memalign.
+ *
+ * @param alignment the alignment, a power of two.
+ * @param size the number of bytes.
+ * @param site the address the allocation was made from.
+ * @return the allocated memory, or 0x0.
+ */
+internal void*
+aligned(size_t alignment, size_t size, const void* site) {
+    void* ptr = __libc_memalign(alignment, size);
+    record_alloc(ptr, size, site);
+    return ptr;
+}
+
+TAPI_EXPORT void*
+memalign(size_t alignment, size_t size) {
+    return aligned(alignment, size, __builtin_return_address(0));
+}
+
+TAPI_EXPORT void*
+aligned_alloc(size_t alignment, size_t size) {
+    return aligned(alignment, size, __builtin_return_address(0));
+}
+
+TAPI_EXPORT int
+posix_memalign(void** ptr, size_t alignment, size_t size) {
+    /* the alignment has to be a power of two multiple of sizeof(void*). */
+    if (alignment % sizeof(void*) != 0u || (alignment & (alignment - 1u)) != 0u)
+        return EINVAL;
+    void* result = aligned(alignment, size, __builtin_return_address(0));
+    if (result == 0x0)
+        return ENOMEM;
+    *ptr = result;
+    return 0;
+}
+#endif
@@ -0,0 +1,181 @@
+/**
+ * \cond
+ * @author Sean Hobeck
+ * @date 2026-10-19
+ */
+/* we have to define this to use MAP_ANONYMOUS. */
+#define _DEFAULT_SOURCE
+
+#include <tapi/arena.h>
+
+/*! @uses fprintf, stderr. */
+#include <stdio.h>
+
+/*! @uses calloc, free. */
+#include <stdlib.h>
+
+/*! @uses uintptr_t. */
+#include <stdint.h>
+
+/*! @uses mmap, munmap, MAP_FAILED. */
+#include <sys/mman.h>
+
+/*! @uses sysconf, _SC_PAGESIZE. */
+#include <unistd.h>
+
+/*! @uses errno. */
+#include <errno.h>
+
+/*! @uses internal. */
+#include "intt.h"
+/** \endcond */
+
+/* the arena of the test suite. */
+static tapi_arena_t* l_arena;
+
+/**
+ * @brief map a new chunk.
+ *
+ * @param size the least size of the chunk (including its header).
+ * @return the chunk, or 0x0 if it could not be mapped.
+ */
+internal tapi_arena_chunk_t*
+chunk_map(size_t size) {
+    size_t page = (size_t) sysconf(_SC_PAGESIZE);
+    size = (size + page - 1u) & ~(page - 1u);
+    void* memory = mmap(0x0, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) {
+        /* NOLINTNEXTLINE */
+        fprintf(stderr, "tapi, arena_alloc; mmap failed; could not map a chunk of %zu bytes. "
+                        "errno: %d\n", size, errno);
+        return 0x0;
+    }
+    tapi_arena_chunk_t* chunk = memory;
+    chunk->next = 0x0;
+    chunk->size = size;
+    chunk->used = sizeof *chunk;
+    return chunk;
+}
+
+/**
+ * @brief bump through a chunk.
+ *
+ * @param chunk the chunk to allocate from.
+ * @param size the number of bytes.
+ * @param alignment the alignment, a power of two.
+ * @return a pointer to the memory, or 0x0 if it does not fit in the chunk.
+ */
+internal void*
+chunk_bump(tapi_arena_chunk_t* chunk, size_t size, size_t alignment) {
+    uintptr_t base = (uintptr_t) chunk;
+    uintptr_t at = (base + chunk->used + alignment - 1u) & ~(uintptr_t)(alignment - 1u);
+    if (at - base > chunk->size || size > chunk->size - (at - base))
+        return 0x0;
+    chunk->used = at - base + size;
+    return (void*) at;
+}
+
+/**
+ * @brief make an empty arena; chunks are mapped on first use.
+ *
+ * @param chunk_size the size of a chunk (rounded up to pages), 0 for 1 MiB.
+ * @return a pointer to an allocated arena.
+ */
+tapi_arena_t*
+tapi_arena_make(size_t chunk_size) {
+    tapi_arena_t* arena = calloc(1u, sizeof *arena);
+    arena->chunk_size = chunk_size ? chunk_size : 1024u * 1024u;
+    return arena;
+}
+
+/**
+ * @brief allocate memory from an arena, aligned to 16 bytes; allocations larger than a chunk
+ *  get a chunk of their own.
+ *
+ * @param arena the arena to allocate from.
+ * @param size the number of bytes.
+ * @return a pointer to the memory, or 0x0 if a chunk could not be mapped.
+ */
+void*
+tapi_arena_alloc(tapi_arena_t* arena, size_t size) {
+    return tapi_arena_alloc_aligned(arena, size, 16u);
+}
+
+/**
+ * @brief allocate aligned memory from an arena.
+ *
+ * @param arena the arena to allocate from.
+ * @param size the number of bytes.
+ * @param alignment the alignment, a power of two.
+ * @return a pointer to the memory, or 0x0 if a chunk could not be mapped.
+ */
+void*
+tapi_arena_alloc_aligned(tapi_arena_t* arena, size_t size, size_t alignment) {
+    /* the current chunk, then the ones kept from before the last reset. */
+    for (tapi_arena_chunk_t* chunk = arena->current; chunk != 0x0; chunk = chunk->next) {
+        void* memory = chunk_bump(chunk, size, alignment);
+        if (memory != 0x0) {
+            arena->current = chunk;
+            return memory;
+        }
+    }
+
+    /* o.w. map a new chunk, large enough for this allocation, at the end of the list. */
+    size_t least = sizeof(tapi_arena_chunk_t) + alignment + size;
+    tapi_arena_chunk_t* chunk = chunk_map(least > arena->chunk_size ? least :
+                                          arena->chunk_size);
+    if (chunk == 0x0)
+        return 0x0;
+    if (arena->first == 0x0)
+        arena->first = chunk;
+    else {
+        tapi_arena_chunk_t* last = arena->current;
+        while (last->next != 0x0)
+            last = last->next;
+        last->next = chunk;
+    }
+    arena->current = chunk;
+    return chunk_bump(chunk, size, alignment);
+}
+
+/**
+ * @brief release everything allocated from an arena at once, keeping its chunks.
+ *
+ * @param arena the arena to be reset.
+ */
+void
+tapi_arena_reset(tapi_arena_t* arena) {
+    for (tapi_arena_chunk_t* chunk = arena->first; chunk != 0x0; chunk = chunk->next)
+        chunk->used = sizeof *chunk;
+    arena->current = arena->first;
+}
+
+/**
+ * @brief unmap every chunk of an arena and free it.
+ *
+ * @param arena the arena to be destroyed.
+ */
+void
+tapi_arena_destroy(tapi_arena_t* arena) {
+    tapi_arena_chunk_t* chunk = arena->first;
+    while (chunk != 0x0) {
+        tapi_arena_chunk_t* next = chunk->next;
+        munmap(chunk, chunk->size);
+        chunk = next;
+    }
+    if (arena == l_arena)
+        l_arena = 0x0;
+    free(arena);
+}
+
+/**
+ * @brief get the arena of the test suite, which the runner resets after every test.
+ *
+ * @return the arena of the test suite.
+ */
+tapi_arena_t*
+tapi_arena(void) {
+    if (l_arena == 0x0)
+        l_arena = tapi_arena_make(0u);
+    return l_arena;
+}
@@ -0,0 +1,1237 @@
+/**
+ * \cond
+ * @author Sean Hobeck
+ * @date 2026-10-19
+ */
+/* we have to define this to use clock_gettime(), strdup(), getline() and pthreads. */
+#define _POSIX_C_SOURCE 200809L
+
+#include <tapi/bench.h>
+
+/*! @uses fprintf, fopen, getline, stderr. */
+#include <stdio.h>
+
+/*! @uses calloc, aligned_alloc, free, qsort, strtod, getenv, atoi, EXIT_SUCCESS. */
+#include <stdlib.h>
+
+/*! @uses memcpy, memset, strcmp, strdup, strtok_r. */
+#include <string.h>
+
+/*! @uses sqrt, erfc, log2, INFINITY. */
+#include <math.h>
+
+/*! @uses bool. */
+#include <stdbool.h>
+
+/*! @uses clock_gettime, CLOCK_MONOTONIC. */
+#include <time.h>
+
+/*! @uses errno. */
+#include <errno.h>
+
+/*! @uses pthread_t, pthread_create, pthread_join, pthread_attr_t, pthread_cond_wait. */
+#include <pthread.h>
+
+/*! @uses SCHED_OTHER, struct sched_param. */
+#include <sched.h>
+
+/*! @uses sysconf, _SC_NPROCESSORS_ONLN. */
+#include <unistd.h>
+
+/*! @uses tapi_mock_t, tapi_mock_create, tapi_mock_apply_all, tapi_mock_restore_all. */
+#include <tapi/mock.h>
+
+/*! @uses internal. */
+#include "intt.h"
+
+/*! @uses env_isolate, env_restore, env_probe, env_warn, env_pin_thread. */
+#include "env.h"
+
+/*! @uses cache_flush, cache_evict. */
+#include "cache.h"
+
+/*! @uses frame_intern. */
+#include "frame.h"
+/** \endcond */
+
+/* operations per cold sample, when the benchmark has no iteration count. */
+#define COLD_ITERATIONS 8u
+
+/* local benchmark suite. */
+static dyna_t* l_benches;
+
+/* local baseline configuration. */
+static struct {
+    /* path to the baseline file, and what to do with it. */
+    char* path;
+    e_tapi_bench_baseline_t mode;
+    /* tolerated relative slowdown and significance level. */
+    double threshold, alpha;
+    /* stream to export json results to. */
+    tapi_stream_t report;
+    /* cpu to pin to (-1 for none), and extra isolation. */
+    int cpu;
+    unsigned int isolate;
+} l_config = { 0x0, E_TAPI_BENCH_BASELINE_NONE, 0.05, 0.05, 0x0, -1, 0u };
+
+/* readable names, and baseline file tokens of the complexity classes. */
+static const char* l_complexity_names[] = {
+    "none", "O(1)", "O(log n)", "O(n)", "O(n log n)", "O(n^2)"
+};
+static const char* l_complexity_tokens[] = { "none", "1", "logn", "n", "nlogn", "n2" };
+
+/**
+ * the barrier the threads of a scaling run wait on, every field in its own cache line; the
+ *  main thread sleeps on the condition until everyone has arrived, the threads spin on go.
+ */
+typedef struct {
+    _Alignas(64) size_t arrived;
+    pthread_mutex_t lock;
+    pthread_cond_t all_arrived;
+    _Alignas(64) int go;
+    _Alignas(64) uint64_t start;
+} barrier_t;
+
+/** a thread of a scaling run; aligned so no two threads share a cache line. */
+typedef struct {
+    _Alignas(64) tapi_bench_t* bench;
+    barrier_t* barrier;
+    /* index of the thread, the cpu to pin to (-1 for none), and the overhead of timing. */
+    size_t index, count;
+    int cpu;
+    uint64_t overhead;
+    /* operations done, when the last one ended, and their latencies. */
+    uint64_t ops, end;
+    tapi_hist_t* hist;
+} worker_t;
+
+/** a single benchmark record read from a baseline file. */
+typedef struct {
+    char* name;
+    double* samples;
+    size_t count;
+    /* fitted complexity class of a size sweep, E_TAPI_BENCH_O_NONE if there is none. */
+    e_tapi_bench_complexity_t complexity;
+} baseline_t;
+
+/** @return the current monotonic time in nanoseconds. */
+internal double
+now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec * 1e9 + (double) ts.tv_nsec;
+}
+
+/** comparison function for sorting doubles in ascending order. */
+internal int
+cmp_double(const void* a, const void* b) {
+    double x = *(const double*) a, y = *(const double*) b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief time a single sample of a benchmark.
+ *
+ * @param bench the benchmark to be timed.
+ * @param iterations the number of operations in the sample.
+ * @return the total time taken in nanoseconds.
+ */
+internal double
+time_sample(tapi_bench_t* bench, size_t iterations) {
+    tapi_bench_state_t state = { .index = 0u, .size = bench->size, .data = bench->data,
+                                 .threads = 1u };
+    double start = now_ns();
+    for (; state.index < iterations; state.index++)
+        bench->function(&state);
+    return now_ns() - start;
+}
+
+/** @return the cheapest back-to-back clock read in nanoseconds, the overhead of timing. */
+internal uint64_t
+clock_overhead(void) {
+    uint64_t overhead = UINT64_MAX;
+    for (size_t i = 0u; i < 64u; i++) {
+        uint64_t start = tapi_hist_now();
+        uint64_t elapsed = tapi_hist_now() - start;
+        if (elapsed < overhead) overhead = elapsed;
+    }
+    return overhead;
+}
+
+/**
+ * @brief evict the caches before a cold operation; flush the input of the benchmark, or
+ *  stream the llc when there is none, or it cannot be flushed.
+ *
+ * @param bench the benchmark to be evicted for.
+ */
+internal void
+evict(const tapi_bench_t* bench) {
+    if (bench->input == 0x0 || !e_intt_passed(cache_flush(bench->input, bench->input_size)))
+        cache_evict();
+}
+
+/**
+ * @brief time a single cold sample of a benchmark; every operation is timed on its own
+ *  after evicting the caches, so the eviction is not part of the time.
+ *
+ * @param bench the benchmark to be timed.
+ * @param iterations the number of operations in the sample.
+ * @param overhead the overhead of timing, to be subtracted from every operation.
+ * @return the total time taken in nanoseconds.
+ */
+internal double
+time_cold_sample(tapi_bench_t* bench, size_t iterations, uint64_t overhead) {
+    tapi_bench_state_t state = { .index = 0u, .size = bench->size, .data = bench->data,
+                                 .threads = 1u };
+    double total = 0.0;
+    for (; state.index < iterations; state.index++) {
+        evict(bench);
+        uint64_t start = tapi_hist_now();
+        bench->function(&state);
+        uint64_t elapsed = tapi_hist_now() - start;
+        total += (double)(elapsed > overhead ? elapsed - overhead : 0u);
+    }
+    return total;
+}
+
+/**
+ * @brief find an iteration count so that a sample runs for at least min_time; this also
+ *  serves as the warmup of the benchmark.
+ *
+ * @param bench the benchmark to be calibrated.
+ * @return the number of operations per sample.
+ */
+internal size_t
+calibrate(tapi_bench_t* bench) {
+    size_t iterations = 1u;
+    for (;;) {
+        double elapsed = time_sample(bench, iterations);
+        if (elapsed >= bench->min_time || iterations >= (1u << 30u))
+            return iterations;
+
+        /* grow by the measured ratio, but at most tenfold per step. */
+        double scale = elapsed > 0.0 ? bench->min_time * 1.2 / elapsed : 10.0;
+        iterations = (size_t)((double) iterations * (scale > 10.0 ? 10.0 : scale)) + 1u;
+    }
+}
+
+/**
+ * @brief compute summary statistics over a list of samples.
+ *
+ * @param samples the samples to summarize.
+ * @param count the number of samples.
+ * @return the summary statistics.
+ */
+internal tapi_bench_stats_t
+summarize(const double* samples, size_t count) {
+    tapi_bench_stats_t stats = { 0 };
+    if (count == 0u)
+        return stats;
+
+    /* sort a copy so we can take the median. */
+    double* sorted = calloc(count, sizeof *sorted);
+    /* NOLINTNEXTLINE */
+    memcpy(sorted, samples, count * sizeof *sorted);
+    qsort(sorted, count, sizeof *sorted, cmp_double);
+    stats.min = sorted[0];
+    stats.max = sorted[count - 1u];
+    stats.median = count % 2u ? sorted[count / 2u] :
+        (sorted[count / 2u - 1u] + sorted[count / 2u]) / 2.0;
+    for (size_t i = 0u; i < count; i++)
+        stats.mean += sorted[i];
+    stats.mean /= (double) count;
+    free(sorted);
+    return stats;
+}
+
+/**
+ * @brief calibrate (and warm up) a benchmark, then take every sample and summarize them;
+ *  cold samples are not calibrated, see tapi_bench_cache().
+ *
+ * @param bench the benchmark to be measured.
+ * @param cold whether to evict the caches before every operation.
+ * @return the number of operations per sample.
+ */
+internal size_t
+measure(tapi_bench_t* bench, bool cold) {
+    size_t iterations = bench->iterations;
+    if (iterations == 0u)
+        iterations = cold ? COLD_ITERATIONS : calibrate(bench);
+    uint64_t overhead = cold ? clock_overhead() : 0u;
+    free(bench->samples);
+    bench->samples = calloc(bench->repetitions, sizeof *bench->samples);
+    for (size_t j = 0u; j < bench->repetitions; j++) {
+        double elapsed = cold ? time_cold_sample(bench, iterations, overhead) :
+            time_sample(bench, iterations);
+        bench->samples[j] = elapsed / (double) iterations;
+    }
+    bench->stats = summarize(bench->samples, bench->repetitions);
+    return iterations;
+}
+
+/**
+ * @brief measure a benchmark at every size of its sweep and fit the results; the samples
+ *  and statistics of the benchmark are left as those of the largest size.
+ *
+ * @param bench the benchmark to be swept.
+ * @return the number of operations per sample at the largest size.
+ */
+internal size_t
+sweep(tapi_bench_t* bench) {
+    /* count the points first, so we can allocate them at once. */
+    double factor = bench->sweep.factor > 1.0 ? bench->sweep.factor : 2.0;
+    size_t count = 0u;
+    for (size_t n = bench->sweep.low; n <= bench->sweep.high; count++) {
+        size_t next = (size_t)((double) n * factor);
+        n = next > n ? next : n + 1u;
+    }
+    free(bench->points);
+    bench->points = calloc(count, sizeof *bench->points);
+    bench->point_count = count;
+
+    /* measure each point. */
+    size_t iterations = 0u, n = bench->sweep.low;
+    size_t* sizes = calloc(count, sizeof *sizes);
+    double* times = calloc(count, sizeof *times);
+    for (size_t i = 0u; i < count; i++) {
+        bench->size = n;
+        iterations = measure(bench, bench->cache == E_TAPI_BENCH_CACHE_COLD);
+        bench->points[i] = (tapi_bench_point_t) { .size = n, .median = bench->stats.median };
+        sizes[i] = n;
+        times[i] = bench->stats.median;
+        size_t next = (size_t)((double) n * factor);
+        n = next > n ? next : n + 1u;
+    }
+    bench->fit = tapi_bench_fit(sizes, times, count);
+    free(sizes);
+    free(times);
+    return iterations;
+}
+
+/**
+ * @brief measure a benchmark with cold caches, keeping the warm samples and statistics as
+ *  the ones that are reported and compared against the baseline.
+ *
+ * @param bench the benchmark to be measured.
+ */
+internal void
+measure_cold(tapi_bench_t* bench) {
+    double* warm = bench->samples;
+    tapi_bench_stats_t stats = bench->stats;
+    bench->samples = 0x0;
+    measure(bench, true);
+    bench->cold = bench->stats;
+    free(bench->samples);
+    bench->samples = warm;
+    bench->stats = stats;
+}
+
+/**
+ * @brief time every operation of a sample on its own and record it into the benchmark's
+ *  latency histogram; the cost of reading the clock is measured and subtracted.
+ *
+ * @param bench the benchmark to be timed.
+ * @param iterations the number of operations to time.
+ * @param cold whether to evict the caches before every operation.
+ */
+internal void
+time_latency(tapi_bench_t* bench, size_t iterations, bool cold) {
+    uint64_t overhead = clock_overhead();
+
+    /* record every operation. */
+    if (bench->hist == 0x0)
+        bench->hist = tapi_hist_make();
+    tapi_hist_reset(bench->hist);
+    tapi_bench_state_t state = { .index = 0u, .size = bench->size, .data = bench->data,
+                                 .threads = 1u };
+    for (; state.index < iterations; state.index++) {
+        if (cold) evict(bench);
+        uint64_t start = tapi_hist_now();
+        bench->function(&state);
+        uint64_t elapsed = tapi_hist_now() - start;
+        tapi_hist_record(bench->hist, elapsed > overhead ? elapsed - overhead : 0u);
+    }
+}
+
+/** @brief tell the cpu we are spinning, so a sibling hyper-thread can use the core. */
+internal void
+spin_pause(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    __asm__ volatile("pause");
+#elif defined(__aarch64__) || defined(__arm__)
+    __asm__ volatile("yield");
+#endif
+}
+
+/**
+ * @brief the body of a thread in a scaling run; wait on the barrier, then run operations
+ *  until min_time has passed since the release.
+ *
+ * @param arg the worker of the thread.
+ * @return 0x0.
+ */
+internal void*
+worker_run(void* arg) {
+    worker_t* worker = arg;
+    tapi_bench_t* bench = worker->bench;
+    if (worker->cpu >= 0)
+        env_pin_thread(worker->cpu);
+    tapi_bench_state_t state = { .index = 0u, .size = bench->size, .data = bench->data,
+                                 .thread = worker->index, .threads = worker->count };
+
+    /* arrive, and spin until everyone has. */
+    pthread_mutex_lock(&worker->barrier->lock);
+    worker->barrier->arrived++;
+    pthread_cond_signal(&worker->barrier->all_arrived);
+    pthread_mutex_unlock(&worker->barrier->lock);
+    while (!__atomic_load_n(&worker->barrier->go, __ATOMIC_ACQUIRE))
+        spin_pause();
+
+    /* every operation is timed, the end of one is the start of the next. */
+    uint64_t deadline = worker->barrier->start + (uint64_t) bench->min_time;
+    uint64_t now = tapi_hist_now();
+    while (now < deadline) {
+        bench->function(&state);
+        uint64_t next = tapi_hist_now(), elapsed = next - now;
+        tapi_hist_record(worker->hist, elapsed > worker->overhead ? elapsed -
+                         worker->overhead : 0u);
+        now = next;
+        state.index++;
+    }
+    worker->ops = state.index;
+    worker->end = now;
+    return 0x0;
+}
+
+/**
+ * @brief run a benchmark on a number of threads released from a barrier at once.
+ *
+ * @param bench the benchmark to be run.
+ * @param count the number of threads.
+ * @param scale the throughput and latencies to fill in.
+ * @return ref. to intt.h for enum, fails if memory could not be allocated or a thread could
+ *  not be created.
+ */
+internal e_intt_result_t
+scale_run(tapi_bench_t* bench, size_t count, tapi_bench_scale_t* scale) {
+    barrier_t* barrier = aligned_alloc(64u, sizeof *barrier);
+    worker_t* workers = aligned_alloc(64u, count * sizeof *workers);
+    pthread_t* threads = calloc(count, sizeof *threads);
+    if (barrier == 0x0 || workers == 0x0 || threads == 0x0) {
+        /* NOLINTNEXTLINE */
+        fprintf(stderr, "tapi, bench_run; malloc failed; could not allocate %zu threads.\n",
+                count);
+        free(threads);
+        free(workers);
+        free(barrier);
+        return E_INTT_RESULT_FAILURE;
+    }
+    /* NOLINTNEXTLINE */
+    memset(barrier, 0, sizeof *barrier);
+    pthread_mutex_init(&barrier->lock, 0x0);
+    pthread_cond_init(&barrier->all_arrived, 0x0);
+    uint64_t overhead = clock_overhead();
+
+    /*
+     * the threads would inherit SCHED_FIFO from us if we were isolated, and a spinning fifo
+     *  thread never gives up its cpu; they run under the normal scheduler instead.
+     */
+    pthread_attr_t attr;
+    struct sched_param param = { .sched_priority = 0 };
+    pthread_attr_init(&attr);
+    pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+    pthread_attr_setschedpolicy(&attr, SCHED_OTHER);
+    pthread_attr_setschedparam(&attr, &param);
+
+    /* spread pinned threads over the cpus following the one we were pinned to. */
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t created = 0u;
+    for (; created < count; created++) {
+        worker_t* worker = &workers[created];
+        *worker = (worker_t) { .bench = bench, .barrier = barrier, .index = created,
+                               .count = count, .cpu = -1, .overhead = overhead,
+                               .hist = tapi_hist_make() };
+        if ((bench->env.flags & E_TAPI_BENCH_ENV_PINNED) && cpus > 0)
+            worker->cpu = (int)(((size_t) bench->env.cpu + 1u + created) % (size_t) cpus);
+        if (pthread_create(&threads[created], &attr, worker_run, worker) != 0) {
+            /* NOLINTNEXTLINE */
+            fprintf(stderr, "tapi, bench_run; pthread_create failed; could not start thread %zu "
+                            "of %zu.\n", created + 1u, count);
+            tapi_hist_destroy(worker->hist);
+            break;
+        }
+    }
+
+    pthread_attr_destroy(&attr);
+
+    /* sleep until everyone has arrived, then release them at once (those that started). */
+    pthread_mutex_lock(&barrier->lock);
+    while (barrier->arrived < created)
+        pthread_cond_wait(&barrier->all_arrived, &barrier->lock);
+    pthread_mutex_unlock(&barrier->lock);
+    barrier->start = tapi_hist_now();
+    __atomic_store_n(&barrier->go, 1, __ATOMIC_RELEASE);
+
+    /* join, and combine what every thread counted. */
+    tapi_hist_t* hist = tapi_hist_make();
+    uint64_t ops = 0u, end = barrier->start;
+    for (size_t i = 0u; i < created; i++) {
+        pthread_join(threads[i], 0x0);
+        ops += workers[i].ops;
+        if (workers[i].end > end) end = workers[i].end;
+        tapi_hist_merge(hist, workers[i].hist);
+        tapi_hist_destroy(workers[i].hist);
+    }
+    double elapsed = (double)(end - barrier->start);
+    *scale = (tapi_bench_scale_t) { .threads = count,
+        .throughput = elapsed > 0.0 ? (double) ops * 1e9 / elapsed : 0.0,
+        .p50 = tapi_hist_percentile(hist, 50.0), .p99 = tapi_hist_percentile(hist, 99.0) };
+    tapi_hist_destroy(hist);
+    pthread_cond_destroy(&barrier->all_arrived);
+    pthread_mutex_destroy(&barrier->lock);
+    free(threads);
+    free(workers);
+    free(barrier);
+    return created == count ? E_INTT_RESULT_SUCCESS : E_INTT_RESULT_FAILURE;
+}
+
+/**
+ * @brief scale a benchmark over 1, 2, 4, ... up to its thread count.
+ *
+ * @param bench the benchmark to be scaled.
+ * @return whether the efficiency stayed at or above the threshold at every count.
+ */
+internal bool
+scale(tapi_bench_t* bench) {
+    size_t count = 0u;
+    for (size_t n = 1u; n < bench->threads; n *= 2u)
+        count++;
+    count++;
+    free(bench->scaling);
+    bench->scaling = calloc(count, sizeof *bench->scaling);
+    bench->scale_count = 0u;
+
+    /* every count; the last one is the largest, even if it is not a power of two. */
+    bool efficient = true;
+    for (size_t i = 0u, n = 1u; i < count; i++, n *= 2u) {
+        tapi_bench_scale_t* point = &bench->scaling[i];
+        if (!e_intt_passed(scale_run(bench, i + 1u == count ? bench->threads : n, point)))
+            break;
+        bench->scale_count++;
+        double single = bench->scaling[0].throughput;
+        point->speedup = single > 0.0 ? point->throughput / single : 0.0;
+        point->efficiency = point->speedup / (double) point->threads;
+        if (point->efficiency < bench->efficiency)
+            efficient = false;
+    }
+    return efficient;
+}
+
+/**
+ * @brief export the results of a benchmark as a single json line.
+ *
+ * @param bench the benchmark to be exported.
+ * @param iterations the number of operations per sample.
+ * @param stream the stream to export to.
+ */
+internal void
+report_write(const tapi_bench_t* bench, size_t iterations, tapi_stream_t stream) {
+    fprintf(stream, "{\"name\":\"");
+    for (const char* c = bench->name; *c; c++)
+        fprintf(stream, *c == '"' || *c == '\\' ? "\\%c" : "%c", *c);
+    fprintf(stream, "\",\"result\":\"%s\",\"repetitions\":%zu,\"iterations\":%zu,"
+                    "\"min\":%.3f,\"median\":%.3f,\"mean\":%.3f,\"max\":%.3f,"
+                    "\"p_value\":%.6f,\"change\":%.6f,\"samples\":[",
+            bench->result == E_TAPI_TEST_RESULT_PASSED ? "passed" : "regressed",
+            bench->repetitions, iterations, bench->stats.min, bench->stats.median,
+            bench->stats.mean, bench->stats.max, bench->p_value, bench->change);
+    for (size_t i = 0u; i < bench->repetitions; i++)
+        fprintf(stream, i ? ",%.3f" : "%.3f", bench->samples[i]);
+    fprintf(stream, "],\"env\":{\"cpu\":%d,\"governor\":\"%s\",\"load\":%.2f,\"pinned\":%s,"
+                    "\"fifo\":%s,\"mlock\":%s,\"turbo\":%s,\"smt\":%s,\"loaded\":%s}",
+            bench->env.cpu, bench->env.governor, bench->env.load,
+            bench->env.flags & E_TAPI_BENCH_ENV_PINNED ? "true" : "false",
+            bench->env.flags & E_TAPI_BENCH_ENV_FIFO ? "true" : "false",
+            bench->env.flags & E_TAPI_BENCH_ENV_MLOCK ? "true" : "false",
+            bench->env.flags & E_TAPI_BENCH_ENV_TURBO ? "true" : "false",
+            bench->env.flags & E_TAPI_BENCH_ENV_SMT ? "true" : "false",
+            bench->env.flags & E_TAPI_BENCH_ENV_LOADED ? "true" : "false");
+    if (bench->cache != E_TAPI_BENCH_CACHE_WARM)
+        fprintf(stream, ",\"cache\":\"%s\",\"cold\":{\"min\":%.3f,\"median\":%.3f,"
+                        "\"mean\":%.3f,\"max\":%.3f}",
+                bench->cache == E_TAPI_BENCH_CACHE_COLD ? "cold" : "both", bench->cold.min,
+                bench->cold.median, bench->cold.mean, bench->cold.max);
+    if (bench->scale_count != 0u) {
+        fprintf(stream, ",\"scaling\":[");
+        for (size_t i = 0u; i < bench->scale_count; i++) {
+            const tapi_bench_scale_t* point = &bench->scaling[i];
+            fprintf(stream, "%s{\"threads\":%zu,\"throughput\":%.3f,\"speedup\":%.4f,"
+                            "\"efficiency\":%.4f,\"p50\":%llu,\"p99\":%llu}", i ? "," : "",
+                    point->threads, point->throughput, point->speedup, point->efficiency,
+                    (unsigned long long) point->p50, (unsigned long long) point->p99);
+        }
+        fprintf(stream, "]");
+    }
+    if (bench->mocks->length != 0u)
+        fprintf(stream, ",\"real\":{\"min\":%.3f,\"median\":%.3f,\"mean\":%.3f,\"max\":%.3f}",
+                bench->real.min, bench->real.median, bench->real.mean, bench->real.max);
+    if (bench->point_count != 0u) {
+        fprintf(stream, ",\"sweep\":[");
+        for (size_t i = 0u; i < bench->point_count; i++)
+            fprintf(stream, i ? ",[%zu,%.3f]" : "[%zu,%.3f]", bench->points[i].size,
+                    bench->points[i].median);
+        fprintf(stream, "],\"complexity\":\"%s\",\"coef\":%.6g,\"rms\":%.6f",
+                l_complexity_names[bench->fit.complexity], bench->fit.coef, bench->fit.rms);
+    }
+    fprintf(stream, ",\"latency\":");
+    tapi_hist_export(bench->hist, stream);
+    fprintf(stream, "}\n");
+    fflush(stream);
+}
+
+/**
+ * @brief find the baseline record for a benchmark by name.
+ *
+ * @param records the records read from the baseline.
+ * @param name the name of the benchmark.
+ * @return the record, or 0x0 if there is none.
+ */
+internal baseline_t*
+baseline_find(dyna_t* records, const char* name) {
+    if (records == 0x0)
+        return 0x0;
+    _foreach(records, baseline_t*, record)
+        if (strcmp(record->name, name) == 0)
+            return record;
+    _endforeach;
+    return 0x0;
+}
+
+/**
+ * @brief read every record of a baseline file.
+ *
+ * @param path the path of the baseline file.
+ * @return a dynamic array of baseline_t pointers, or 0x0 if the file could not be read.
+ */
+internal dyna_t*
+baseline_read(const char* path) {
+    FILE* file = fopen(path, "r");
+    if (file == 0x0)
+        return 0x0;
+
+    /* each record is "<kind>\t<name>\t<field>\t<values>\n", where kind is "bench" (sample
+     *  count and samples) or "complexity" (class token and coefficient); a record with many
+     *  samples is long, so the line grows to fit it. */
+    dyna_t* records = dyna_create();
+    char* line = 0x0;
+    size_t capacity = 0u;
+    while (getline(&line, &capacity, file) != -1) {
+        if (line[0] == '#')
+            continue;
+        char* save = 0x0;
+        char* kind = strtok_r(line, "\t", &save);
+        char* name = strtok_r(0x0, "\t", &save);
+        char* field = strtok_r(0x0, "\t", &save);
+        char* values = strtok_r(0x0, "\n", &save);
+        if (kind == 0x0 || name == 0x0 || field == 0x0 || values == 0x0)
+            continue;
+
+        /* both kinds of a benchmark share a record. */
+        baseline_t* record = baseline_find(records, name);
+        if (record == 0x0) {
+            record = calloc(1u, sizeof *record);
+            record->name = strdup(name);
+            dyna_push(records, record);
+        }
+
+        /* parse the samples. */
+        if (strcmp(kind, "bench") == 0 && record->samples == 0x0) {
+            size_t n = strtoul(field, 0x0, 10);
+            record->samples = calloc(n ? n : 1u, sizeof *record->samples);
+            char* end = values;
+            while (record->count < n) {
+                char* start = end;
+                double value = strtod(start, &end);
+                if (end == start)
+                    break;
+                record->samples[record->count++] = value;
+            }
+        }
+        /* or the complexity class. */
+        else if (strcmp(kind, "complexity") == 0) {
+            for (size_t i = 0u; i <= E_TAPI_BENCH_O_N2; i++)
+                if (strcmp(field, l_complexity_tokens[i]) == 0)
+                    record->complexity = (e_tapi_bench_complexity_t) i;
+        }
+    }
+    free(line);
+    fclose(file);
+    return records;
+}
+
+/**
+ * @brief free all records read from a baseline file.
+ *
+ * @param records the records to be freed.
+ */
+internal void
+baseline_free(dyna_t* records) {
+    if (records == 0x0)
+        return;
+    _foreach(records, baseline_t*, record)
+        free(record->name);
+        free(record->samples);
+        free(record);
+    _endforeach;
+    dyna_free(records);
+}
+
+/**
+ * @brief write the results of every benchmark to the baseline file.
+ *
+ * @param path the path of the baseline file.
+ * @return 1 if successful, and 0 o.w.
+ */
+internal int
+baseline_write(const char* path) {
+    FILE* file = fopen(path, "w");
+    if (file == 0x0) {
+        /* NOLINTNEXTLINE */
+        fprintf(stderr, "tapi, bench_run; fopen failed; could not write baseline '%s'. errno: %d\n",
+                path, errno);
+        return 0;
+    }
+    fprintf(file, "# tapi bench baseline v1\n");
+    _foreach(l_benches, tapi_bench_t*, bench)
+        fprintf(file, "bench\t%s\t%zu\t", bench->name, bench->repetitions);
+        for (size_t j = 0u; j < bench->repetitions; j++)
+            fprintf(file, j + 1u < bench->repetitions ? "%.17g " : "%.17g", bench->samples[j]);
+        fprintf(file, "\n");
+        if (bench->fit.complexity != E_TAPI_BENCH_O_NONE)
+            fprintf(file, "complexity\t%s\t%s\t%.17g\n", bench->name,
+                    l_complexity_tokens[bench->fit.complexity], bench->fit.coef);
+    _endforeach;
+    fclose(file);
+    return 1;
+}
+
+/**
+ * @brief set up many benchmarks to be run in concession.
+ *
+ * @param benches the array of benchmarks to be set up.
+ * @param count the number of benchmarks to be set up.
+ */
+void
+tapi_bench_setup(tapi_bench_t** benches, size_t count) {
+    /* if we already have benchmarks. */
+    if (l_benches != 0x0) {
+        /* NOLINTNEXTLINE */
+        fprintf(stderr, "tapi, bench_setup; benches != null; refer to tapi_bench_add().\n");
+        return;
+    }
+
+    /* and we are done. */
+    l_benches = dyna_create();
+    for (size_t i = 0u; i < count; i++)
+        dyna_push(l_benches, benches[i]);
+}
+
+/**
+ * @brief add a benchmark to your benchmark suite.
+ *
+ * @param bench the benchmark to be added.
+ */
+void
+tapi_bench_add(tapi_bench_t* bench) {
+    /* if we don't have benchmarks. */
+    if (l_benches == 0x0)
+        l_benches = dyna_create();
+    dyna_push(l_benches, bench);
+}
+
+/**
+ * @brief remove a benchmark from your benchmark suite; a benchmark has to be removed before it
+ *  is destroyed, or later runs would time it again.
+ *
+ * @param bench the benchmark to be removed.
+ */
+void
+tapi_bench_remove(tapi_bench_t* bench) {
+    if (l_benches == 0x0)
+        return;
+    _foreach_it(l_benches, tapi_bench_t*, other, i)
+        if (other == bench) {
+            dyna_pop(l_benches, i);
+            return;
+        }
+    _endforeach;
+}
+
+/**
+ * @brief remove every benchmark from your benchmark suite, the benchmarks themselves are kept.
+ */
+void
+tapi_bench_clear(void) {
+    if (l_benches == 0x0)
+        return;
+    dyna_free(l_benches);
+    l_benches = 0x0;
+}
+
+/**
+ * @brief run all the benchmarks set up in concession, saving to or comparing against the
+ *  baseline if one is configured.
+ *
+ * @return EXIT_SUCCESS, or EXIT_FAILURE if any benchmark regressed against the baseline.
+ */
+int
+tapi_bench_run(void) {
+    if (l_benches == 0x0)
+        return EXIT_SUCCESS;
+
+    /* the environment overrides the configured baseline. */
+    const char* path = getenv("TAPI_BENCH_BASELINE");
+    e_tapi_bench_baseline_t mode = l_config.mode;
+    if (path != 0x0)
+        mode = E_TAPI_BENCH_BASELINE_COMPARE;
+    else path = l_config.path;
+    const char* save = getenv("TAPI_BENCH_SAVE");
+    if (save != 0x0 && strcmp(save, "1") == 0)
+        mode = E_TAPI_BENCH_BASELINE_SAVE;
+    if (path == 0x0)
+        mode = E_TAPI_BENCH_BASELINE_NONE;
+
+    /* read the baseline if we compare against it. */
+    dyna_t* records = 0x0;
+    if (mode == E_TAPI_BENCH_BASELINE_COMPARE) {
+        records = baseline_read(path);
+        if (records == 0x0) {
+            /* NOLINTNEXTLINE */
+            fprintf(stderr, "tapi, bench_run; could not read baseline '%s'; not comparing.\n",
+                    path);
+        }
+    }
+
+    /* the environment can also ask for the json results to be appended to a file. */
+    tapi_stream_t report = l_config.report;
+    const char* report_path = getenv("TAPI_BENCH_REPORT");
+    if (report_path != 0x0) {
+        report = fopen(report_path, "a");
+        if (report == 0x0) {
+            /* NOLINTNEXTLINE */
+            fprintf(stderr, "tapi, bench_run; fopen failed; could not open report '%s'. "
+                            "errno: %d\n", report_path, errno);
+        }
+    }
+
+    /* isolate ourselves from noise, and warn about what we cannot control. */
+    const char* cpu = getenv("TAPI_BENCH_CPU");
+    tapi_bench_env_t env = { 0 };
+    env_saved_t saved = { 0 };
+    env_isolate(cpu != 0x0 ? atoi(cpu) : l_config.cpu, l_config.isolate, &env, &saved);
+    env_probe(&env);
+    env_warn(&env);
+
+    /* iterate through each benchmark, */
+    size_t passed = 0u;
+    _foreach_it(l_benches, tapi_bench_t*, bench, i)
+        /* the load can change between benchmarks, so probe again and warn if it did. */
+        bench->env = env;
+        env_probe(&bench->env);
+        if ((bench->env.flags & ~env.flags) & E_TAPI_BENCH_ENV_LOADED)
+            env_warn(&(tapi_bench_env_t) { .flags = E_TAPI_BENCH_ENV_LOADED,
+                                           .load = bench->env.load });
+        if (bench->setup != 0x0) bench->setup();
+
+        /* with mocks, first measure against the real dependencies, then isolated. */
+        bool is_sweep = bench->sweep.low != 0u && bench->sweep.high >= bench->sweep.low;
+        bool is_cold = bench->cache == E_TAPI_BENCH_CACHE_COLD;
+        if (bench->mocks->length != 0u) {
+            bench->size = is_sweep ? bench->sweep.high : bench->size;
+            measure(bench, is_cold);
+            bench->real = bench->stats;
+            tapi_mock_apply_all((tapi_mock_t**) bench->mocks->data, bench->mocks->length);
+        }
+        size_t iterations = is_sweep ? sweep(bench) : measure(bench, is_cold);
+        if (bench->cache == E_TAPI_BENCH_CACHE_BOTH)
+            measure_cold(bench);
+        else if (is_cold)
+            bench->cold = bench->stats;
+        time_latency(bench, iterations, is_cold);
+        bool efficient = bench->threads == 0u || scale(bench);
+        if (bench->mocks->length != 0u)
+            tapi_mock_restore_all((tapi_mock_t**) bench->mocks->data, bench->mocks->length);
+        if (bench->teardown != 0x0) bench->teardown();
+
+        /* compare against the baseline; a slowdown fails only if it is significant. */
+        bench->result = E_TAPI_TEST_RESULT_PASSED;
+        bench->p_value = 1.0;
+        bench->change = 0.0;
+        baseline_t* record = baseline_find(records, bench->name);
+        if (record != 0x0 && record->count != 0u) {
+            tapi_bench_stats_t base = summarize(record->samples, record->count);
+            bench->p_value = tapi_bench_mwu(record->samples, record->count, bench->samples,
+                                            bench->repetitions);
+            bench->change = base.median > 0.0 ? bench->stats.median / base.median - 1.0 : 0.0;
+            if (bench->p_value < l_config.alpha && bench->change > l_config.threshold)
+                bench->result = E_TAPI_TEST_RESULT_FAILED;
+        }
+
+        /* a sweep also fails if its complexity class changed. */
+        bool complexity_changed = is_sweep && record != 0x0 &&
+            record->complexity != E_TAPI_BENCH_O_NONE && record->complexity != bench->fit.complexity;
+        if (complexity_changed)
+            bench->result = E_TAPI_TEST_RESULT_FAILED;
+
+        /* as does scaling worse than tolerated. */
+        if (!efficient)
+            bench->result = E_TAPI_TEST_RESULT_FAILED;
+
+        /* and report. */
+        if (bench->result == E_TAPI_TEST_RESULT_PASSED)
+            passed++;
+        printf("[%zu/%zu] tapi: %s, %.2f ns/op (min %.2f, max %.2f, %zu x %zu)", passed,
+               l_benches->length, bench->name, bench->stats.median, bench->stats.min,
+               bench->stats.max, bench->repetitions, iterations);
+        if (is_cold)
+            printf(", cold");
+        else if (bench->cache == E_TAPI_BENCH_CACHE_BOTH)
+            printf(", %.2f ns/op cold (%.1fx)", bench->cold.median,
+                   bench->stats.median > 0.0 ? bench->cold.median / bench->stats.median : 0.0);
+        if (bench->mocks->length != 0u)
+            printf(", isolated; %.2f ns/op with real dependencies", bench->real.median);
+        if (record != 0x0)
+            printf(", %+.2f%% vs. baseline (p=%.4f)", bench->change * 100.0, bench->p_value);
+        if (complexity_changed)
+            printf(", complexity changed from %s", l_complexity_names[record->complexity]);
+        if (bench->env.flags & E_TAPI_BENCH_ENV_LOADED)
+            printf(", loaded");
+        printf(bench->result == E_TAPI_TEST_RESULT_PASSED ? ", passed.\n" : ", regressed.\n");
+        if (is_sweep) {
+            for (size_t j = 0u; j < bench->point_count; j++)
+                printf("\tn=%zu: %.2f ns/op\n", bench->points[j].size, bench->points[j].median);
+            printf("\tcomplexity: %s, coef %.4g ns, rms %.1f%%\n",
+                   l_complexity_names[bench->fit.complexity], bench->fit.coef,
+                   bench->fit.rms * 100.0);
+        }
+        for (size_t j = 0u; j < bench->scale_count; j++) {
+            const tapi_bench_scale_t* point = &bench->scaling[j];
+            printf("\tthreads=%zu: %.4g ops/s, %.2fx speedup, %.0f%% efficiency, p50 %llu ns, "
+                   "p99 %llu ns%s\n", point->threads, point->throughput, point->speedup,
+                   point->efficiency * 100.0, (unsigned long long) point->p50,
+                   (unsigned long long) point->p99,
+                   point->efficiency < bench->efficiency ? ", scaling below threshold" : "");
+        }
+        printf("\tlatency (ns): ");
+        tapi_hist_print(bench->hist, stdout);
+        printf("\n");
+        if (report != 0x0)
+            report_write(bench, iterations, report);
+    _endforeach;
+    printf("tapi; total benchmarks passed: [%zu/%zu].\n", passed, l_benches->length);
+    env_restore(&saved);
+    if (report_path != 0x0 && report != 0x0)
+        fclose(report);
+
+    /* save the new baseline if requested. */
+    if (mode == E_TAPI_BENCH_BASELINE_SAVE && baseline_write(path))
+        printf("tapi; saved benchmark baseline to '%s'.\n", path);
+    baseline_free(records);
+    return passed == l_benches->length ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/**
+ * @brief make a new benchmark given minimal information.
+ *
+ * @param name the name of the benchmark.
+ * @param function the benchmark body to be timed.
+ * @return an allocated benchmark structure.
+ */
+tapi_bench_t*
+tapi_bench_make(const char* name, tapi_bench_func_t function) {
+    /* allocate and make the structure. */
+    tapi_bench_t* bench = calloc(1u, sizeof *bench);
+    bench->name = frame_intern(name);
+    bench->function = function;
+    bench->mocks = dyna_create();
+    bench->repetitions = 16u;
+    bench->min_time = 1e7; /* 10ms per sample. */
+    return bench;
+}
+
+/**
+ * @brief add a mock to a benchmark; mocks are applied once before the isolated samples are
+ *  timed and restored after, the benchmark is also timed without them for comparison.
+ *
+ * @param bench the benchmark to be altered.
+ * @param tested the tested function to search through.
+ * @param target the target address to redirect to mock.
+ * @param mocked the mocked result to be redirected to.
+ */
+void
+tapi_bench_add_mock(tapi_bench_t* bench, void* tested, void* target, void* mocked) {
+    /* create the mock ptr and push it onto the dynamic array. */
+    tapi_mock_t* mock = tapi_mock_create(tested, target, mocked);
+    if (mock != 0x0)
+        dyna_push(bench->mocks, mock);
+}
+
+/**
+ * @brief sweep the input size of a benchmark geometrically from low to high; each size is
+ *  timed and the results are fitted to O(1), O(log n), O(n), O(n log n) and O(n^2). when
+ *  compared against a baseline, a change of the fitted class fails the benchmark.
+ *
+ * @param bench the benchmark to be altered.
+ * @param low the smallest input size (at least 1).
+ * @param high the largest input size.
+ * @param factor the growth factor between sizes (e.g. 2.0).
+ */
+void
+tapi_bench_sweep(tapi_bench_t* bench, size_t low, size_t high, double factor) {
+    bench->sweep.low = low ? low : 1u;
+    bench->sweep.high = high;
+    bench->sweep.factor = factor;
+}
+
+/**
+ * @brief time a benchmark with cold caches, warm caches, or both side by side. before every
+ *  cold operation the input is flushed out of every cache level (clflush on x86, dc civac on
+ *  aarch64); without an input, or where user space cannot flush (arm32), a buffer twice the
+ *  size of the last level cache is streamed instead. cold samples run `iterations` operations
+ *  if set, and 8 o.w., since every eviction is costly.
+ *
+ * @param bench the benchmark to be altered.
+ * @param cache the cache state to time in.
+ * @param input the data the body reads, to be flushed (may be 0x0).
+ * @param size the size of the input in bytes.
+ */
+void
+tapi_bench_cache(tapi_bench_t* bench, e_tapi_bench_cache_t cache, const void* input,
+                 size_t size) {
+    bench->cache = cache;
+    bench->input = input;
+    bench->input_size = size;
+}
+
+/**
+ * @brief scale a benchmark over 1, 2, 4, ... up to `threads` threads. at every count the
+ *  threads wait on a spin barrier and are released at once, then run the body for `min_time`
+ *  nanoseconds, counting operations and latencies in their own cache lines. the benchmark
+ *  fails if the scaling efficiency (speedup / threads) at any count drops below `efficiency`.
+ *  the body is told its thread through tapi_bench_state_t::thread.
+ *
+ * @param bench the benchmark to be altered.
+ * @param threads the largest number of threads.
+ * @param efficiency the lowest tolerated efficiency in [0, 1], 0 to never fail.
+ */
+void
+tapi_bench_threads(tapi_bench_t* bench, size_t threads, double efficiency) {
+    bench->threads = threads;
+    bench->efficiency = efficiency;
+}
+
+/**
+ * @brief evaluate the growth function of a complexity class.
+ *
+ * @param complexity the complexity class.
+ * @param n the input size.
+ * @return f(n).
+ */
+internal double
+complexity_f(e_tapi_bench_complexity_t complexity, size_t n) {
+    double x = (double) n;
+    switch (complexity) {
+        case E_TAPI_BENCH_O_1: return 1.0;
+        case E_TAPI_BENCH_O_LOGN: return log2(x);
+        case E_TAPI_BENCH_O_N: return x;
+        case E_TAPI_BENCH_O_NLOGN: return x * log2(x);
+        case E_TAPI_BENCH_O_N2: return x * x;
+        default: return 0.0;
+    }
+}
+
+/**
+ * @brief fit measured times to every complexity class by least squares on the relative
+ *  error, t(n) = coef * f(n), and pick the class with the smallest error.
+ *
+ * @param sizes the input sizes.
+ * @param times the time per operation at each size.
+ * @param count the number of sizes.
+ * @return the best fit.
+ */
+tapi_bench_fit_t
+tapi_bench_fit(const size_t* sizes, const double* times, size_t count) {
+    tapi_bench_fit_t best = { .complexity = E_TAPI_BENCH_O_NONE, .coef = 0.0, .rms = INFINITY };
+    if (count == 0u)
+        return best;
+
+    /* every class; we minimize the relative error so each size of a geometric sweep weighs
+     *  the same, coef = sum(f / t) / sum((f / t)^2). */
+    for (int c = E_TAPI_BENCH_O_1; c <= E_TAPI_BENCH_O_N2; c++) {
+        double r = 0.0, rr = 0.0;
+        for (size_t i = 0u; i < count; i++) {
+            double q = complexity_f((e_tapi_bench_complexity_t) c, sizes[i]) /
+                (times[i] > 0.0 ? times[i] : 1.0);
+            r += q;
+            rr += q * q;
+        }
+        if (rr == 0.0)
+            continue;
+        double coef = r / rr, err = 0.0;
+        for (size_t i = 0u; i < count; i++) {
+            double q = complexity_f((e_tapi_bench_complexity_t) c, sizes[i]) /
+                (times[i] > 0.0 ? times[i] : 1.0);
+            err += (1.0 - coef * q) * (1.0 - coef * q);
+        }
+        double rms = sqrt(err / (double) count);
+        if (rms < best.rms)
+            best = (tapi_bench_fit_t) { .complexity = c, .coef = coef, .rms = rms };
+    }
+    return best;
+}
+
+/**
+ * @brief get a readable name of a complexity class, e.g. "O(n log n)".
+ *
+ * @param complexity the complexity class.
+ * @return the name of the class.
+ */
+const char*
+tapi_bench_complexity_name(e_tapi_bench_complexity_t complexity) {
+    return complexity <= E_TAPI_BENCH_O_N2 ? l_complexity_names[complexity] : "none";
+}
+
+/**
+ * @brief set the baseline file and what to do with it; the environment variables
+ *  `TAPI_BENCH_BASELINE` (path) and `TAPI_BENCH_SAVE` (=1 to save) override these.
+ *
+ * @param path the path of the baseline file.
+ * @param mode whether to save to, or compare against the baseline.
+ */
+void
+tapi_bench_baseline(const char* path, e_tapi_bench_baseline_t mode) {
+    free(l_config.path);
+    l_config.path = path ? strdup(path) : 0x0;
+    l_config.mode = mode;
+}
+
+/**
+ * @brief set the regression gate; a benchmark fails when its median slowed down by more than
+ *  `threshold` (relative, e.g. 0.05 for 5%) and the slowdown is significant at level `alpha`.
+ *
+ * @param threshold the relative median slowdown that is tolerated.
+ * @param alpha the significance level of the mann-whitney u test.
+ */
+void
+tapi_bench_threshold(double threshold, double alpha) {
+    l_config.threshold = threshold;
+    l_config.alpha = alpha;
+}
+
+/**
+ * @brief control sources of noise before benchmarks run; pin the thread to a cpu, and
+ *  optionally raise it to SCHED_FIFO and lock its memory. everything is undone when the run
+ *  ends. the environment variable `TAPI_BENCH_CPU` overrides the cpu.
+ *
+ * @param cpu the cpu to pin to, or -1 to not pin.
+ * @param flags the extra isolation to apply, see e_tapi_bench_isolate_t.
+ */
+void
+tapi_bench_isolate(int cpu, unsigned int flags) {
+    l_config.cpu = cpu;
+    l_config.isolate = flags;
+}
+
+/**
+ * @brief set a stream to export the results of every benchmark to as json lines (one object
+ *  per benchmark, including its latency histogram); 0x0 to disable. the environment variable
+ *  `TAPI_BENCH_REPORT` overrides this with a file the results are appended to.
+ *
+ * @param stream the stream to export results to.
+ */
+void
+tapi_bench_report(tapi_stream_t stream) {
+    l_config.report = stream;
+}
+
+/** a sample tagged with the group it came from, for ranking. */
+typedef struct {
+    double value;
+    int is_cur;
+} ranked_t;
+
+/** comparison function for sorting ranked samples by value. */
+internal int
+cmp_ranked(const void* a, const void* b) {
+    return cmp_double(&((const ranked_t*) a)->value, &((const ranked_t*) b)->value);
+}
+
+/**
+ * @brief one-sided mann-whitney u test that the current samples are larger (slower) than the
+ *  baseline samples; uses the normal approximation with tie and continuity correction.
+ *
+ * @param base the baseline samples.
+ * @param n_base the number of baseline samples.
+ * @param cur the current samples.
+ * @param n_cur the number of current samples.
+ * @return the p-value of the test.
+ */
+double
+tapi_bench_mwu(const double* base, size_t n_base, const double* cur, size_t n_cur) {
+    size_t n = n_base + n_cur;
+    if (n_base == 0u || n_cur == 0u)
+        return 1.0;
+
+    /* pool and sort both groups. */
+    ranked_t* pool = calloc(n, sizeof *pool);
+    for (size_t i = 0u; i < n_base; i++)
+        pool[i] = (ranked_t) { .value = base[i], .is_cur = 0 };
+    for (size_t i = 0u; i < n_cur; i++)
+        pool[n_base + i] = (ranked_t) { .value = cur[i], .is_cur = 1 };
+    qsort(pool, n, sizeof *pool, cmp_ranked);
+
+    /* sum the ranks of the current group, averaging ties, and accumulate the tie term. */
+    double rank_sum = 0.0, ties = 0.0;
+    for (size_t i = 0u; i < n;) {
+        size_t j = i;
+        while (j < n && pool[j].value == pool[i].value)
+            j++;
+        double t = (double)(j - i), rank = (double)(i + j + 1u) / 2.0;
+        for (size_t k = i; k < j; k++)
+            if (pool[k].is_cur)
+                rank_sum += rank;
+        ties += t * t * t - t;
+        i = j;
+    }
+    free(pool);
+
+    /* u statistic of the current group, and its normal approximation. */
+    double n1 = (double) n_base, n2 = (double) n_cur, nn = (double) n;
+    double u = rank_sum - n2 * (n2 + 1.0) / 2.0;
+    double mean = n1 * n2 / 2.0;
+    double var = n1 * n2 / 12.0 * ((nn + 1.0) - ties / (nn * (nn - 1.0)));
+    if (var <= 0.0)
+        return 1.0;
+    double z = (u - mean - 0.5) / sqrt(var);
+    return 0.5 * erfc(z / sqrt(2.0));
+}
+
+/**
+ * @brief free and destroy a list of benchmarks after they have been ran, and removed from the
+ *  suite (see tapi_bench_remove()).
+ *
+ * @param benches the benchmarks to be freed.
+ * @param length the number of benchmarks to be freed.
+ */
+void
+tapi_bench_destroy(tapi_bench_t** benches, size_t length) {
+    /* free each benchmark but not the list itself, that isn't ours. */
+    for (size_t i = 0; i < length; i++) {
+        dyna_free(benches[i]->mocks);
+        free(benches[i]->samples);
+        free(benches[i]->points);
+        free(benches[i]->scaling);
+        tapi_hist_destroy(benches[i]->hist);
+        free(benches[i]);
+    }
+}
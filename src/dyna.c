@@ -11,10 +11,10 @@
 /*! @uses fprintf. */
 #include <stdio.h>
 
-/*! @uses calloc, realloc, free, exit. */
+/*! @uses calloc, malloc, realloc, free, exit, qsort. */
 #include <stdlib.h>
 
-/*! @uses memcpy. */
+/*! @uses memcpy, memmove. */
 #include <string.h>
 /** \endcond */
 
@@ -94,10 +94,11 @@ dyna_pop(dyna_t* array, size_t index) {
     /* capture the element */
     void* item = array->data[index];
 
-    /* free, shift down and then decrement length. */
-    for (size_t i = index + 1u; i < array->length; i++)
-        array->data[i - 1u] = array->data[i];
+    /* shift down in one move and then decrement length. */
     array->length--;
+    /* NOLINTNEXTLINE */
+    memmove(array->data + index, array->data + index + 1u,
+            sizeof(void*) * (array->length - index));
     return item;
 }
 
@@ -158,6 +159,67 @@ dyna_make(void** data, size_t length) {
 
     /* copy and return. */
     /* NOLINTNEXTLINE */
-    memcpy(array->data, data, length);
+    memcpy(array->data, data, sizeof(void*) * length);
     return array;
-}
\ No newline at end of file
+}
+
+/**
+ * @brief grow the storage of a typed vector (see dyna_define()), moving its elements off of its
+ *  inline storage onto the heap the first time.
+ *
+ * @param data pointer to the storage of the vector.
+ * @param capacity pointer to the capacity of the vector.
+ * @param local the inline storage of the vector.
+ * @param length the number of elements in the vector.
+ * @param size the size of an element.
+ * @param wanted the capacity needed.
+ * @return false if the storage could not be grown, the vector is then left unchanged.
+ */
+bool
+dyna_grow(void** data, size_t* capacity, void* local, size_t length, size_t size, size_t wanted) {
+    /* at least double, so pushing stays amortized O(1). */
+    size_t _capacity = *capacity * 2u;
+    if (_capacity < wanted) _capacity = wanted;
+
+    /* the inline storage can't be realloc'd, it is copied out instead. */
+    void* _data;
+    if (*data == local) {
+        _data = malloc(size * _capacity);
+        /* NOLINTNEXTLINE */
+        if (_data != 0x0) memcpy(_data, local, size * length);
+    }
+    else _data = realloc(*data, size * _capacity);
+    if (_data == 0x0) {
+        /* NOLINTNEXTLINE */
+        fprintf(stderr, "tapi, dyna_grow; allocation failed; could not grow to %zu elements.\n",
+                _capacity);
+        return false; /* do NOT exit on failure. */
+    }
+    *data = _data;
+    *capacity = _capacity;
+    return true;
+}
+
+/**
+ * @brief sort the elements of a typed vector (see dyna_define()).
+ *
+ * @param data the storage of the vector.
+ * @param length the number of elements in the vector.
+ * @param size the size of an element.
+ * @param compare the comparison function, as for qsort.
+ */
+void
+dyna_sort(void* data, size_t length, size_t size, int (*compare)(const void*, const void*)) {
+    if (length > 1u)
+        qsort(data, length, size, compare);
+}
+
+/**
+ * @brief free the heap storage of a typed vector (see dyna_define()).
+ *
+ * @param data the storage of the vector.
+ */
+void
+dyna_release(void* data) {
+    free(data);
+}
@@ -3,13 +3,46 @@
  * @author Sean Hobeck
  * @date 2026-03-09
  */
+/*! @uses tapi_mock_restore_applied. */
+#include <tapi/mock.h>
+
+/*! @uses frame_release. */
+#include "frame.h"
+
+/*! @uses det_release. */
+#include "det.h"
+
+/*! @uses sites_release. */
+#include "sites.h"
+
+/*! @uses tramp_release. */
+#include "tramp.h"
+
+/*! @uses dispatch_release. */
+#include "dispatch.h"
+
+/*! @uses leak_setup. */
+#include "leak.h"
+
 /** @brief library entry point. */
 __attribute__((constructor))
 void lt_entry() {
-
+    leak_setup();
 }
 
-/** @brief library exit point. */
-__attribute__((destructor))
-void lt_exit() {}
-/** \endcond */
\ No newline at end of file
+/**
+ * @brief library exit point; the framework's own bookkeeping is released in one shot, the arena
+ *  last of all. the priority only orders it among the destructors of this library, code in other
+ *  objects (and their destructors, or atexit handlers) can still call a mocked function after it;
+ *  so every mock still applied is restored first, and nothing patched jumps into what is freed.
+ */
+__attribute__((destructor(101)))
+void lt_exit() {
+    tapi_mock_restore_applied();
+    dispatch_release();
+    sites_release();
+    tramp_release();
+    det_release();
+    frame_release();
+}
+/** \endcond */
@@ -0,0 +1,254 @@
+/**
+ * \cond
+ * @author Sean Hobeck
+ * @date 2026-10-19
+ */
+#include <tapi/hist.h>
+
+/*! @uses calloc, free. */
+#include <stdlib.h>
+
+/*! @uses memset. */
+#include <string.h>
+
+/*! @uses true. */
+#include <stdbool.h>
+
+/*! @uses clock_gettime, CLOCK_MONOTONIC. */
+#include <time.h>
+
+/*! @uses internal. */
+#include "intt.h"
+/** \endcond */
+
+/* number of linear sub-buckets per power of two. */
+#define HALF (1u << (TAPI_HIST_SUB_BITS - 1u))
+
+/**
+ * @brief find the bucket a value is counted in.
+ *
+ * @param value the value to be bucketed.
+ * @return the index of the bucket.
+ */
+internal size_t
+bucket_index(uint64_t value) {
+    /* small values are counted exactly. */
+    if (value < (1u << TAPI_HIST_SUB_BITS))
+        return (size_t) value;
+
+    /* o.w. keep the top TAPI_HIST_SUB_BITS bits of the value. */
+    uint32_t msb = 63u - (uint32_t) __builtin_clzll(value);
+    uint32_t shift = msb - (TAPI_HIST_SUB_BITS - 1u);
+    return (size_t) HALF * shift + (size_t)(value >> shift);
+}
+
+/**
+ * @brief find the range of values counted in a bucket.
+ *
+ * @param index the index of the bucket.
+ * @param low the lowest value counted in the bucket.
+ * @param high the highest value counted in the bucket.
+ */
+internal void
+bucket_range(size_t index, uint64_t* low, uint64_t* high) {
+    if (index < (1u << TAPI_HIST_SUB_BITS)) {
+        *low = *high = (uint64_t) index;
+        return;
+    }
+    uint32_t shift = (uint32_t)(index / HALF) - 1u;
+    uint64_t mantissa = (uint64_t)(index - (size_t) HALF * shift);
+    *low = mantissa << shift;
+    *high = *low + ((1ull << shift) - 1u);
+}
+
+/**
+ * @brief make an empty histogram.
+ *
+ * @return a pointer to an allocated histogram.
+ */
+tapi_hist_t*
+tapi_hist_make(void) {
+    /* allocate and reset, min has to start at the largest value. */
+    tapi_hist_t* hist = calloc(1u, sizeof *hist);
+    hist->min = UINT64_MAX;
+    return hist;
+}
+
+/**
+ * @brief clear every recorded value from a histogram.
+ *
+ * @param hist the histogram to be reset.
+ */
+void
+tapi_hist_reset(tapi_hist_t* hist) {
+    /* NOLINTNEXTLINE */
+    memset(hist, 0, sizeof *hist);
+    hist->min = UINT64_MAX;
+}
+
+/**
+ * @brief record a value into a histogram.
+ *
+ * @param hist the histogram to record into.
+ * @param value the value to be recorded.
+ */
+void
+tapi_hist_record(tapi_hist_t* hist, uint64_t value) {
+    hist->buckets[bucket_index(value)]++;
+    hist->count++;
+    hist->sum += value;
+    if (value < hist->min) hist->min = value;
+    if (value > hist->max) hist->max = value;
+}
+
+/**
+ * @brief record a value into a histogram shared between threads, using atomic increments.
+ *
+ * @param hist the histogram to record into.
+ * @param value the value to be recorded.
+ */
+void
+tapi_hist_record_atomic(tapi_hist_t* hist, uint64_t value) {
+    __atomic_fetch_add(&hist->buckets[bucket_index(value)], 1u, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&hist->count, 1u, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&hist->sum, value, __ATOMIC_RELAXED);
+
+    /* min and max are compare-and-swap loops. */
+    uint64_t seen = __atomic_load_n(&hist->min, __ATOMIC_RELAXED);
+    while (value < seen && !__atomic_compare_exchange_n(&hist->min, &seen, value, true,
+                                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+    seen = __atomic_load_n(&hist->max, __ATOMIC_RELAXED);
+    while (value > seen && !__atomic_compare_exchange_n(&hist->max, &seen, value, true,
+                                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+}
+
+/**
+ * @brief add every value recorded in one histogram into another.
+ *
+ * @param dst the histogram to merge into.
+ * @param src the histogram to merge from.
+ */
+void
+tapi_hist_merge(tapi_hist_t* dst, const tapi_hist_t* src) {
+    for (size_t i = 0u; i < TAPI_HIST_BUCKETS; i++)
+        dst->buckets[i] += src->buckets[i];
+    dst->count += src->count;
+    dst->sum += src->sum;
+    if (src->min < dst->min) dst->min = src->min;
+    if (src->max > dst->max) dst->max = src->max;
+}
+
+/**
+ * @brief get the value at a percentile of the recorded values; the result is the highest
+ *  value equivalent to the bucket the percentile falls into, capped to the largest value.
+ *
+ * @param hist the histogram to be read.
+ * @param percentile the percentile in [0, 100], e.g. 99.9.
+ * @return the value at the percentile, or 0 if the histogram is empty.
+ */
+uint64_t
+tapi_hist_percentile(const tapi_hist_t* hist, double percentile) {
+    if (hist->count == 0u)
+        return 0u;
+    if (percentile <= 0.0)
+        return hist->min;
+
+    /* the rank of the value we are looking for (1-based, rounded up). */
+    double exact = percentile / 100.0 * (double) hist->count;
+    uint64_t rank = (uint64_t) exact;
+    if ((double) rank < exact) rank++;
+    if (rank == 0u) rank = 1u;
+    if (rank > hist->count) rank = hist->count;
+
+    /* walk the buckets until we have seen rank values. */
+    uint64_t seen = 0u;
+    for (size_t i = 0u; i < TAPI_HIST_BUCKETS; i++) {
+        seen += hist->buckets[i];
+        if (seen >= rank) {
+            uint64_t low, high;
+            bucket_range(i, &low, &high);
+            return high < hist->max ? high : hist->max;
+        }
+    }
+    return hist->max;
+}
+
+/**
+ * @brief get the mean of the recorded values.
+ *
+ * @param hist the histogram to be read.
+ * @return the mean, or 0 if the histogram is empty.
+ */
+double
+tapi_hist_mean(const tapi_hist_t* hist) {
+    return hist->count ? (double) hist->sum / (double) hist->count : 0.0;
+}
+
+/**
+ * @brief print a human-readable percentile summary of a histogram on a single line.
+ *
+ * @param hist the histogram to be printed.
+ * @param stream the stream to print to.
+ */
+void
+tapi_hist_print(const tapi_hist_t* hist, tapi_stream_t stream) {
+    fprintf(stream, "n=%llu min=%llu p50=%llu p90=%llu p99=%llu p999=%llu max=%llu",
+            (unsigned long long) hist->count,
+            (unsigned long long)(hist->count ? hist->min : 0u),
+            (unsigned long long) tapi_hist_percentile(hist, 50.0),
+            (unsigned long long) tapi_hist_percentile(hist, 90.0),
+            (unsigned long long) tapi_hist_percentile(hist, 99.0),
+            (unsigned long long) tapi_hist_percentile(hist, 99.9),
+            (unsigned long long) hist->max);
+}
+
+/**
+ * @brief export a histogram as a json object, with its percentiles and every non-empty
+ *  bucket as [lowest value, highest value, count].
+ *
+ * @param hist the histogram to be exported.
+ * @param stream the stream to export to.
+ */
+void
+tapi_hist_export(const tapi_hist_t* hist, tapi_stream_t stream) {
+    fprintf(stream, "{\"count\":%llu,\"min\":%llu,\"max\":%llu,\"mean\":%.3f,"
+                    "\"p50\":%llu,\"p90\":%llu,\"p99\":%llu,\"p999\":%llu,\"buckets\":[",
+            (unsigned long long) hist->count,
+            (unsigned long long)(hist->count ? hist->min : 0u),
+            (unsigned long long) hist->max, tapi_hist_mean(hist),
+            (unsigned long long) tapi_hist_percentile(hist, 50.0),
+            (unsigned long long) tapi_hist_percentile(hist, 90.0),
+            (unsigned long long) tapi_hist_percentile(hist, 99.0),
+            (unsigned long long) tapi_hist_percentile(hist, 99.9));
+
+    /* only the non-empty buckets. */
+    const char* separator = "";
+    for (size_t i = 0u; i < TAPI_HIST_BUCKETS; i++) {
+        if (hist->buckets[i] == 0u)
+            continue;
+        uint64_t low, high;
+        bucket_range(i, &low, &high);
+        fprintf(stream, "%s[%llu,%llu,%llu]", separator, (unsigned long long) low,
+                (unsigned long long) high, (unsigned long long) hist->buckets[i]);
+        separator = ",";
+    }
+    fprintf(stream, "]}");
+}
+
+/** @return the current monotonic time in nanoseconds, for use with tapi_hist_record(). */
+uint64_t
+tapi_hist_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000u + (uint64_t) ts.tv_nsec;
+}
+
+/**
+ * @brief free a histogram.
+ *
+ * @param hist the histogram to be freed.
+ */
+void
+tapi_hist_destroy(tapi_hist_t* hist) {
+    free(hist);
+}
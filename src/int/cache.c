@@ -0,0 +1,118 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-10-19
+ */
+/* we have to define this to use _SC_LEVEL1_DCACHE_LINESIZE and _SC_LEVEL3_CACHE_SIZE. */
+#define _GNU_SOURCE
+
+#include "cache.h"
+
+/*! @uses fopen, fscanf, snprintf. */
+#include <stdio.h>
+
+/*! @uses uintptr_t, uint8_t. */
+#include <stdint.h>
+
+/*! @uses sysconf. */
+#include <unistd.h>
+
+/*! @uses mmap, MAP_FAILED. */
+#include <sys/mman.h>
+
+/* the eviction buffer, mapped on first use. */
+static volatile uint8_t* l_evict;
+static size_t l_evict_size;
+
+/** @return the size of a data cache line in bytes. */
+size_t
+cache_line_size(void) {
+#ifdef _SC_LEVEL1_DCACHE_LINESIZE
+    long value = sysconf(_SC_LEVEL1_DCACHE_LINESIZE);
+    if (value > 0)
+        return (size_t) value;
+#endif
+    return 64u;
+}
+
+/** @return the size of the last level cache in bytes (or a conservative guess). */
+size_t
+cache_llc_size(void) {
+#ifdef _SC_LEVEL3_CACHE_SIZE
+    long value = sysconf(_SC_LEVEL3_CACHE_SIZE);
+    if (value > 0)
+        return (size_t) value;
+#endif
+    /* o.w. the largest cache sysfs reports for cpu0 (sizes are like "32768K"). */
+    size_t largest = 0u;
+    for (int i = 0; i < 8; i++) {
+        char path[96u], unit = 0x0;
+        size_t size = 0u;
+        /* NOLINTNEXTLINE */
+        snprintf(path, sizeof path, "/sys/devices/system/cpu/cpu0/cache/index%d/size", i);
+        FILE* file = fopen(path, "r");
+        if (file == 0x0)
+            break;
+        /* NOLINTNEXTLINE */
+        if (fscanf(file, "%zu%c", &size, &unit) >= 1) {
+            size *= unit == 'K' ? 1024u : unit == 'M' ? 1024u * 1024u : 1u;
+            if (size > largest) largest = size;
+        }
+        fclose(file);
+    }
+    return largest ? largest : 32u * 1024u * 1024u;
+}
+
+/**
+ * @brief flush a memory range out of every cache level (clflush on x86, dc civac on aarch64).
+ *
+ * @param address the start of the range to be flushed.
+ * @param size the size of the range in bytes.
+ * @return ref. to intt.h for enum, fails where user space cannot flush (arm32).
+ */
+e_intt_result_t
+cache_flush(const void* address, size_t size) {
+#if defined(__x86_64__) || defined(__i386__) || defined(__aarch64__)
+    size_t line = cache_line_size();
+    uintptr_t start = (uintptr_t) address & ~(uintptr_t)(line - 1u);
+    uintptr_t end = (uintptr_t) address + size;
+    for (uintptr_t p = start; p < end; p += line) {
+#if defined(__aarch64__)
+        __asm__ volatile("dc civac, %0" : : "r"(p) : "memory");
+#else
+        __asm__ volatile("clflush (%0)" : : "r"(p) : "memory");
+#endif
+    }
+    /* wait for the flushes to complete before we time anything. */
+#if defined(__aarch64__)
+    __asm__ volatile("dsb ish" : : : "memory");
+#else
+    __asm__ volatile("mfence" : : : "memory");
+#endif
+    return E_INTT_RESULT_SUCCESS;
+#else
+    (void) address;
+    (void) size;
+    return E_INTT_RESULT_FAILURE;
+#endif
+}
+
+/** @brief evict the caches by streaming through a buffer twice the size of the llc. */
+void
+cache_evict(void) {
+    if (l_evict == 0x0) {
+        size_t size = cache_llc_size() * 2u;
+        void* buffer = mmap(0x0, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (buffer == MAP_FAILED) {
+            /* NOLINTNEXTLINE */
+            fprintf(stderr, "tapi, cache_evict; mmap failed; could not map eviction buffer.\n");
+            return;
+        }
+        l_evict = buffer;
+        l_evict_size = size;
+    }
+
+    /* write one byte per line, so every line is owned by us and the old ones are gone. */
+    size_t line = cache_line_size();
+    for (size_t i = 0u; i < l_evict_size; i += line)
+        l_evict[i]++;
+}
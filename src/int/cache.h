@@ -0,0 +1,35 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-10-19
+ */
+#ifndef CACHE_H
+#define CACHE_H
+
+/*! @uses size_t. */
+#include <stddef.h>
+
+/*! @uses e_intt_result_t. */
+#include "intt.h"
+
+/** @return the size of a data cache line in bytes. */
+size_t
+cache_line_size(void);
+
+/** @return the size of the last level cache in bytes (or a conservative guess). */
+size_t
+cache_llc_size(void);
+
+/**
+ * @brief flush a memory range out of every cache level (clflush on x86, dc civac on aarch64).
+ *
+ * @param address the start of the range to be flushed.
+ * @param size the size of the range in bytes.
+ * @return ref. to intt.h for enum, fails where user space cannot flush (arm32).
+ */
+e_intt_result_t
+cache_flush(const void* address, size_t size);
+
+/** @brief evict the caches by streaming through a buffer twice the size of the llc. */
+void
+cache_evict(void);
+#endif /* CACHE_H */
@@ -7,9 +7,18 @@
 /*! @uses bool, true, false. */
 #include <stdbool.h>
 
-/*! @uses memcpy. */
+/*! @uses memcpy, memset. */
 #include <string.h>
 
+/*! @uses pthread_mutex_t, pthread_mutex_lock, pthread_mutex_unlock. */
+#include <pthread.h>
+
+/*! @uses PROT_READ, PROT_WRITE. */
+#include <sys/mman.h>
+
+/*! @uses dyna_define. */
+#include <tapi/dyna.h>
+
 /*! @uses cs_insn, csh, cs_open. */
 #include <capstone/capstone.h>
 
@@ -19,6 +28,54 @@
 /*! @uses arch_t, get_arch. */
 #include "arch.h"
 
+/*! @uses frame_alloc. */
+#include "frame.h"
+
+/*! @uses leak_pause, leak_resume. */
+#include "leak.h"
+
+/*! @uses guard_maps_t, guard_map_t, guard_maps_read. */
+#include "guard.h"
+
+/* number of slots the cache of scans starts with (a power of two); it doubles at 3/4 load. */
+#define CACHE_SLOTS 256u
+
+/* a typed vector of call sites, for collecting them while decoding. */
+dyna_define(det_calls, det_call_t, 16u)
+
+/* a typed vector of branch destinations, for collecting them while decoding. */
+dyna_define(det_branches, uintptr_t, 16u)
+
+/** a blr through a register loaded by a chain of instructions, and where the chain starts. */
+typedef struct {
+    size_t call; /* the index of the call. */
+    uintptr_t from; /* the adrp the chain starts with. */
+} det_chain_t;
+
+/* a typed vector of chains, for collecting them while decoding. */
+dyna_define(det_chains, det_chain_t, 8u)
+
+/* the decode context of a thread; handles are opened on first use and kept, [1] is thumb. */
+static _Thread_local struct {
+    csh handles[2u];
+    cs_insn* insns[2u];
+    bool open[2u];
+    det_calls_t calls;
+    det_branches_t branches;
+    det_chains_t chains;
+    det_scan_t scan;
+    uint64_t values[32u]; /* the values known to be in the aarch64 registers, for blr. */
+    uint64_t origins[32u]; /* where the chain that computed each of them starts. */
+    uint32_t known, pages; /* which are known, and which are addresses within the image. */
+    guard_maps_t maps; /* the mappings, for telling read-only pointer slots apart. */
+} l_context;
+
+/* the cached scans, shared between threads; the scans themselves live in the internal arena. */
+static pthread_mutex_t l_lock = PTHREAD_MUTEX_INITIALIZER;
+static det_scan_t** l_cache;
+static size_t l_cached, l_slots;
+static bool l_uncached; /* warned that scans are no longer cached? */
+
 /**
  * @brief is the instruction specified used to end a function?
  *
@@ -58,39 +115,463 @@ is_tail_call(cs_insn* insn, arch_t architecture) {
 }
 
 /**
- * @brief find the size of the function in memory.
+ * @brief is an instruction an indirect call through memory that can be patched into a direct
+ *  call (ff 15 disp32, possibly after a notrack prefix)?
+ *
+ * @param insn the instruction.
+ * @return if it is.
+ */
+internal bool
+is_indirect_bx86(const cs_insn* insn) {
+    if (insn->size != 6u && insn->size != 7u)
+        return false;
+    if (insn->size == 7u && insn->bytes[0] != 0x3e)
+        return false;
+    return insn->bytes[insn->size - 6u] == 0xff && insn->bytes[insn->size - 5u] == 0x15;
+}
+
+/**
+ * @brief is a pointer slot read-only (a got slot under relro, or a constant), so a call through
+ *  it always goes where it points now? the mappings are read once per thread, and again when
+ *  the slot isn't in any of them.
+ *
+ * @param slot the address of the slot.
+ * @return if it is mapped, readable and not writable.
+ */
+internal bool
+is_fixed_slot(uintptr_t slot) {
+    for (size_t pass = 0u; pass < 2u; pass++) {
+        _vforeach(&l_context.maps, guard_map_t, map)
+            if (slot >= map.start && slot + sizeof(uintptr_t) <= map.end)
+                return (map.flags & PROT_READ) != 0u && (map.flags & PROT_WRITE) == 0u;
+        _endforeach;
+        guard_maps_clear(&l_context.maps);
+        if (!e_intt_passed(guard_maps_read(&l_context.maps)))
+            return false;
+    }
+    return false;
+}
+
+/**
+ * @brief decode an x86 call instruction with an immediate/ relative address within the memory;
+ *  for x86|x86_64 only.
+ *
+ * @param call the call information structure to be filled in.
+ * @param insn the instruction to be searched.
+ * @param mode the mode of the architecture (x86 vs. x86_64).
+ * @return ref. to intt.h for enum.
+ */
+internal e_intt_result_t
+decode_call_bx86(det_call_t* call, const cs_insn* insn, const cs_mode mode) {
+    /* we look for the destination address. */
+    uint64_t address = 0u;
+    cs_x86* ops = &insn->detail->x86;
+    for (size_t i = 0; i < ops->op_count && address == 0u; i++) {
+        /* iterate until we find the immediate value used in the call. */
+        cs_x86_op* op = &ops->operands[i];
+        if (op->type == X86_OP_IMM) {
+            if (mode == CS_MODE_64) {
+                /* relative call. */
+                if (op->imm <= UINT32_MAX && ops->disp == 0u) {
+                    address = insn->address + insn->size + op->imm;
+                    call->is_rel = true;
+                    call->orig_off = (int32_t) op->imm;
+                }
+                else if (op->size == 8u) {
+                    /* absolute call, we can still modify these as if they were rel. */
+                    address = op->imm;
+                    call->is_rel = true;
+                }
+            }
+            else {
+                /* e8 call with 4-byte immediate. */
+                if (op->size == 4u) {
+                    address = op->imm;
+                    call->is_rel = true;
+                }
+                else { /* unrecognized. */ }
+            }
+
+        }
+        else if (op->type == X86_OP_MEM && is_indirect_bx86(insn)) {
+            /* an indirect call through a pointer; call [rip + x] (-fno-plt), or call [x] on i386.
+             *  it goes where the pointer points now, and is patched into a direct call; only a
+             *  read-only slot can't point elsewhere by the time the patch is applied. */
+            uintptr_t slot = 0u;
+            if (mode == CS_MODE_64 && op->mem.base == X86_REG_RIP)
+                slot = (uintptr_t)(insn->address + insn->size + op->mem.disp);
+            else if (mode != CS_MODE_64 && op->mem.base == X86_REG_INVALID)
+                slot = (uintptr_t)(uint32_t) op->mem.disp;
+            if (slot != 0u && op->mem.index == X86_REG_INVALID && is_fixed_slot(slot)) {
+                address = *(const uintptr_t*) slot;
+                call->is_rel = true;
+            }
+        }
+    }
+    if (address == 0u)
+        return E_INTT_RESULT_FAILURE;
+
+    /* fill in and copy. */
+    call->call = (void*) insn->address;
+    call->dest = (void*) address;
+    call->size = insn->size;
+    /* NOLINTNEXTLINE */
+    memcpy(call->bytes, insn->bytes, insn->size < 32u ? insn->size : 32u);
+    return E_INTT_RESULT_SUCCESS;
+}
+
+/**
+ * @brief decode an arm call instruction with an immediate/ relative address within memory;
+ *  for aarch32|thumb only.
+ *
+ * @param call the call information structure to be filled in.
+ * @param insn the instruction to be decoded.
+ * @return ref. to intt.h for enum.
+ */
+internal e_intt_result_t
+decode_call_barm32(det_call_t* call, const cs_insn* insn) {
+    if (insn->id != ARM_INS_BL && insn->id != ARM_INS_BLX)
+        return E_INTT_RESULT_FAILURE;
+    cs_arm* arm = &insn->detail->arm;
+
+    /* iterate through every operand. */
+    for (size_t i = 0x0; i < arm->op_count; i++) {
+        cs_arm_op* op = &arm->operands[i];
+        if (op->type == ARM_OP_IMM) {
+            call->is_rel = true;
+            if (call->is_thumb) {
+                /* thumb bl/blx; 2-instruction sequence
+                 *  bl encodes a 21-bit signed offset. */
+                call->orig_off = (int32_t)(op->imm - (insn->address + 4u)) >> 1u;
+            } else {
+                /* arm bl; encodes 24-bit signed offset. */
+                call->orig_off = (int32_t)(op->imm - (insn->address + 8u)) >> 2u;
+            }
+            call->call = (void*)insn->address;
+            call->dest = (void*)(uintptr_t)op->imm;
+            call->size = insn->size;
+
+            /* copy bytes and return. */
+            /* NOLINTNEXTLINE */
+            memcpy(call->bytes, (void*)insn->address, insn->size < 32u ? insn->size : 32u);
+            return E_INTT_RESULT_SUCCESS;
+        }
+    }
+    return E_INTT_RESULT_FAILURE;
+}
+
+/**
+ * @brief follow the values of the aarch64 registers through an instruction, as far as a blr needs
+ *  them; an adrp of a page, an add of an offset to it, and a load of a pointer from it (the
+ *  read-only got slot of a -fno-plt call). any other instruction forgets the registers it could
+ *  write.
+ *
+ * @param insn the instruction.
+ */
+internal void
+track_barm64(const cs_insn* insn) {
+    uint32_t word;
+    /* NOLINTNEXTLINE */
+    memcpy(&word, insn->bytes, sizeof word);
+    uint32_t d = word & 31u, n = (word >> 5u) & 31u;
+    bool is_page = (l_context.pages >> n) & 1u;
+    uint64_t value = 0u, origin = l_context.origins[n];
+    uint32_t known = 0u, page = 0u;
+    if ((word & 0x9f000000) == 0x90000000) {
+        /* adrp xd, page. */
+        uint64_t imm = ((word >> 3u) & 0x1ffffcu) | ((word >> 29u) & 3u);
+        int64_t offset = (int64_t)((imm ^ 0x100000u) - 0x100000u) * 4096;
+        value = (insn->address & ~(uint64_t) 0xfffu) + (uint64_t) offset;
+        origin = insn->address;
+        known = page = 1u;
+    }
+    else if ((word & 0xff800000) == 0x91000000 && is_page) {
+        /* add xd, xn, #imm{, lsl 12}, within the image. */
+        uint64_t imm = (word >> 10u) & 0xfffu;
+        value = l_context.values[n] + (imm << ((word >> 22u) & 1u ? 12u : 0u));
+        known = page = 1u;
+    }
+    else if ((word & 0xffc00000) == 0xf9400000 && is_page &&
+             is_fixed_slot((uintptr_t)(l_context.values[n] + ((word >> 10u) & 0xfffu) * 8u))) {
+        /* ldr xt, [xn, #imm], from a read-only slot in the image (a got slot under relro); what
+         *  it loads isn't followed. */
+        value = *(const uint64_t*)(uintptr_t)(l_context.values[n] + ((word >> 10u) & 0xfffu) * 8u);
+        known = 1u;
+    }
+    else if (insn->id == AARCH64_INS_BL || insn->id == AARCH64_INS_BLR) {
+        /* the callee may write any register but x19-x28. */
+        l_context.known &= 0x1ff80000u;
+        l_context.pages &= 0x1ff80000u;
+        return;
+    }
+    else if ((word & 0x0a000000) == 0x08000000) {
+        /* a load/ store may write back to its base, and a pair also writes rt2. */
+        uint32_t written = 1u << n;
+        if ((word & 0x3a000000) == 0x28000000)
+            written |= 1u << ((word >> 10u) & 31u);
+        if ((word & 0x3f000000) == 0x08000000) {
+            /* an exclusive or a compare-and-swap also writes rs (the status, or the old value),
+             *  and rs + 1 or rt2 for a pair. */
+            uint32_t rs = (word >> 16u) & 31u;
+            written |= 1u << rs | 1u << ((rs + 1u) & 31u) | 1u << ((word >> 10u) & 31u);
+        }
+        l_context.known &= ~written;
+        l_context.pages &= ~written;
+    }
+
+    /* rd (or rt) is bits 0-4 of nearly everything that writes a register; 31 is sp or xzr. */
+    if (d == 31u)
+        return;
+    l_context.values[d] = value;
+    l_context.origins[d] = origin;
+    l_context.known = (l_context.known & ~(1u << d)) | (known << d);
+    l_context.pages = (l_context.pages & ~(1u << d)) | (page << d);
+}
+
+/**
+ * @brief decode an aarch64 call instruction with an immediate/ relative address within memory,
+ *  or a blr through a register with a known value (a pointer loaded from a got slot); for aarch64
+ *  only.
+ *
+ * @param call the call info structure to be filled in.
+ * @param insn the instruction to be decoded.
+ * @return ref. to intt.h for enum, fails for a blr through a register we can't follow.
+ */
+internal e_intt_result_t
+decode_call_baarch64(det_call_t* call, const cs_insn* insn) {
+    /* a blr goes where its register points now, and is patched into a bl. */
+    if (insn->id == AARCH64_INS_BLR) {
+        uint32_t word;
+        /* NOLINTNEXTLINE */
+        memcpy(&word, insn->bytes, sizeof word);
+        uint32_t n = (word >> 5u) & 31u;
+        if ((word & 0xfffffc1f) != 0xd63f0000 || !((l_context.known >> n) & 1u) ||
+            l_context.values[n] == 0u)
+            return E_INTT_RESULT_FAILURE;
+        call->is_rel = true;
+        call->call = (void*) insn->address;
+        call->dest = (void*)(uintptr_t) l_context.values[n];
+        call->size = insn->size;
+        /* NOLINTNEXTLINE */
+        memcpy(call->bytes, insn->bytes, insn->size);
+
+        /* the call is pushed next; it is dropped if a branch lands within its chain. */
+        det_chain_t chain = { l_context.calls.length, (uintptr_t) l_context.origins[n] };
+        det_chains_push(&l_context.chains, chain);
+        return E_INTT_RESULT_SUCCESS;
+    }
+
+    /* is this a branch with link insn? */
+    if (insn->id != AARCH64_INS_BL)
+        return E_INTT_RESULT_FAILURE;
+    cs_aarch64* aarch64 = &insn->detail->aarch64;
+
+    /* iterate... */
+    for (size_t i = 0; i < aarch64->op_count; i++) {
+        cs_aarch64_op* op = &aarch64->operands[i];
+
+        /* are we dealing with the immediate value? */
+        if (op->type == AARCH64_OP_IMM) {
+            /* calculate offset, target = pc + (imm << 2). */
+            call->is_rel = true;
+            call->orig_off = (int32_t)(op->imm - insn->address);
+            call->call = (void*)insn->address;
+            call->dest = (void*)(uintptr_t)op->imm;
+            call->size = insn->size;
+
+            /* copy bytes and return. */
+            /* NOLINTNEXTLINE */
+            memcpy(call->bytes, (void*)insn->address, insn->size < 32u ? insn->size : 32u);
+            return E_INTT_RESULT_SUCCESS;
+        }
+    }
+    return E_INTT_RESULT_FAILURE;
+}
+
+/**
+ * @brief is this a call based on the architecture (manual for arm, and insn_group for CS_GRP_CALL).
+ *
+ * @param handle the capstone handle required.
+ * @param insn the capstone instruction.
+ * @param architecture the architecture we are using.
+ * @return if this is a some type of a call instruction.
+ */
+internal e_intt_result_t
+is_call_arch(csh handle, cs_insn* insn, arch_t architecture) {
+    /* aarch64. */
+    if (architecture.arch == CS_ARCH_AARCH64) {
+        return insn->id == AARCH64_INS_BL || insn->id == AARCH64_INS_BLR;
+    }
+    /* arm32/ armth. */
+    if (architecture.arch == CS_ARCH_ARM) {
+        return insn->id == ARM_INS_BL || insn->id == ARM_INS_BLX;
+    }
+    /* x86 like. */
+    return cs_insn_group(handle, insn, CS_GRP_CALL);
+}
+
+/**
+ * @brief get the capstone handle (and instruction) of the calling thread for a mode, opening
+ *  it on first use.
+ *
+ * @param architecture the architecture (and mode) to decode.
+ * @param is_thumb if the thumb handle is wanted.
+ * @param handle the handle to be filled in.
+ * @param insn the instruction to be filled in.
+ * @return ref. to intt.h for enum.
+ */
+internal e_intt_result_t
+context_get(arch_t architecture, bool is_thumb, csh* handle, cs_insn** insn) {
+    size_t index = is_thumb ? 1u : 0u;
+    if (!l_context.open[index]) {
+        if (cs_open(architecture.arch, architecture.mode, &l_context.handles[index]) != CS_ERR_OK) {
+            /* NOLINTNEXTLINE */
+            fprintf(stderr, "tapi, det_scan; cs_open failed; could not open capstone.\n");
+            return E_INTT_RESULT_FAILURE;
+        }
+        cs_option(l_context.handles[index], CS_OPT_DETAIL, CS_OPT_ON);
+        l_context.insns[index] = cs_malloc(l_context.handles[index]);
+        if (!l_context.insns[index]) {
+            cs_close(&l_context.handles[index]);
+            /* NOLINTNEXTLINE */
+            fprintf(stderr, "tapi, det_scan; cs_malloc failed; could not allocate memory for "
+                            "instructions.\n");
+            return E_INTT_RESULT_FAILURE;
+        }
+        l_context.open[index] = true;
+    }
+    *handle = l_context.handles[index];
+    *insn = l_context.insns[index];
+    return E_INTT_RESULT_SUCCESS;
+}
+
+/**
+ * @brief collect a call instruction into the context of the thread, if we can tell where it goes.
+ *
+ * @param handle the capstone handle used.
+ * @param insn the instruction to be inspected.
+ * @param architecture the architecture (and mode) decoded.
+ * @param is_thumb if the instruction is thumb.
+ */
+internal void
+collect_call(csh handle, cs_insn* insn, arch_t architecture, bool is_thumb) {
+    if (!is_call_arch(handle, insn, architecture)) {
+        if (architecture.arch == CS_ARCH_AARCH64)
+            track_barm64(insn);
+        return;
+    }
+    det_call_t call = { .is_thumb = is_thumb };
+    e_intt_result_t decoded = E_INTT_RESULT_FAILURE;
+    if (architecture.arch == CS_ARCH_X86)
+        decoded = decode_call_bx86(&call, insn, architecture.mode);
+    else if (architecture.arch == CS_ARCH_ARM)
+        decoded = decode_call_barm32(&call, insn);
+    else if (architecture.arch == CS_ARCH_AARCH64) {
+        decoded = decode_call_baarch64(&call, insn);
+        track_barm64(insn);
+    }
+    if e_intt_passed(decoded)
+        det_calls_push(&l_context.calls, call);
+}
+
+/**
+ * @brief collect the destination of a relative jump or call into the context of the thread.
+ *
+ * @param handle the capstone handle used.
+ * @param insn the instruction to be inspected.
+ * @param architecture the architecture (and mode) decoded.
+ */
+internal void
+collect_branch(csh handle, cs_insn* insn, arch_t architecture) {
+    if (!cs_insn_group(handle, insn, CS_GRP_JUMP) && !cs_insn_group(handle, insn, CS_GRP_CALL))
+        return;
+
+    /* the destination is the last immediate (a tbz has the bit number before it). */
+    bool found = false;
+    int64_t dest = 0;
+    if (architecture.arch == CS_ARCH_X86) {
+        const cs_x86* x86 = &insn->detail->x86;
+        for (size_t i = 0u; i < x86->op_count; i++)
+            if (x86->operands[i].type == X86_OP_IMM) {
+                dest = x86->operands[i].imm;
+                found = true;
+            }
+    }
+    else if (architecture.arch == CS_ARCH_ARM) {
+        const cs_arm* arm = &insn->detail->arm;
+        for (size_t i = 0u; i < arm->op_count; i++)
+            if (arm->operands[i].type == ARM_OP_IMM) {
+                dest = arm->operands[i].imm;
+                found = true;
+            }
+    }
+    else if (architecture.arch == CS_ARCH_AARCH64) {
+        const cs_aarch64* aarch64 = &insn->detail->aarch64;
+        for (size_t i = 0u; i < aarch64->op_count; i++)
+            if (aarch64->operands[i].type == AARCH64_OP_IMM) {
+                dest = aarch64->operands[i].imm;
+                found = true;
+            }
+    }
+    if (found)
+        det_branches_push(&l_context.branches, (uintptr_t) dest);
+}
+
+/**
+ * @brief drop every blr whose chain a branch lands within (after its adrp, up to the blr); the
+ *  values followed along the chain don't hold on the path from the branch.
+ */
+internal void
+drop_split_chains(void) {
+    size_t kept = 0u, next = 0u;
+    for (size_t i = 0u; i < l_context.calls.length; i++) {
+        bool is_split = false;
+        if (next < l_context.chains.length && l_context.chains.data[next].call == i) {
+            uintptr_t from = l_context.chains.data[next++].from;
+            uintptr_t at = (uintptr_t) l_context.calls.data[i].call;
+            _vforeach_it(&l_context.branches, uintptr_t, dest, j)
+                is_split |= dest > from && dest <= at;
+            _endforeach;
+        }
+        if (!is_split)
+            l_context.calls.data[kept++] = l_context.calls.data[i];
+    }
+    l_context.calls.length = kept;
+}
+
+/**
+ * @brief decode a function in a single pass, finding where it ends and collecting every call
+ *  within it as we go.
  *
  * @param address the address of the function to analyze.
  * @param max_size the max size to search.
- * @return size of the function in memory.
+ * @param bounded if the size is known to be exactly max_size, where the end isn't searched for.
+ * @param scan the scan to be filled in; its calls live in the context of the thread.
+ * @return ref. to intt.h for enum.
  */
-size_t
-det_function_size(void* address, size_t max_size) {
-    /* open capstone to reading at the specified address with the native architecture. */
-    csh handle;
-    size_t size = 0;
-    arch_t architecture = get_arch();
+internal e_intt_result_t
+scan_function(void* address, size_t max_size, bool bounded, det_scan_t* scan) {
     /* detect if we need to use thumb based on the thumb bit. */
+    arch_t architecture = get_arch();
     bool is_thumb = architecture.mode == CS_MODE_ARM && (uintptr_t)address & 1u;
+    void* start = address;
     if (is_thumb) {
-        address = (void*)((uintptr_t)address & ~1u);
+        start = (void*)((uintptr_t)address & ~1u);
         architecture.mode = CS_MODE_THUMB;
     }
-    cs_open(architecture.arch, architecture.mode, &handle);
-    cs_option(handle, CS_OPT_DETAIL, CS_OPT_ON);
+    csh handle;
+    cs_insn* insn;
+    if (!e_intt_passed(context_get(architecture, is_thumb, &handle, &insn)))
+        return E_INTT_RESULT_FAILURE;
 
     /* get the bytes at the address, and create an iterator. */
-    const uint8_t* bytes = (unsigned char*) address;
-    uint64_t iter = (uintptr_t) address;
-    size_t code_size = max_size;
-    cs_insn* insn = cs_malloc(handle);
-    if (!insn) {
-        cs_close(&handle);
-        /* NOLINTNEXTLINE */
-        fprintf(stderr, "tapi, det_function_size; cs_malloc failed; could not allocate memory for "
-                        "instructions.");
-        return 0;
-    }
+    const uint8_t* bytes = (unsigned char*) start;
+    uint64_t iter = (uintptr_t) start;
+    size_t code_size = max_size, size = 0u;
+    det_calls_clear(&l_context.calls);
+    det_branches_clear(&l_context.branches);
+    det_chains_clear(&l_context.chains);
+    l_context.known = l_context.pages = 0u;
 
     /* start iterating. */
     int32_t pad_count = 0;
@@ -98,6 +579,13 @@ det_function_size(void* address, size_t max_size) {
     while (cs_disasm_iter(handle, &bytes, &code_size, &iter, insn)) {
         size += insn->size;
 
+        /* with a known size, we only collect calls. */
+        if (bounded) {
+            collect_call(handle, insn, architecture, is_thumb);
+            collect_branch(handle, insn, architecture);
+            continue;
+        }
+
         /* are any of these function end instructions? */
         if (is_end_inst(insn, handle))
             found_end = !is_tail_call(insn, architecture);
@@ -121,6 +609,10 @@ det_function_size(void* address, size_t max_size) {
             }
         }
 
+        /* collect the call, if we can tell where it goes, and where any branch goes. */
+        collect_call(handle, insn, architecture, is_thumb);
+        collect_branch(handle, insn, architecture);
+
         /* have we already hit a function-ending instruction? */
         if (found_end) {
             /* we scan for nop padding sections. */
@@ -147,300 +639,305 @@ det_function_size(void* address, size_t max_size) {
         /* sanity bounds. */
         if (size >= max_size) {
             /* NOLINTNEXTLINE */
-            fprintf(stderr, "tapi, det_function_size; warning; hit max search size of %zu bytes\n",
+            fprintf(stderr, "tapi, det_scan; warning; hit max search size of %zu bytes\n",
                 max_size);
             break;
         }
     }
 
-    /* free and close. */
-    cs_free(insn, 1);
-    cs_close(&handle);
-    return size;
+    /* fill in the scan. */
+    if (l_context.chains.length != 0u)
+        drop_split_chains();
+    scan->address = address;
+    scan->max_size = max_size;
+    scan->size = size;
+    scan->calls = l_context.calls.data;
+    scan->count = l_context.calls.length;
+    scan->branches = l_context.branches.data;
+    scan->branch_count = l_context.branches.length;
+    return E_INTT_RESULT_SUCCESS;
 }
 
 /**
- * @brief search through an x86 instructions opt. info to find if it is a call to an
- *  immediate/ relative address within the memory; for x86|x86_64 only.
+ * @brief find the cache slot of a function, or the empty slot it would go in.
  *
- * @param target the target address to search within the instruction for.
- * @param call the call information structure to be used.
- * @param insn the instruction to be searched.
- * @param mode the mode of the architecture (x86 vs. x86_64).
- * @return ref. to intt.h for enum.
+ * @param address the address of the function.
+ * @param max_size the max size searched.
+ * @return the slot, or 0x0 if there is no cache yet.
  */
-internal e_intt_result_t
-find_call_bx86(const void* target, det_call_t* call, const cs_insn* insn, const cs_mode mode) {
-    /* we look for the target address. */
-    uint64_t address = 0u;
-    cs_x86* ops = &insn->detail->x86;
-    for (size_t i = 0; i < ops->op_count; i++) {
-        /* iterate until we find the immediate value used in the call. */
-        cs_x86_op* op = &ops->operands[i];
-        if (op->type == X86_OP_IMM) {
-            if (mode == CS_MODE_64) {
-                /* relative call. */
-                if (op->imm <= UINT32_MAX && ops->disp == 0u) {
-                    address = insn->address + insn->size + op->imm;
-                    call->is_rel = true;
-                    call->orig_off = (int32_t) op->imm;
-                }
-                else if (op->size == 8u) {
-                    /* absolute call, we can still modify these as if they were rel. */
-                    address = op->imm;
-                    call->is_rel = true;
-                }
-                /* we currently don't support rip-rel calls. */
-            }
-            else {
-                /* e8 call with 4-byte immediate. */
-                if (op->size == 4u) {
-                    address = op->imm;
-                    call->is_rel = true;
-                }
-                else { /* unrecognized. */ }
-            }
-
-            /* check if it is our target. */
-            bool is_target = address == (uint64_t) target;
-            if (is_target) {
-                call->call = (void*) insn->address;
-                call->dest = (void*) target;
-                call->size = insn->size;
-
-                /* copy and return. */
-                /* NOLINTNEXTLINE */
-                memcpy(call->bytes, insn->bytes, insn->size < 32u ? insn->size : 32u);
-                return E_INTT_RESULT_SUCCESS;
-            }
-        }
+internal det_scan_t**
+cache_slot(void* address, size_t max_size) {
+    if (l_cache == 0x0)
+        return 0x0;
+    size_t i = (size_t)(((uint64_t)(uintptr_t) address * 0x9e3779b97f4a7c15ull) >> 32u);
+    for (;; i++) {
+        det_scan_t** slot = &l_cache[i & (l_slots - 1u)];
+        if (*slot == 0x0 || ((*slot)->address == address && (*slot)->max_size == max_size))
+            return slot;
     }
-    return E_INTT_RESULT_FAILURE;
 }
 
 /**
- * @brief search through an arm instructions opt. info to find if it is a call to an immediate/
- *  relative address within memory; for aarch32|thumb only.
+ * @brief make room in the cache for one more scan, doubling it at 3/4 load; the old table is
+ *  left in the internal arena.
  *
- * @param target the target address to search within the instruction for.
- * @param call the call information structure to be used.
- * @param insn the instruction to be searched.
  * @return ref. to intt.h for enum.
  */
 internal e_intt_result_t
-find_call_barm32(const void* target, det_call_t* call, const cs_insn* insn) {
-    bool branch_link = insn->id == ARM_INS_BL;
-    bool blx = insn->id == ARM_INS_BLX;
-    if (branch_link || blx) {
-        cs_arm* arm = &insn->detail->arm;
-
-        /* iterate through every operand. */
-        for (size_t i = 0x0; i < arm->op_count; i++) {
-            cs_arm_op* op = &arm->operands[i];
-            if (op->type == ARM_OP_IMM) {
-                uint64_t target_addr = (uint64_t)op->imm;
-                call->is_rel = true;
+cache_reserve(void) {
+    if ((l_cached + 1u) * 4u <= l_slots * 3u)
+        return E_INTT_RESULT_SUCCESS;
+    size_t slots = l_slots ? l_slots * 2u : CACHE_SLOTS;
+    det_scan_t** cache = frame_alloc(sizeof *cache * slots), ** old = l_cache;
+    if (cache == 0x0)
+        return E_INTT_RESULT_FAILURE;
+    size_t old_slots = l_slots;
+    l_cache = cache;
+    l_slots = slots;
+    for (size_t i = 0u; i < old_slots; i++)
+        if (old[i] != 0x0)
+            *cache_slot(old[i]->address, old[i]->max_size) = old[i];
+    return E_INTT_RESULT_SUCCESS;
+}
 
-                /* is it a branch with link insn? */
-                if (branch_link) {
-                    /* calculate original offset. */
-                    if (call->is_thumb) {
-                        /* thumb bl/blx; 2-instruction sequence
-                         *  bl encodes a 21-bit signed offset. */
-                        call->orig_off = (int32_t)(op->imm - (insn->address + 4u)) >> 1u;
-                    } else {
-                        /* arm bl; encodes 24-bit signed offset. */
-                        call->orig_off = (int32_t)(op->imm - (insn->address + 8u)) >> 2u;
-                    }
-                }
+/**
+ * @brief decode a function once, finding its size and its call sites together; results are
+ *  cached per function (and max size) until det_release(), the code is assumed to stay mapped.
+ *
+ * @param address the address of the function to analyze.
+ * @param max_size the max size to search.
+ * @return the scan of the function, or 0x0 if it could not be decoded.
+ */
+const det_scan_t*
+det_scan(void* address, size_t max_size) {
+    /* have we seen this function already? */
+    pthread_mutex_lock(&l_lock);
+    det_scan_t** slot = cache_slot(address, max_size);
+    det_scan_t* cached = slot != 0x0 ? *slot : 0x0;
+    pthread_mutex_unlock(&l_lock);
+    if (cached != 0x0)
+        return cached;
+
+    /* o.w. decode it; whatever this allocates belongs to tapi, not to the running test. */
+    leak_pause();
+    det_scan_t* scan = &l_context.scan;
+    if (!e_intt_passed(scan_function(address, max_size, false, scan))) {
+        leak_resume();
+        return 0x0;
+    }
 
-                /* is this the target address? */
-                uint64_t target_compare = (uint64_t)target & ~1u;
-                uint64_t addr_compare = target_addr & ~1u;
-                if (target_compare == addr_compare) {
-                    call->call = (void*)insn->address;
-                    call->dest = (void*)target_addr;
-                    call->size = insn->size;
-
-                    /* is this a blx interworking call? */
-                    if (blx) {
-                        if (call->is_thumb)
-                            call->orig_off = (int32_t)(op->imm - (insn->address + 4u)) >> 1u;
-                        else
-                            call->orig_off = (int32_t)(op->imm - (insn->address + 8u)) >> 2u;
-                    }
-
-                    /* copy bytes and return. */
-                    /* NOLINTNEXTLINE */
-                    memcpy(call->bytes, (void*)insn->address,
-                           insn->size < 32u ? insn->size : 32u);
-                    return E_INTT_RESULT_SUCCESS;
-                }
-            }
+    /* and keep a copy in the internal arena; without room, every lookup decodes again. */
+    pthread_mutex_lock(&l_lock);
+    slot = cache_slot(address, max_size);
+    if (slot != 0x0 && *slot != 0x0)
+        scan = *slot; /* another thread got here first. */
+    else {
+        det_scan_t* copy = frame_alloc(sizeof *copy);
+        det_call_t* calls = frame_alloc(sizeof *calls * (scan->count ? scan->count : 1u));
+        uintptr_t* branches = frame_alloc(sizeof *branches * (scan->branch_count ?
+                                                               scan->branch_count : 1u));
+        if (copy != 0x0 && calls != 0x0 && branches != 0x0 && e_intt_passed(cache_reserve())) {
+            *copy = *scan;
+            /* NOLINTNEXTLINE */
+            memcpy(calls, scan->calls, sizeof *calls * scan->count);
+            /* NOLINTNEXTLINE */
+            memcpy(branches, scan->branches, sizeof *branches * scan->branch_count);
+            copy->calls = calls;
+            copy->branches = branches;
+            *cache_slot(address, max_size) = scan = copy;
+            l_cached++;
+        }
+        else if (!l_uncached) {
+            /* NOLINTNEXTLINE */
+            fprintf(stderr, "tapi, det_scan; frame_alloc failed; scans are no longer cached.\n");
+            l_uncached = true;
         }
     }
-    return E_INTT_RESULT_FAILURE;
+    pthread_mutex_unlock(&l_lock);
+    leak_resume();
+    return scan;
 }
 
 /**
- * @brief search through an aarch64 instructions opt. info to find if it is a call to an immediate/
- *  relative address within memory; for aarch64 only.
+ * @brief find the size of the function in memory.
  *
- * @param target the target address to search within the instruction for.
- * @param call the call info structure to be used.
- * @param insn the instruction to be searched.
- * @return ref. to intt.h for enum.
+ * @param address the address of the function to analyze.
+ * @param max_size the max size to search.
+ * @return size of the function in memory.
  */
-internal e_intt_result_t
-find_call_baarch64(const void* target, det_call_t* call, const cs_insn* insn) {
-    /* is this a branch with link insn? */
-    if (insn->id == AARCH64_INS_BL) {
-        cs_aarch64* aarch64 = &insn->detail->aarch64;
-
-        /* iterate... */
-        for (size_t i = 0; i < aarch64->op_count; i++) {
-            cs_aarch64_op* op = &aarch64->operands[i];
-
-            /* are we dealing with the immediate value? */
-            if (op->type == AARCH64_OP_IMM) {
-                uint64_t target_addr = op->imm;
-                call->is_rel = true;
-
-                /* calculate offset, target = pc + (imm << 2). */
-                call->orig_off = (int32_t)(target_addr - insn->address);
+size_t
+det_function_size(void* address, size_t max_size) {
+    const det_scan_t* scan = det_scan(address, max_size);
+    return scan != 0x0 ? scan->size : 0u;
+}
 
-                /* is this the target address? */
-                if ((void*)target_addr == target) {
-                    call->call = (void*)insn->address;
-                    call->dest = (void*)target_addr;
-                    call->size = insn->size;
+/**
+ * @brief determine the call target within a function in memory.
+ *
+ * @param source the function in memory to search through.
+ * @param target the target call to look for.
+ * @param call the call information to be filled in.
+ * @return ref. to intt.h for enum, fails if there is no call to target.
+ */
+e_intt_result_t
+det_call_target(void* source, const void* target, det_call_t* call) {
+    const det_scan_t* scan = det_scan(source, 0x1000);
+    if (scan == 0x0)
+        return E_INTT_RESULT_FAILURE;
 
-                    /* copy bytes and return. */
-                    /* NOLINTNEXTLINE */
-                    memcpy(call->bytes, (void*)insn->address,
-                           insn->size < 32u ? insn->size : 32u);
-                    return E_INTT_RESULT_SUCCESS;
-                }
-            }
+    /* arm targets are compared without the thumb bit. */
+    uintptr_t mask = get_arch().arch == CS_ARCH_ARM ? ~(uintptr_t) 1u : ~(uintptr_t) 0u;
+    for (size_t i = 0u; i < scan->count; i++) {
+        if (((uintptr_t) scan->calls[i].dest & mask) == ((uintptr_t) target & mask)) {
+            *call = scan->calls[i];
+            return E_INTT_RESULT_SUCCESS;
         }
     }
-    /* blr for indirect calls via register. */
-    if (insn->id == AARCH64_INS_BLR) {
-        /* this is unsupported at the moment. */
-        return E_INTT_RESULT_FAILURE;
-    }
     return E_INTT_RESULT_FAILURE;
 }
 
 /**
- * @brief is this a call based on the architecture (manual for arm, and insn_group for CS_GRP_CALL).
+ * @brief decode exactly size bytes of a function (e.g. as given by its symbol), collecting its
+ *  call sites; nothing is cached.
  *
- * @param handle the capstone handle required.
- * @param insn the capstone instruction.
- * @param architecture the architecture we are using.
- * @return if this is a some type of a call instruction.
+ * @param address the address of the function to analyze.
+ * @param size the size of the function.
+ * @param scan the scan to be filled in; its calls are only valid until the calling thread
+ *  decodes again.
+ * @return ref. to intt.h for enum.
  */
-internal e_intt_result_t
-is_call_arch(csh handle, cs_insn* insn, arch_t architecture) {
-    /* aarch64. */
-    if (architecture.arch == CS_ARCH_AARCH64) {
-        return insn->id == AARCH64_INS_BL || insn->id == AARCH64_INS_BLR;
+e_intt_result_t
+det_decode(void* address, size_t size, det_scan_t* scan) {
+    return scan_function(address, size, true, scan);
+}
+
+/**
+ * @brief classify how an x86 instruction reads the pc; for x86|x86_64 only.
+ *
+ * @param out the instruction to be filled in.
+ * @param handle the capstone handle used.
+ * @param insn the instruction to be inspected.
+ */
+internal void
+classify_bx86(det_insn_t* out, csh handle, const cs_insn* insn) {
+    /* loops and jcxz only have an 8-bit form, they can't be rewritten to reach further. */
+    if (insn->id == X86_INS_LOOP || insn->id == X86_INS_LOOPE || insn->id == X86_INS_LOOPNE ||
+        insn->id == X86_INS_JCXZ || insn->id == X86_INS_JECXZ || insn->id == X86_INS_JRCXZ) {
+        out->kind = E_DET_INSN_UNSUPPORTED;
+        return;
     }
-    /* arm32/ armth. */
-    if (architecture.arch == CS_ARCH_ARM) {
-        return insn->id == ARM_INS_BL || insn->id == ARM_INS_BLX;
+    bool is_call = cs_insn_group(handle, insn, CS_GRP_CALL);
+    bool is_jump = cs_insn_group(handle, insn, CS_GRP_JUMP);
+    bool is_relative = cs_insn_group(handle, insn, CS_GRP_BRANCH_RELATIVE);
+    const cs_x86* x86 = &insn->detail->x86;
+    for (size_t i = 0u; i < x86->op_count; i++) {
+        const cs_x86_op* op = &x86->operands[i];
+        /* a relative branch, capstone gives us where it goes. */
+        if (op->type == X86_OP_IMM && (is_call || is_jump) && is_relative) {
+            out->dest = (void*)(uintptr_t) op->imm;
+            out->kind = is_call ? E_DET_INSN_CALL :
+                insn->id == X86_INS_JMP ? E_DET_INSN_JUMP : E_DET_INSN_JCC;
+            return;
+        }
+        /* or a rip-relative memory operand (x86_64 only). */
+        if (op->type == X86_OP_MEM && op->mem.base == X86_REG_RIP) {
+            out->dest = (void*)(uintptr_t)(insn->address + insn->size + op->mem.disp);
+            out->disp_offset = x86->encoding.disp_offset;
+            out->kind = E_DET_INSN_PCREL;
+            return;
+        }
     }
-    /* x86 like. */
-    return cs_insn_group(handle, insn, CS_GRP_CALL);
 }
 
 /**
- * @brief determine the call target within a function in memory.
+ * @brief decode the whole instructions at the start of a function that cover at least min_size
+ *  bytes, for displacing them with an entry patch.
  *
- * @param source the function in memory to search through.
- * @param target the target call to look for.
- * @return a pointer to a det_call_t structure, and 0 o.w.
+ * @param address the address of the function (with the thumb bit, on arm).
+ * @param min_size the number of bytes that are to be displaced.
+ * @param prologue the prologue to be filled in.
+ * @return ref. to intt.h for enum, fails if the function ends before min_size bytes.
  */
-det_call_t*
-det_call_target(void* source, const void* target) {
-    /* open memory for the compile-time architecture. */
-    csh handle;
-    arch_t architecture = get_arch();
-
+e_intt_result_t
+det_prologue(void* address, size_t min_size, det_prologue_t* prologue) {
     /* detect if we need to use thumb based on the thumb bit. */
-    bool is_thumb = architecture.mode == CS_MODE_ARM && (uint64_t) source & 1u;
-    if (is_thumb)
+    arch_t architecture = get_arch();
+    bool is_thumb = architecture.arch == CS_ARCH_ARM && (uintptr_t) address & 1u;
+    void* start = address;
+    if (is_thumb) {
+        start = (void*)((uintptr_t) address & ~1u);
         architecture.mode = CS_MODE_THUMB;
-    cs_open(architecture.arch, architecture.mode, &handle);
-    cs_option(handle, CS_OPT_DETAIL, CS_OPT_ON);
+    }
+    /* NOLINTNEXTLINE */
+    memset(prologue, 0, sizeof *prologue);
+    prologue->address = start;
+    prologue->is_thumb = is_thumb;
+    leak_pause();
+    csh handle;
+    cs_insn* insn;
+    if (!e_intt_passed(context_get(architecture, is_thumb, &handle, &insn))) {
+        leak_resume();
+        return E_INTT_RESULT_FAILURE;
+    }
 
-    /* allocate the pointer. */
-    det_call_t* call = calloc(1u, sizeof *call);
-    if (call == 0x0) {
+    /* decode until the patch is covered, the last instruction may run past it. */
+    const uint8_t* bytes = (const uint8_t*) start;
+    uint64_t iter = (uintptr_t) start;
+    size_t code_size = min_size + 16u;
+    while (prologue->size < min_size && prologue->count < DET_PROLOGUE_MAX &&
+           cs_disasm_iter(handle, &bytes, &code_size, &iter, insn)) {
+        det_insn_t* out = &prologue->insns[prologue->count++];
+        out->address = (void*)(uintptr_t) insn->address;
+        out->size = insn->size;
         /* NOLINTNEXTLINE */
-        fprintf(stderr, "tapi, det_call_target; calloc failed; could not allocate memory for "
-                        "det_call_t*.\n");
-        return 0x0;
+        memcpy(out->bytes, insn->bytes, insn->size < 16u ? insn->size : 16u);
+        if (architecture.arch == CS_ARCH_X86)
+            classify_bx86(out, handle, insn);
+        prologue->size += insn->size;
+
+        /* the function can't end before the patch does, we'd be writing over whatever follows. */
+        if (prologue->size < min_size && (cs_insn_group(handle, insn, CS_GRP_RET) ||
+                                          is_tail_call(insn, architecture))) {
+            leak_resume();
+            /* NOLINTNEXTLINE */
+            fprintf(stderr, "tapi, det_prologue; function is smaller than an entry patch (%zu "
+                            "bytes).\n", min_size);
+            return E_INTT_RESULT_FAILURE;
+        }
     }
-    call->is_thumb = is_thumb;
-
-    /* set up address and size for the iteration. */
-    size_t size = det_function_size(source, 0x1000);
-    if (is_thumb)
-        source = (void*)((uintptr_t)source & ~1u);
-    const uint8_t* bytes = source;
-    uint64_t address = (uint64_t) source;
-    cs_insn* insn = cs_malloc(handle);
-    if (!insn) {
-        cs_close(&handle);
-        free(call);
+    leak_resume();
+    if (prologue->size < min_size) {
         /* NOLINTNEXTLINE */
-        fprintf(stderr, "tapi det_call_target, cs_malloc failed; could not allocate memory for "
-                        "instructions.\n");
-        return 0x0;
+        fprintf(stderr, "tapi, det_prologue; could not decode %zu bytes at the start of the "
+                        "function.\n", min_size);
+        return E_INTT_RESULT_FAILURE;
     }
+    return E_INTT_RESULT_SUCCESS;
+}
 
-    /* iterating. */
-    while (cs_disasm_iter(handle, &bytes, &size, &address, insn)) {
-        /* is this a call instruction? */
-        if (is_call_arch(handle, insn, architecture)) {
-            /* get the target address */
-            switch (architecture.arch) {
-                case (CS_ARCH_X86): {
-                    /* check if we can find the target in the insn. */
-                    if e_intt_passed(find_call_bx86(target, call, insn, architecture.mode)) {
-                        cs_free(insn, 1u);
-                        cs_close(&handle);
-                        return call;
-                    }
-                    break;
-                }
-                /* same for both arm32 and aarch64. */
-                case (CS_ARCH_ARM): {
-                    /* this is really aarch32 + thumb. */
-                    if e_intt_passed(find_call_barm32(target, call, insn)) {
-                        cs_free(insn, 1u);
-                        cs_close(&handle);
-                        return call;
-                    }
-                    break;
-                }
-                case (CS_ARCH_AARCH64): {
-                    if e_intt_passed(find_call_baarch64(target, call, insn)) {
-                        cs_free(insn, 1u);
-                        cs_close(&handle);
-                        return call;
-                    }
-                    break;
-                }
-                default: break;
-            }
-        }
+/** @brief close the capstone handles of the calling thread, e.g. before it exits. */
+void
+det_close(void) {
+    for (size_t i = 0u; i < 2u; i++) {
+        if (!l_context.open[i])
+            continue;
+        cs_free(l_context.insns[i], 1u);
+        cs_close(&l_context.handles[i]);
+        l_context.open[i] = false;
     }
+    det_calls_free(&l_context.calls);
+    det_branches_free(&l_context.branches);
+    det_chains_free(&l_context.chains);
+    guard_maps_free(&l_context.maps);
+}
 
-    /* free & return. */
-    free(call);
-    cs_free(insn, 1u);
-    cs_close(&handle);
-    return 0x0;
-}
\ No newline at end of file
+/** @brief drop every cached scan, and close the capstone handles of the calling thread. */
+void
+det_release(void) {
+    /* the scans themselves go with the internal arena. */
+    pthread_mutex_lock(&l_lock);
+    l_cache = 0x0;
+    l_cached = l_slots = 0u;
+    pthread_mutex_unlock(&l_lock);
+    det_close();
+}
@@ -14,6 +14,9 @@
 /*! @uses bool, true, false. */
 #include <stdbool.h>
 
+/*! @uses e_intt_result_t. */
+#include "intt.h"
+
 /**
  * @brief find the size of the function in memory.
  *
@@ -37,13 +40,102 @@ typedef struct {
     int32_t offset, orig_off; /* ... */
 } det_call_t;
 
+/**
+ * the result of a single decoding pass over a function: its size, every direct call within it
+ *  whose destination could be determined, in address order, and where its branches go.
+ */
+typedef struct {
+    void* address; /* the function, as given (with the thumb bit). */
+    size_t max_size, size; /* the max size searched, and the size of the function. */
+    det_call_t* calls; /* the call sites. */
+    size_t count; /* the number of call sites. */
+    uintptr_t* branches; /* the destinations of every relative jump and call within it. */
+    size_t branch_count; /* the number of destinations. */
+} det_scan_t;
+
+/* the most instructions displaced from the start of a function by an entry patch. */
+#define DET_PROLOGUE_MAX 16u
+
+/** how an instruction at the start of a function reads the pc, for relocating it elsewhere. */
+typedef enum {
+    E_DET_INSN_PLAIN = 0, /* doesn't read the pc (on arm this is left to the encoding). */
+    E_DET_INSN_JUMP, /* an unconditional relative jump to dest. */
+    E_DET_INSN_JCC, /* a conditional relative jump to dest. */
+    E_DET_INSN_CALL, /* a relative call to dest. */
+    E_DET_INSN_PCREL, /* a rip-relative memory operand, its disp32 at disp_offset. */
+    E_DET_INSN_UNSUPPORTED, /* reads the pc in a way that can't be moved (loop, jcxz, ...). */
+} e_det_insn_t;
+
+/** a single decoded instruction from the start of a function. */
+typedef struct {
+    void* address; /* where the instruction is. */
+    size_t size; /* instruction size. */
+    uint8_t bytes[16u]; /* the bytes of the instruction. */
+    e_det_insn_t kind; /* how it reads the pc. */
+    void* dest; /* the destination of a branch, or the address read by a pc-relative operand. */
+    uint8_t disp_offset; /* the offset of a rip-relative disp32 within the instruction. */
+} det_insn_t;
+
+/** the whole instructions at the start of a function, covering at least some number of bytes. */
+typedef struct {
+    void* address; /* the function (without the thumb bit). */
+    bool is_thumb; /* if the function is thumb. */
+    det_insn_t insns[DET_PROLOGUE_MAX];
+    size_t count, size; /* the number of instructions, and the bytes they cover. */
+} det_prologue_t;
+
+/**
+ * @brief decode the whole instructions at the start of a function that cover at least min_size
+ *  bytes, for displacing them with an entry patch.
+ *
+ * @param address the address of the function (with the thumb bit, on arm).
+ * @param min_size the number of bytes that are to be displaced.
+ * @param prologue the prologue to be filled in.
+ * @return ref. to intt.h for enum, fails if the function ends before min_size bytes.
+ */
+e_intt_result_t
+det_prologue(void* address, size_t min_size, det_prologue_t* prologue);
+
+/**
+ * @brief decode a function once, finding its size and its call sites together; results are
+ *  cached per function (and max size) until det_release(), the code is assumed to stay mapped.
+ *
+ * @param address the address of the function to analyze.
+ * @param max_size the max size to search.
+ * @return the scan of the function, or 0x0 if it could not be decoded.
+ */
+const det_scan_t*
+det_scan(void* address, size_t max_size);
+
 /**
  * @brief determine the call target within a function in memory.
  *
  * @param source the function in memory to search through.
  * @param target the target call to look for.
- * @return a pointer to a det_call_t structure, and 0 o.w.
+ * @param call the call information to be filled in.
+ * @return ref. to intt.h for enum, fails if there is no call to target.
  */
-det_call_t*
-det_call_target(void* source, const void* target);
+e_intt_result_t
+det_call_target(void* source, const void* target, det_call_t* call);
+
+/**
+ * @brief decode exactly size bytes of a function (e.g. as given by its symbol), collecting its
+ *  call sites; nothing is cached.
+ *
+ * @param address the address of the function to analyze.
+ * @param size the size of the function.
+ * @param scan the scan to be filled in; its calls are only valid until the calling thread
+ *  decodes again.
+ * @return ref. to intt.h for enum.
+ */
+e_intt_result_t
+det_decode(void* address, size_t size, det_scan_t* scan);
+
+/** @brief close the capstone handles of the calling thread, e.g. before it exits. */
+void
+det_close(void);
+
+/** @brief drop every cached scan, and close the capstone handles of the calling thread. */
+void
+det_release(void);
 #endif /* DET_H */
\ No newline at end of file
@@ -0,0 +1,268 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-10-19
+ */
+#include "dispatch.h"
+
+/*! @uses pthread_mutex_t, pthread_mutex_lock, pthread_mutex_unlock. */
+#include <pthread.h>
+
+/*! @uses fprintf, stderr. */
+#include <stdio.h>
+
+/*! @uses memcpy. */
+#include <string.h>
+
+/*! @uses uint8_t, uint32_t, uint64_t, uintptr_t. */
+#include <stdint.h>
+
+/*! @uses site_t, sites_build, sites_find. */
+#include "sites.h"
+
+/*! @uses patch_batch_t, patch_batch_add, patch_batch_commit. */
+#include "patch.h"
+
+/*! @uses tramp_place. */
+#include "tramp.h"
+
+/* the most code a stub takes. */
+#define DISPATCH_STUB_MAX 96u
+
+/** a target whose calls are routed through a stub. */
+typedef struct {
+    void* target, *stub;
+    const site_t* sites; /* its calls, in the index. */
+    size_t count, routed; /* the number of them, and of those routed through the stub. */
+} dispatch_t;
+
+/* every routed target; a slot is never reused until dispatch_release(). */
+static pthread_mutex_t l_lock = PTHREAD_MUTEX_INITIALIZER;
+static dispatch_t l_targets[DISPATCH_MAX];
+static size_t l_count;
+
+/* the mock of every target on this thread (initial-exec, so reading it never calls anything). */
+static _Thread_local const void* l_mocked[DISPATCH_MAX]
+    __attribute__((tls_model("initial-exec")));
+
+/**
+ * @brief find the function a stub goes to for the calling thread.
+ *
+ * @param context the target.
+ * @param args the saved arguments of the call (unused).
+ * @return the thread's mock of the target, or the target.
+ */
+internal DISPATCH_GPRS const void*
+dispatch_lookup(const void* context, const uintptr_t* args) {
+    (void) args;
+    const dispatch_t* dispatch = context;
+    const void* mocked = l_mocked[dispatch - l_targets];
+    return mocked != 0x0 ? mocked : dispatch->target;
+}
+
+/**
+ * @brief append bytes to a stub.
+ *
+ * @param code the stub.
+ * @param size the size of the stub so far, to be advanced.
+ * @param bytes the bytes.
+ * @param count the number of bytes.
+ */
+internal void
+stub_put(uint8_t* code, size_t* size, const void* bytes, size_t count) {
+    /* NOLINTNEXTLINE */
+    memcpy(code + *size, bytes, count);
+    *size += count;
+}
+
+/**
+ * @brief build a stub: save the argument registers (the first at the lowest address), call the
+ *  handler with its context and them, restore them, and jump to where the handler returned (the
+ *  return address is left for the callee).
+ *
+ * @param code the stub to be filled in.
+ * @param handler the handler.
+ * @param context the context of the handler.
+ * @return the size of the stub, or 0 if there are no stubs on this architecture.
+ */
+internal size_t
+stub_build(uint8_t* code, dispatch_handler_t handler, const void* context) {
+    size_t size = 0u;
+#if defined(__x86_64__)
+    /* push r10, rax, r9, r8, rcx, rdx, rsi, rdi; sub rsp, 8; lea rsi, [rsp + 8]; mov rdi, ctx. */
+    static const uint8_t save[] = { 0x41, 0x52, 0x50, 0x41, 0x51, 0x41, 0x50, 0x51, 0x52, 0x56,
+                                    0x57, 0x48, 0x83, 0xec, 0x08, 0x48, 0x8d, 0x74, 0x24, 0x08,
+                                    0x48, 0xbf };
+    /* call rax; mov r11, rax; add rsp, 8; pop rdi, rsi, rdx, rcx, r8, r9, rax, r10; jmp r11. */
+    static const uint8_t restore[] = { 0xff, 0xd0, 0x49, 0x89, 0xc3, 0x48, 0x83, 0xc4, 0x08,
+                                       0x5f, 0x5e, 0x5a, 0x59, 0x41, 0x58, 0x41, 0x59, 0x58,
+                                       0x41, 0x5a, 0x41, 0xff, 0xe3 };
+    uint64_t value = (uintptr_t) context, call = (uintptr_t) handler;
+    stub_put(code, &size, save, sizeof save);
+    stub_put(code, &size, &value, sizeof value);
+    stub_put(code, &size, (const uint8_t[]) { 0x48, 0xb8 }, 2u);
+    stub_put(code, &size, &call, sizeof call);
+    stub_put(code, &size, restore, sizeof restore);
+#elif defined(__i386__)
+    /* sub esp, 4 (where we go); push eax, ecx, edx; lea ecx, [esp + 20] (the arguments on the
+     *  stack); push ecx; push ctx; mov eax, handler. */
+    static const uint8_t save[] = { 0x83, 0xec, 0x04, 0x50, 0x51, 0x52, 0x8d, 0x4c, 0x24, 0x14,
+                                    0x51, 0x68 };
+    /* call eax; add esp, 8; mov [esp + 12], eax; pop edx, ecx, eax; ret (to where we go). */
+    static const uint8_t restore[] = { 0xff, 0xd0, 0x83, 0xc4, 0x08, 0x89, 0x44, 0x24, 0x0c,
+                                       0x5a, 0x59, 0x58, 0xc3 };
+    uint32_t value = (uintptr_t) context, call = (uintptr_t) handler;
+    stub_put(code, &size, save, sizeof save);
+    stub_put(code, &size, &value, sizeof value);
+    stub_put(code, &size, (const uint8_t[]) { 0xb8 }, 1u);
+    stub_put(code, &size, &call, sizeof call);
+    stub_put(code, &size, restore, sizeof restore);
+#elif defined(__aarch64__)
+    /* stp x0-x8, x30; mov x1, sp; ldr x0, ctx; ldr x16, handler; blr x16; mov x17, x0; ldp ...;
+     *  br x17. */
+    static const uint32_t insns[] = { 0xa9bb07e0, 0xa9010fe2, 0xa90217e4, 0xa9031fe6, 0xa9047be8,
+                                      0x910003e1, 0x58000140, 0x58000170, 0xd63f0200, 0xaa0003f1,
+                                      0xa9447be8, 0xa9431fe6, 0xa94217e4, 0xa9410fe2, 0xa8c507e0,
+                                      0xd61f0220 };
+    uint64_t value = (uintptr_t) context, call = (uintptr_t) handler;
+    stub_put(code, &size, insns, sizeof insns);
+    stub_put(code, &size, &value, sizeof value);
+    stub_put(code, &size, &call, sizeof call);
+#elif defined(__arm__)
+    /* push {r0-r3, r12, lr}; mov r1, sp; ldr r0, ctx; ldr r12, handler; blx r12; str r0, [sp, #16]
+     *  (r12); pop {r0-r3, r12, lr}; bx r12. */
+    static const uint32_t insns[] = { 0xe92d500f, 0xe1a0100d, 0xe59f0010, 0xe59fc010, 0xe12fff3c,
+                                      0xe58d0010, 0xe8bd500f, 0xe12fff1c };
+    uint32_t value = (uintptr_t) context, call = (uintptr_t) handler;
+    stub_put(code, &size, insns, sizeof insns);
+    stub_put(code, &size, &value, sizeof value);
+    stub_put(code, &size, &call, sizeof call);
+#else
+    (void) code;
+    (void) handler;
+    (void) context;
+#endif
+    return size;
+}
+
+/**
+ * @brief place a stub that calls a handler with the arguments of the call, and goes to the
+ *  function it returns; the stub lives until tramp_release().
+ *
+ * @param near the code the stub is to be near (a call site, or the target).
+ * @param handler the handler, which may only use general-purpose registers (DISPATCH_GPRS).
+ * @param context the context of the handler.
+ * @return the stub, or 0x0 if there are no stubs on this architecture or it couldn't be placed.
+ */
+void*
+dispatch_stub(const void* near, dispatch_handler_t handler, const void* context) {
+    uint8_t code[DISPATCH_STUB_MAX];
+    size_t size = stub_build(code, handler, context);
+    return size != 0u ? tramp_place(near, code, size) : 0x0;
+}
+
+/**
+ * @brief route every call to a target through a stub that calls the calling thread's mock of it,
+ *  or the target if the thread has none; the stub is built, and the calls are patched, once per
+ *  target, and stay until dispatch_release().
+ *
+ * @param target the target function.
+ * @param slot the slot of the target, to be filled in.
+ * @param routed the number of calls routed through the stub, to be filled in.
+ * @return ref. to intt.h for enum, fails if nothing calls the target, no call to it could be
+ *  routed, or there are no slots left.
+ */
+e_intt_result_t
+dispatch_route(void* target, size_t* slot, size_t* routed) {
+    pthread_mutex_lock(&l_lock);
+    for (size_t i = 0u; i < l_count; i++) {
+        if (l_targets[i].target == target) {
+            *slot = i;
+            *routed = l_targets[i].routed;
+            pthread_mutex_unlock(&l_lock);
+            return E_INTT_RESULT_SUCCESS;
+        }
+    }
+    if (l_count == DISPATCH_MAX) {
+        /* NOLINTNEXTLINE */
+        fprintf(stderr, "tapi, dispatch_route; every one of the %u slots is taken.\n",
+                DISPATCH_MAX);
+        pthread_mutex_unlock(&l_lock);
+        return E_INTT_RESULT_FAILURE;
+    }
+
+    /* the calls come from the index, which has to be built before anything is patched. */
+    sites_build();
+    size_t count;
+    const site_t* sites = sites_find(target, &count);
+    dispatch_t* dispatch = &l_targets[l_count];
+    dispatch->target = target;
+    dispatch->stub = count != 0u ? dispatch_stub(target, dispatch_lookup, dispatch) : 0x0;
+    if (dispatch->stub == 0x0) {
+        /* NOLINTNEXTLINE */
+        fprintf(stderr, "tapi, dispatch_route; no call to target found, or no stub could be "
+                        "placed.\n");
+        pthread_mutex_unlock(&l_lock);
+        return E_INTT_RESULT_FAILURE;
+    }
+
+    /* the stub is arm code, a thumb caller would need blx. */
+    patch_batch_t batch = { 0 };
+    for (size_t i = 0u; i < count; i++) {
+        if (!sites[i].call.is_thumb)
+            patch_batch_add(&batch, &sites[i].call, dispatch->stub);
+    }
+    size_t routable = batch.patches.length;
+    dispatch->sites = sites;
+    dispatch->count = count;
+    dispatch->routed = patch_batch_commit(&batch);
+    if (dispatch->routed == 0u) {
+        /* nothing was patched, so the slot is left free. */
+        /* NOLINTNEXTLINE */
+        fprintf(stderr, "tapi, dispatch_route; none of the %zu calls to target could be routed "
+                        "(thumb calls never are).\n", count);
+        pthread_mutex_unlock(&l_lock);
+        return E_INTT_RESULT_FAILURE;
+    }
+    if (dispatch->routed < count) {
+        /* NOLINTNEXTLINE */
+        fprintf(stderr, "tapi, dispatch_route; warning; %zu of the %zu calls to target aren't "
+                        "routed (%zu thumb), and always go to it.\n", count - dispatch->routed,
+                count, count - routable);
+    }
+    *slot = l_count++;
+    *routed = dispatch->routed;
+    pthread_mutex_unlock(&l_lock);
+    return E_INTT_RESULT_SUCCESS;
+}
+
+/**
+ * @brief set the mock of a target for the calling thread only.
+ *
+ * @param slot the slot of the target.
+ * @param mocked the function its calls go to on this thread, or 0x0 for the target itself.
+ * @return the mock it replaces, so stacked mocks can be unwound, or 0x0 if there was none.
+ */
+const void*
+dispatch_set(size_t slot, const void* mocked) {
+    if (slot >= DISPATCH_MAX)
+        return 0x0;
+    const void* previous = l_mocked[slot];
+    l_mocked[slot] = mocked;
+    return previous;
+}
+
+/** @brief patch every routed call back to its target; the stubs go with the trampolines. */
+void
+dispatch_release(void) {
+    pthread_mutex_lock(&l_lock);
+    patch_batch_t batch = { 0 };
+    for (size_t i = 0u; i < l_count; i++) {
+        for (size_t j = 0u; j < l_targets[i].count; j++) {
+            if (!l_targets[i].sites[j].call.is_thumb)
+                patch_batch_add(&batch, &l_targets[i].sites[j].call, l_targets[i].target);
+        }
+    }
+    patch_batch_commit(&batch);
+    l_count = 0u;
+    pthread_mutex_unlock(&l_lock);
+}
@@ -0,0 +1,83 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-10-19
+ */
+#ifndef DISPATCH_H
+#define DISPATCH_H
+
+/*! @uses size_t. */
+#include <stddef.h>
+
+/*! @uses uintptr_t. */
+#include <stdint.h>
+
+/*! @uses e_intt_result_t. */
+#include "intt.h"
+
+/* the most targets that can be dispatched per thread. */
+#define DISPATCH_MAX 64u
+
+/* the number of argument registers a stub saves (on i386, the first arguments on the stack). */
+#if defined(__aarch64__)
+#define DISPATCH_ARGS 8u
+#elif defined(__arm__)
+#define DISPATCH_ARGS 4u
+#else
+#define DISPATCH_ARGS 6u
+#endif
+
+/* a stub calls its handler with the arguments of the call still live, so it may only use the
+ *  registers the stub saves. */
+#if defined(__GNUC__) && !defined(__clang__) && (defined(__x86_64__) || defined(__i386__) || \
+    defined(__aarch64__))
+#define DISPATCH_GPRS __attribute__((target("general-regs-only")))
+#else
+#define DISPATCH_GPRS
+#endif
+
+/**
+ * the handler of a stub, called with its context and the DISPATCH_ARGS saved arguments of the
+ *  call; it returns the function the call goes to.
+ */
+typedef const void* (*dispatch_handler_t)(const void* context, const uintptr_t* args);
+
+/**
+ * @brief place a stub that calls a handler with the arguments of the call, and goes to the
+ *  function it returns; the stub lives until tramp_release().
+ *
+ * @param near the code the stub is to be near (a call site, or the target).
+ * @param handler the handler, which may only use general-purpose registers (DISPATCH_GPRS).
+ * @param context the context of the handler.
+ * @return the stub, or 0x0 if there are no stubs on this architecture or it couldn't be placed.
+ */
+void*
+dispatch_stub(const void* near, dispatch_handler_t handler, const void* context);
+
+/**
+ * @brief route every call to a target through a stub that calls the calling thread's mock of it,
+ *  or the target if the thread has none; the stub is built, and the calls are patched, once per
+ *  target, and stay until dispatch_release().
+ *
+ * @param target the target function.
+ * @param slot the slot of the target, to be filled in.
+ * @param routed the number of calls routed through the stub, to be filled in.
+ * @return ref. to intt.h for enum, fails if nothing calls the target, no call to it could be
+ *  routed, or there are no slots left.
+ */
+e_intt_result_t
+dispatch_route(void* target, size_t* slot, size_t* routed);
+
+/**
+ * @brief set the mock of a target for the calling thread only.
+ *
+ * @param slot the slot of the target.
+ * @param mocked the function its calls go to on this thread, or 0x0 for the target itself.
+ * @return the mock it replaces, so stacked mocks can be unwound, or 0x0 if there was none.
+ */
+const void*
+dispatch_set(size_t slot, const void* mocked);
+
+/** @brief patch every routed call back to its target; the stubs go with the trampolines. */
+void
+dispatch_release(void);
+#endif /* DISPATCH_H */
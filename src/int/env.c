@@ -0,0 +1,239 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-10-19
+ */
+/* we have to define this to use sched_setaffinity(), sched_getcpu(), and CPU_SET(). */
+#define _GNU_SOURCE
+
+#include "env.h"
+
+/*! @uses fprintf, fopen, fgets, fscanf, stderr. */
+#include <stdio.h>
+
+/*! @uses memcpy, strnlen, strcspn, strcmp, strchr. */
+#include <string.h>
+
+/*! @uses sched_setaffinity, sched_getaffinity, sched_setscheduler, sched_getcpu. */
+#include <sched.h>
+
+/*! @uses pthread_self, pthread_setaffinity_np. */
+#include <pthread.h>
+
+/*! @uses mlockall, munlockall. */
+#include <sys/mman.h>
+
+/*! @uses sysconf, _SC_NPROCESSORS_ONLN. */
+#include <unistd.h>
+
+/*! @uses errno. */
+#include <errno.h>
+
+/*! @uses internal. */
+#include "intt.h"
+
+/**
+ * @brief read the first line of a (sysfs/ procfs) file, without the newline.
+ *
+ * @param path the path of the file.
+ * @param line the buffer to read into.
+ * @param size the size of the buffer.
+ * @return ref. to intt.h for enum.
+ */
+internal e_intt_result_t
+read_line(const char* path, char* line, size_t size) {
+    FILE* file = fopen(path, "r");
+    if (file == 0x0)
+        return E_INTT_RESULT_FAILURE;
+    char* result = fgets(line, (int) size, file);
+    fclose(file);
+    if (result == 0x0)
+        return E_INTT_RESULT_FAILURE;
+    line[strcspn(line, "\n")] = 0x0;
+    return E_INTT_RESULT_SUCCESS;
+}
+
+/**
+ * @brief pin the calling thread to a cpu, and optionally raise it to SCHED_FIFO and lock
+ *  memory; what could be applied is recorded in the environment flags.
+ *
+ * @param cpu the cpu to pin to, or -1 to not pin.
+ * @param flags the extra isolation to apply, see e_tapi_bench_isolate_t.
+ * @param env the environment to record the applied isolation into.
+ * @param saved the state to be restored by env_restore().
+ */
+void
+env_isolate(int cpu, unsigned int flags, tapi_bench_env_t* env, env_saved_t* saved) {
+    /* pin to the cpu, keeping the old mask. */
+    if (cpu >= 0) {
+        cpu_set_t old, set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        if (sched_getaffinity(0, sizeof old, &old) == 0 && sched_setaffinity(0, sizeof set,
+                                                                             &set) == 0) {
+            /* NOLINTNEXTLINE */
+            memcpy(saved->mask, &old, sizeof old < sizeof saved->mask ? sizeof old :
+                   sizeof saved->mask);
+            saved->has_mask = true;
+            env->flags |= E_TAPI_BENCH_ENV_PINNED;
+        }
+        else {
+            /* NOLINTNEXTLINE */
+            fprintf(stderr, "tapi, bench_run; sched_setaffinity failed; could not pin to cpu %d. "
+                            "errno: %d\n", cpu, errno);
+        }
+    }
+
+    /* real-time scheduling; half of the maximum priority so we cannot starve the kernel. */
+    if (flags & E_TAPI_BENCH_ISOLATE_FIFO) {
+        struct sched_param old, param = { .sched_priority = sched_get_priority_max(SCHED_FIFO) / 2 };
+        saved->policy = sched_getscheduler(0);
+        sched_getparam(0, &old);
+        saved->priority = old.sched_priority;
+        if (saved->policy != -1 && sched_setscheduler(0, SCHED_FIFO, &param) == 0) {
+            saved->has_policy = true;
+            env->flags |= E_TAPI_BENCH_ENV_FIFO;
+        }
+        else {
+            /* NOLINTNEXTLINE */
+            fprintf(stderr, "tapi, bench_run; sched_setscheduler failed; could not use SCHED_FIFO "
+                            "(needs CAP_SYS_NICE). errno: %d\n", errno);
+        }
+    }
+
+    /* lock memory so page faults do not land in a sample. */
+    if (flags & E_TAPI_BENCH_ISOLATE_MLOCK) {
+        if (mlockall(MCL_CURRENT | MCL_FUTURE) == 0) {
+            saved->has_mlock = true;
+            env->flags |= E_TAPI_BENCH_ENV_MLOCK;
+        }
+        else {
+            /* NOLINTNEXTLINE */
+            fprintf(stderr, "tapi, bench_run; mlockall failed; could not lock memory "
+                            "(RLIMIT_MEMLOCK?). errno: %d\n", errno);
+        }
+    }
+}
+
+/**
+ * @brief pin the calling thread (not the whole process) to a single cpu.
+ *
+ * @param cpu the cpu to pin to.
+ * @return ref. to intt.h for enum.
+ */
+e_intt_result_t
+env_pin_thread(int cpu) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if (pthread_setaffinity_np(pthread_self(), sizeof set, &set) != 0)
+        return E_INTT_RESULT_FAILURE;
+    return E_INTT_RESULT_SUCCESS;
+}
+
+/**
+ * @brief undo everything env_isolate() applied.
+ *
+ * @param saved the state saved by env_isolate().
+ */
+void
+env_restore(env_saved_t* saved) {
+    if (saved->has_mlock)
+        munlockall();
+    if (saved->has_policy) {
+        struct sched_param param = { .sched_priority = saved->priority };
+        sched_setscheduler(0, saved->policy, &param);
+    }
+    if (saved->has_mask) {
+        cpu_set_t old;
+        /* NOLINTNEXTLINE */
+        memcpy(&old, saved->mask, sizeof old < sizeof saved->mask ? sizeof old :
+               sizeof saved->mask);
+        sched_setaffinity(0, sizeof old, &old);
+    }
+    *saved = (env_saved_t) { 0 };
+}
+
+/**
+ * @brief probe the sources of noise on the cpu we are running on (governor, turbo, smt
+ *  siblings, and load) and record them into the environment.
+ *
+ * @param env the environment to record into, the isolation flags are kept.
+ */
+void
+env_probe(tapi_bench_env_t* env) {
+    env->flags &= E_TAPI_BENCH_ENV_PINNED | E_TAPI_BENCH_ENV_FIFO | E_TAPI_BENCH_ENV_MLOCK;
+    env->cpu = sched_getcpu();
+    char path[128u], line[256u];
+
+    /* the frequency governor of our cpu. */
+    env->governor[0] = 0x0;
+    /* NOLINTNEXTLINE */
+    snprintf(path, sizeof path, "/sys/devices/system/cpu/cpu%d/cpufreq/scaling_governor",
+             env->cpu < 0 ? 0 : env->cpu);
+    if e_intt_passed(read_line(path, line, sizeof line)) {
+        size_t length = strnlen(line, sizeof env->governor - 1u);
+        /* NOLINTNEXTLINE */
+        memcpy(env->governor, line, length);
+        env->governor[length] = 0x0;
+        if (strcmp(line, "performance") != 0)
+            env->flags |= E_TAPI_BENCH_ENV_GOVERNOR;
+    }
+
+    /* turbo; intel_pstate reports it inverted, acpi-cpufreq and amd report boost. */
+    if e_intt_passed(read_line("/sys/devices/system/cpu/intel_pstate/no_turbo", line,
+                               sizeof line)) {
+        if (strcmp(line, "0") == 0)
+            env->flags |= E_TAPI_BENCH_ENV_TURBO;
+    }
+    else if e_intt_passed(read_line("/sys/devices/system/cpu/cpufreq/boost", line, sizeof line)) {
+        if (strcmp(line, "1") == 0)
+            env->flags |= E_TAPI_BENCH_ENV_TURBO;
+    }
+
+    /* smt; our cpu has a sibling if its sibling list names more than one cpu. */
+    /* NOLINTNEXTLINE */
+    snprintf(path, sizeof path, "/sys/devices/system/cpu/cpu%d/topology/thread_siblings_list",
+             env->cpu < 0 ? 0 : env->cpu);
+    if e_intt_passed(read_line(path, line, sizeof line)) {
+        if (strchr(line, ',') != 0x0 || strchr(line, '-') != 0x0)
+            env->flags |= E_TAPI_BENCH_ENV_SMT;
+    }
+
+    /* load; we count ourselves as one runnable task, anything past a quarter of the cpus
+     *  on top of that is other work competing with us. */
+    env->load = 0.0;
+    if e_intt_passed(read_line("/proc/loadavg", line, sizeof line)) {
+        /* NOLINTNEXTLINE */
+        sscanf(line, "%lf", &env->load);
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        if (env->load - 1.0 > (double)(cpus > 0 ? cpus : 1) * 0.25)
+            env->flags |= E_TAPI_BENCH_ENV_LOADED;
+    }
+}
+
+/**
+ * @brief print a warning for every source of noise recorded in an environment.
+ *
+ * @param env the environment to warn about.
+ */
+void
+env_warn(const tapi_bench_env_t* env) {
+    if (env->flags & E_TAPI_BENCH_ENV_GOVERNOR) {
+        /* NOLINTNEXTLINE */
+        fprintf(stderr, "tapi, bench_run; warning; cpu %d governor is '%s', not 'performance'.\n",
+                env->cpu, env->governor);
+    }
+    if (env->flags & E_TAPI_BENCH_ENV_TURBO) {
+        /* NOLINTNEXTLINE */
+        fprintf(stderr, "tapi, bench_run; warning; turbo/ boost frequencies are enabled.\n");
+    }
+    if (env->flags & E_TAPI_BENCH_ENV_SMT) {
+        /* NOLINTNEXTLINE */
+        fprintf(stderr, "tapi, bench_run; warning; cpu %d has an active smt sibling.\n", env->cpu);
+    }
+    if (env->flags & E_TAPI_BENCH_ENV_LOADED) {
+        /* NOLINTNEXTLINE */
+        fprintf(stderr, "tapi, bench_run; warning; machine is loaded (load average %.2f).\n",
+                env->load);
+    }
+}
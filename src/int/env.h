@@ -0,0 +1,69 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-10-19
+ */
+#ifndef ENV_H
+#define ENV_H
+
+/*! @uses bool. */
+#include <stdbool.h>
+
+/*! @uses tapi_bench_env_t. */
+#include <tapi/bench.h>
+
+/*! @uses e_intt_result_t. */
+#include "intt.h"
+
+/** a data structure for the process state changed by env_isolate(), to be restored. */
+typedef struct {
+    bool has_mask, has_policy, has_mlock; /* what was changed? */
+    unsigned char mask[128u]; /* original cpu affinity mask (cpu_set_t). */
+    int policy, priority; /* original scheduling policy and priority. */
+} env_saved_t;
+
+/**
+ * @brief pin the calling thread to a cpu, and optionally raise it to SCHED_FIFO and lock
+ *  memory; what could be applied is recorded in the environment flags.
+ *
+ * @param cpu the cpu to pin to, or -1 to not pin.
+ * @param flags the extra isolation to apply, see e_tapi_bench_isolate_t.
+ * @param env the environment to record the applied isolation into.
+ * @param saved the state to be restored by env_restore().
+ */
+void
+env_isolate(int cpu, unsigned int flags, tapi_bench_env_t* env, env_saved_t* saved);
+
+/**
+ * @brief pin the calling thread (not the whole process) to a single cpu.
+ *
+ * @param cpu the cpu to pin to.
+ * @return ref. to intt.h for enum.
+ */
+e_intt_result_t
+env_pin_thread(int cpu);
+
+/**
+ * @brief undo everything env_isolate() applied.
+ *
+ * @param saved the state saved by env_isolate().
+ */
+void
+env_restore(env_saved_t* saved);
+
+/**
+ * @brief probe the sources of noise on the cpu we are running on (governor, turbo, smt
+ *  siblings, and load) and record them into the environment.
+ *
+ * @param env the environment to record into, the isolation flags are kept.
+ */
+void
+env_probe(tapi_bench_env_t* env);
+
+/**
+ * @brief print a warning for every source of noise recorded in an environment.
+ *
+ * @param env the environment to warn about.
+ */
+void
+env_warn(const tapi_bench_env_t* env);
+#endif /* ENV_H */
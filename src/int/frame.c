@@ -0,0 +1,153 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-10-19
+ */
+#include "frame.h"
+
+/*! @uses memset, memcpy, strlen, strcmp. */
+#include <string.h>
+
+/*! @uses uint64_t. */
+#include <stdint.h>
+
+/*! @uses pthread_mutex_t, pthread_mutex_lock, pthread_mutex_unlock. */
+#include <pthread.h>
+
+/*! @uses tapi_arena_t, tapi_arena_make, tapi_arena_alloc, tapi_arena_destroy. */
+#include <tapi/arena.h>
+
+/*! @uses internal. */
+#include "intt.h"
+
+/*
+ * the internal arena, and the open-addressing table of interned names within it; mocks can be
+ *  made from any thread, so both are only touched under the lock.
+ */
+static pthread_mutex_t l_lock = PTHREAD_MUTEX_INITIALIZER;
+static tapi_arena_t* l_frame;
+static struct {
+    char** slots;
+    size_t count, capacity;
+} l_names;
+
+/**
+ * @brief allocate zeroed memory from the internal arena, with the lock held.
+ *
+ * @param size the number of bytes.
+ * @return a pointer to the memory, or 0x0 if the arena could not grow.
+ */
+internal void*
+alloc_locked(size_t size) {
+    /* smaller chunks than the default, most suites only need a few pages. */
+    if (l_frame == 0x0)
+        l_frame = tapi_arena_make(64u * 1024u);
+    void* memory = tapi_arena_alloc(l_frame, size);
+    if (memory != 0x0) {
+        /* NOLINTNEXTLINE */
+        memset(memory, 0, size);
+    }
+    return memory;
+}
+
+/**
+ * @brief allocate zeroed memory for the framework's own bookkeeping (tests, mocks, ...); it
+ *  lives in an internal arena until frame_release().
+ *
+ * @param size the number of bytes.
+ * @return a pointer to the memory, or 0x0 if the arena could not grow.
+ */
+void*
+frame_alloc(size_t size) {
+    pthread_mutex_lock(&l_lock);
+    void* memory = alloc_locked(size);
+    pthread_mutex_unlock(&l_lock);
+    return memory;
+}
+
+/**
+ * @brief fnv-1a hash of a name.
+ *
+ * @param name the name to be hashed.
+ * @return the hash of the name.
+ */
+internal uint64_t
+hash_name(const char* name) {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (const unsigned char* c = (const unsigned char*) name; *c; c++)
+        hash = (hash ^ *c) * 0x100000001b3ull;
+    return hash;
+}
+
+/**
+ * @brief find the slot of a name, or the empty slot it would go in.
+ *
+ * @param slots the table to be searched.
+ * @param capacity the capacity of the table (a power of two).
+ * @param name the name to be searched for.
+ * @return the slot.
+ */
+internal char**
+find_slot(char** slots, size_t capacity, const char* name) {
+    size_t i = (size_t) hash_name(name) & (capacity - 1u);
+    while (slots[i] != 0x0 && strcmp(slots[i], name) != 0)
+        i = (i + 1u) & (capacity - 1u);
+    return &slots[i];
+}
+
+/**
+ * @brief intern a name into the internal arena; equal names share a single copy.
+ *
+ * @param name the name to be interned.
+ * @return the interned copy of the name.
+ */
+char*
+frame_intern(const char* name) {
+    pthread_mutex_lock(&l_lock);
+    char* copy = 0x0;
+
+    /* grow the table at 3/4 load; the old table is left in the arena. */
+    if ((l_names.count + 1u) * 4u > l_names.capacity * 3u) {
+        size_t capacity = l_names.capacity ? l_names.capacity * 2u : 64u;
+        char** slots = alloc_locked(capacity * sizeof *slots);
+        if (slots == 0x0)
+            goto done;
+        for (size_t i = 0u; i < l_names.capacity; i++)
+            if (l_names.slots[i] != 0x0)
+                *find_slot(slots, capacity, l_names.slots[i]) = l_names.slots[i];
+        l_names.slots = slots;
+        l_names.capacity = capacity;
+    }
+
+    /* the name is already interned? */
+    char** slot = find_slot(l_names.slots, l_names.capacity, name);
+    if (*slot != 0x0) {
+        copy = *slot;
+        goto done;
+    }
+
+    /* o.w. copy it, including the nul terminator. */
+    size_t length = strlen(name);
+    copy = alloc_locked(length + 1u);
+    if (copy != 0x0) {
+        /* NOLINTNEXTLINE */
+        memcpy(copy, name, length + 1u);
+        *slot = copy;
+        l_names.count++;
+    }
+done:
+    pthread_mutex_unlock(&l_lock);
+    return copy;
+}
+
+/** @brief release the internal arena at once, everything allocated from it is gone. */
+void
+frame_release(void) {
+    pthread_mutex_lock(&l_lock);
+    if (l_frame != 0x0) {
+        tapi_arena_destroy(l_frame);
+        l_frame = 0x0;
+        l_names.slots = 0x0;
+        l_names.count = l_names.capacity = 0u;
+    }
+    pthread_mutex_unlock(&l_lock);
+}
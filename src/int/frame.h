@@ -0,0 +1,33 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-10-19
+ */
+#ifndef FRAME_H
+#define FRAME_H
+
+/*! @uses size_t. */
+#include <stddef.h>
+
+/**
+ * @brief allocate zeroed memory for the framework's own bookkeeping (tests, mocks, ...); it
+ *  lives in an internal arena until frame_release().
+ *
+ * @param size the number of bytes.
+ * @return a pointer to the memory, or 0x0 if the arena could not grow.
+ */
+void*
+frame_alloc(size_t size);
+
+/**
+ * @brief intern a name into the internal arena; equal names share a single copy.
+ *
+ * @param name the name to be interned.
+ * @return the interned copy of the name.
+ */
+char*
+frame_intern(const char* name);
+
+/** @brief release the internal arena at once, everything allocated from it is gone. */
+void
+frame_release(void);
+#endif /* FRAME_H */
@@ -0,0 +1,191 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-10-19
+ */
+#define _GNU_SOURCE
+#include "got.h"
+
+/*! @uses dl_iterate_phdr, struct dl_phdr_info, ElfW. */
+#include <link.h>
+
+/*! @uses PT_DYNAMIC, PT_LOAD, DT_*, R_*_JUMP_SLOT, R_*_GLOB_DAT. */
+#include <elf.h>
+
+/*! @uses dlsym, RTLD_DEFAULT. */
+#include <dlfcn.h>
+
+/*! @uses strcmp. */
+#include <string.h>
+
+/*! @uses uintptr_t, UINTPTR_MAX. */
+#include <stdint.h>
+
+/* the relocations that fill in a got slot with the address of a function. */
+#if defined(__x86_64__)
+#define GOT_JUMP_SLOT R_X86_64_JUMP_SLOT
+#define GOT_GLOB_DAT R_X86_64_GLOB_DAT
+#elif defined(__i386__)
+#define GOT_JUMP_SLOT R_386_JMP_SLOT
+#define GOT_GLOB_DAT R_386_GLOB_DAT
+#elif defined(__aarch64__)
+#define GOT_JUMP_SLOT R_AARCH64_JUMP_SLOT
+#define GOT_GLOB_DAT R_AARCH64_GLOB_DAT
+#elif defined(__arm__)
+#define GOT_JUMP_SLOT R_ARM_JUMP_SLOT
+#define GOT_GLOB_DAT R_ARM_GLOB_DAT
+#endif
+
+/* r_info is split differently by each class. */
+#if UINTPTR_MAX > 0xffffffffu
+#define GOT_R_SYM ELF64_R_SYM
+#define GOT_R_TYPE ELF64_R_TYPE
+#else
+#define GOT_R_SYM ELF32_R_SYM
+#define GOT_R_TYPE ELF32_R_TYPE
+#endif
+
+/** what find_object() is given. */
+typedef struct {
+    const char* symbol;
+    got_slots_t* slots;
+} got_search_t;
+
+/** the tables of the dynamic section of an object that relocations are read from. */
+typedef struct {
+    const ElfW(Sym)* symbols;
+    const char* strings;
+    uintptr_t jmprel, rela, rel;
+    size_t jmprel_size, rela_size, rel_size;
+    bool jmprel_is_rela;
+} got_tables_t;
+
+/**
+ * @brief the address of a pointer in the dynamic section; glibc relocates them in place, others
+ *  (and some architectures) leave them relative to the object.
+ *
+ * @param base the address the object is loaded at.
+ * @param pointer the pointer.
+ * @return the address.
+ */
+internal uintptr_t
+dynamic_address(uintptr_t base, uintptr_t pointer) {
+    return pointer < base ? base + pointer : pointer;
+}
+
+/**
+ * @brief collect the slots of a table of relocations that are filled in with the function.
+ *
+ * @param search the search.
+ * @param base the address the object is loaded at.
+ * @param tables the tables of the object.
+ * @param table the relocations.
+ * @param size the size of the relocations.
+ * @param stride the size of a relocation (Rel, or Rela, which starts with the same fields).
+ */
+internal void
+collect_slots(got_search_t* search, uintptr_t base, const got_tables_t* tables, uintptr_t table,
+              size_t size, size_t stride) {
+    for (size_t at = 0u; table != 0u && at + stride <= size; at += stride) {
+        const ElfW(Rel)* relocation = (const ElfW(Rel)*)(table + at);
+        size_t type = GOT_R_TYPE(relocation->r_info), index = GOT_R_SYM(relocation->r_info);
+        if ((type != GOT_JUMP_SLOT && type != GOT_GLOB_DAT) || index == 0u)
+            continue;
+        if (strcmp(tables->strings + tables->symbols[index].st_name, search->symbol) != 0)
+            continue;
+
+        /* DT_RELA can overlap DT_JMPREL, each slot is only kept once. */
+        void** slot = (void**)(base + relocation->r_offset);
+        bool seen = false;
+        _vforeach(search->slots, void**, kept)
+            seen |= kept == slot;
+        _endforeach;
+        if (!seen)
+            got_slots_push(search->slots, slot);
+    }
+}
+
+/**
+ * @brief collect the got slots of the function from a loaded object.
+ *
+ * @param info the object.
+ * @param size the size of info.
+ * @param data the got_search_t.
+ * @return 0, to keep iterating.
+ */
+internal int
+find_object(struct dl_phdr_info* info, size_t size, void* data) {
+    (void) size;
+    got_search_t* search = data;
+    uintptr_t base = (uintptr_t) info->dlpi_addr, self = (uintptr_t) &find_object;
+
+    /* find the dynamic section, skipping tapi itself (unless it is linked into the executable);
+     *  its own calls are never mocked. */
+    bool is_executable = info->dlpi_name == 0x0 || info->dlpi_name[0] == '\0';
+    const ElfW(Dyn)* dynamic = 0x0;
+    for (size_t i = 0u; i < info->dlpi_phnum; i++) {
+        const ElfW(Phdr)* header = &info->dlpi_phdr[i];
+        if (header->p_type == PT_DYNAMIC)
+            dynamic = (const ElfW(Dyn)*)(base + header->p_vaddr);
+        else if (header->p_type == PT_LOAD && !is_executable && self >= base + header->p_vaddr &&
+                 self < base + header->p_vaddr + header->p_memsz)
+            return 0;
+    }
+    if (dynamic == 0x0)
+        return 0;
+
+    /* the tables the relocations are read from. */
+    got_tables_t tables = { 0 };
+    for (const ElfW(Dyn)* entry = dynamic; entry->d_tag != DT_NULL; entry++) {
+        uintptr_t pointer = (uintptr_t) entry->d_un.d_ptr;
+        switch (entry->d_tag) {
+            case DT_SYMTAB:
+                tables.symbols = (const ElfW(Sym)*) dynamic_address(base, pointer);
+                break;
+            case DT_STRTAB:
+                tables.strings = (const char*) dynamic_address(base, pointer);
+                break;
+            case DT_JMPREL: tables.jmprel = dynamic_address(base, pointer); break;
+            case DT_RELA: tables.rela = dynamic_address(base, pointer); break;
+            case DT_REL: tables.rel = dynamic_address(base, pointer); break;
+            case DT_PLTRELSZ: tables.jmprel_size = entry->d_un.d_val; break;
+            case DT_RELASZ: tables.rela_size = entry->d_un.d_val; break;
+            case DT_RELSZ: tables.rel_size = entry->d_un.d_val; break;
+            case DT_PLTREL: tables.jmprel_is_rela = entry->d_un.d_val == DT_RELA; break;
+            default: break;
+        }
+    }
+    if (tables.symbols == 0x0 || tables.strings == 0x0)
+        return 0;
+    collect_slots(search, base, &tables, tables.jmprel, tables.jmprel_size,
+                  tables.jmprel_is_rela ? sizeof(ElfW(Rela)) : sizeof(ElfW(Rel)));
+    collect_slots(search, base, &tables, tables.rela, tables.rela_size, sizeof(ElfW(Rela)));
+    collect_slots(search, base, &tables, tables.rel, tables.rel_size, sizeof(ElfW(Rel)));
+    return 0;
+}
+
+/**
+ * @brief find every got slot a function is called through, from the relocations (DT_JMPREL,
+ *  DT_RELA and DT_REL) of the executable and every loaded shared object but tapi itself.
+ *
+ * @param symbol the name of the function.
+ * @param slots the slots to push onto.
+ * @return ref. to intt.h for enum, fails if there are none.
+ */
+e_intt_result_t
+got_find(const char* symbol, got_slots_t* slots) {
+    got_search_t search = { symbol, slots };
+    size_t before = slots->length;
+    dl_iterate_phdr(find_object, &search);
+    return slots->length != before ? E_INTT_RESULT_SUCCESS : E_INTT_RESULT_FAILURE;
+}
+
+/**
+ * @brief resolve a function by name, as the dynamic linker would for the executable.
+ *
+ * @param symbol the name of the function.
+ * @return the address of the function, or 0x0.
+ */
+void*
+got_resolve(const char* symbol) {
+    return dlsym(RTLD_DEFAULT, symbol);
+}
@@ -0,0 +1,39 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-10-19
+ */
+#ifndef GOT_H
+#define GOT_H
+
+/*! @uses size_t. */
+#include <stddef.h>
+
+/*! @uses dyna_define. */
+#include <tapi/dyna.h>
+
+/*! @uses e_intt_result_t. */
+#include "intt.h"
+
+/* a typed vector of got slots. */
+dyna_define(got_slots, void**, 4u)
+
+/**
+ * @brief find every got slot a function is called through, from the relocations (DT_JMPREL,
+ *  DT_RELA and DT_REL) of the executable and every loaded shared object but tapi itself.
+ *
+ * @param symbol the name of the function.
+ * @param slots the slots to push onto.
+ * @return ref. to intt.h for enum, fails if there are none.
+ */
+e_intt_result_t
+got_find(const char* symbol, got_slots_t* slots);
+
+/**
+ * @brief resolve a function by name, as the dynamic linker would for the executable.
+ *
+ * @param symbol the name of the function.
+ * @return the address of the function, or 0x0.
+ */
+void*
+got_resolve(const char* symbol);
+#endif /* GOT_H */
@@ -4,13 +4,19 @@
  */
 #include "guard.h"
 
-/*! @uses calloc. */
+/*! @uses strtoull. */
 #include <stdlib.h>
 
+/*! @uses strchr, memmove. */
+#include <string.h>
+
+/*! @uses open, O_RDONLY. */
+#include <fcntl.h>
+
 /*! @uses uintptr_t. */
 #include <stdint.h>
 
-/*! @uses sysconf, _SC_PAGE_SIZE. */
+/*! @uses sysconf, _SC_PAGE_SIZE, read, close. */
 #include <unistd.h>
 
 /*! @uses mprotect. */
@@ -23,11 +29,15 @@
 #include "intt.h"
 
 /** @return page size on the given architecture, winapi and posix. */
-internal size_t
-get_page_size() {
+size_t
+guard_page_size(void) {
 #ifndef _WIN32
-    long value = sysconf(_SC_PAGESIZE);
-    return value > 0 ? (size_t)value : 4096u;
+    static size_t size;
+    if (size == 0u) {
+        long value = sysconf(_SC_PAGESIZE);
+        size = value > 0 ? (size_t)value : 4096u;
+    }
+    return size;
 #else
     SYSTEM_INFO si{};
     GetSystemInfo(&si);
@@ -45,61 +55,157 @@ internal void*
 page_align_down(void* page, size_t size) {
     return (void*)((uintptr_t)page & ~(size - 1));
 }
+
 /**
- * @brief create a write-protect guard for an address in memory.
+ * @brief read the mappings of the process and their protection, once for any number of guards;
+ *  the first 128 are kept without allocating.
  *
- * @param address the address to be given write protection in memory.
- * @param length the length of bytes to be protected.
- * @return an allocated pguard_t structure.
+ * @param maps the mappings to be filled in, freed with guard_maps_free().
+ * @return ref. to intt.h for enum.
  */
-guard_t*
-guard_create(void* address, size_t length) {
-    /* allocate. */
-    guard_t* guard = calloc(1, sizeof *guard);
+e_intt_result_t
+guard_maps_read(guard_maps_t* maps) {
+#ifndef _WIN32
+    int fd = open("/proc/self/maps", O_RDONLY);
+    if (fd < 0)
+        return E_INTT_RESULT_FAILURE;
+
+    /* lines are "start-end perms ...", we only need the first two fields. */
+    char buffer[4096u];
+    size_t held = 0u;
+    for (;;) {
+        ssize_t got = read(fd, buffer + held, sizeof buffer - held - 1u);
+        if (got <= 0)
+            break;
+        held += (size_t) got;
+        buffer[held] = '\0';
+
+        /* every complete line. */
+        char* line = buffer;
+        char* end;
+        while ((end = strchr(line, '\n')) != 0x0) {
+            char* cursor;
+            guard_map_t map = { 0 };
+            map.start = (uintptr_t) strtoull(line, &cursor, 16);
+            map.end = (uintptr_t) strtoull(cursor + 1, &cursor, 16);
+            map.flags = (cursor[1] == 'r' ? PROT_READ : 0) | (cursor[2] == 'w' ? PROT_WRITE : 0) |
+                        (cursor[3] == 'x' ? PROT_EXEC : 0);
+            guard_maps_push(maps, map);
+            line = end + 1;
+        }
 
-    /* allow write protection on those pages. */
+        /* keep the partial line for the next read. */
+        held = (size_t)(buffer + held - line);
+        /* NOLINTNEXTLINE */
+        memmove(buffer, line, held);
+    }
+    close(fd);
+    return maps->length != 0u ? E_INTT_RESULT_SUCCESS : E_INTT_RESULT_FAILURE;
+#else
+    (void) maps;
+    return E_INTT_RESULT_FAILURE;
+#endif
+}
+
+/**
+ * @brief make a part of a range writable, keeping the flags it had.
+ *
+ * @param guards the guards to push the part onto.
+ * @param start the page-aligned start of the part.
+ * @param end the page-aligned end of the part.
+ * @param flags the protection the part has.
+ * @return ref. to intt.h for enum.
+ */
+internal e_intt_result_t
+open_part(guard_list_t* guards, uintptr_t start, uintptr_t end, size_t flags) {
+    guard_t guard = { (void*) start, (size_t)(end - start), flags };
 #ifndef _WIN32
-    /* we find the relative page bounds. */
-    guard->address = page_align_down(address, get_page_size());
-    guard->length = length;
     /* NOLINTNEXTLINE */
-    if (mprotect(guard->address, guard->length, PROT_READ | PROT_WRITE | PROT_EXEC) != 0x0) {
+    if (mprotect(guard.address, guard.length, (int)(flags | PROT_WRITE)) != 0x0) {
         /* NOLINTNEXTLINE */
-        fprintf(stderr, "tapi, guard_create; mprotect failed; could not allocate memory for pguard"
-                        ".");
+        fprintf(stderr, "tapi, guard_open; mprotect failed; could not make %zu bytes at %p "
+                        "writable.\n", guard.length, guard.address);
 #else
-    /* winapi doesn't care and does it for us. */
-    guard->address = address;
-    guard->length = length;
-    if (VirtualProtect(guard->address, length, PAGE_EXECUTE_READWRITE, &guard->flags) !=
-        0x0) {
+    /* winapi hands us the old protection. */
+    DWORD old;
+    if (VirtualProtect(guard.address, guard.length, PAGE_EXECUTE_READWRITE, &old) == 0x0) {
         /* we can actually use MSVCs "safe" version for fprintf. */
-        fprintf_s(stderr, "tapi, guard_create; VirtualProtect failed; could not allocate memory "
-                          "for pguard.");
+        fprintf_s(stderr, "tapi, guard_open; VirtualProtect failed; could not make memory "
+                          "writable.\n");
 #endif
-        return 0x0;
+        return E_INTT_RESULT_FAILURE;
     }
-    return guard;
+#ifdef _WIN32
+    guard.flags = old;
+#endif
+    guard_list_push(guards, guard);
+    return E_INTT_RESULT_SUCCESS;
 }
 
 /**
- * @brief close/ restore the write-protect guard.
+ * @brief make an address range writable, over every page it touches, with a guard per mapping
+ *  it spans, each keeping the protection of its own mapping to be restored by guard_close().
  *
- * @param guard the guard to be closed/ restored.
+ * @param guards the guards to be filled in.
+ * @param address the address to be given write protection in memory.
+ * @param length the length of bytes to be protected.
+ * @param maps the mappings, as read by guard_maps_read(); without them, the range is taken to
+ *  be code (read and exec).
+ * @return ref. to intt.h for enum.
  */
-void
-guard_close(guard_t* guard) {
-    /* remove write protection on the pages. */
-#ifndef _WIN32
-    if (mprotect(guard->address, guard->length, PROT_READ | PROT_EXEC) != 0x0) {
+e_intt_result_t
+guard_open(guard_list_t* guards, void* address, size_t length, const guard_maps_t* maps) {
+    /* we find the page bounds of the whole range. */
+    size_t page = guard_page_size();
+    uintptr_t start = (uintptr_t) page_align_down(address, page);
+    uintptr_t end = ((uintptr_t) address + length + page - 1u) & ~(uintptr_t)(page - 1u);
+    if (maps == 0x0 || maps->length == 0u)
+        return open_part(guards, start, end, PROT_READ | PROT_EXEC);
+
+    /* a part per mapping, every page of the range has to be mapped. */
+    _vforeach(maps, guard_map_t, map)
+        if (map.end <= start)
+            continue;
+        if (map.start > start || start == end)
+            break;
+        uintptr_t stop = map.end < end ? map.end : end;
+        if (!e_intt_passed(open_part(guards, start, stop, map.flags))) {
+            guard_close(guards);
+            return E_INTT_RESULT_FAILURE;
+        }
+        start = stop;
+    _endforeach;
+    if (start < end) {
         /* NOLINTNEXTLINE */
-        fprintf(stderr, "tapi, guard_close; mprotect failed; could not close pguard.");
+        fprintf(stderr, "tapi, guard_open; no mapping at %p; could not make it writable.\n",
+                (void*) start);
+        guard_close(guards);
+        return E_INTT_RESULT_FAILURE;
     }
+    return E_INTT_RESULT_SUCCESS;
+}
+
+/**
+ * @brief close/ restore the write-protect guards of a range.
+ *
+ * @param guards the guards to be closed/ restored, they are freed.
+ */
+void
+guard_close(guard_list_t* guards) {
+    /* restore the protection each part had. */
+    _vforeach(guards, guard_t, guard)
+#ifndef _WIN32
+        if (mprotect(guard.address, guard.length, (int) guard.flags) != 0x0) {
+            /* NOLINTNEXTLINE */
+            fprintf(stderr, "tapi, guard_close; mprotect failed; could not close pguard.\n");
+        }
 #else
-    DWORD tmp;
-    if (VirtualProtect(guard->address, guard->length, guard->flags, &tmp) != 0x0) {
-        /* we can actually use MSVCs "safe" version for fprintf. */
-        fprintf_s(stderr, "tapi, guard_close; VirtualProtect failed; could not close pguard.");
-    }
+        DWORD tmp;
+        if (VirtualProtect(guard.address, guard.length, guard.flags, &tmp) == 0x0) {
+            /* we can actually use MSVCs "safe" version for fprintf. */
+            fprintf_s(stderr, "tapi, guard_close; VirtualProtect failed; could not close pguard.");
+        }
 #endif
-}
\ No newline at end of file
+    _endforeach;
+    guard_list_free(guards);
+}
@@ -8,27 +8,66 @@
 /*! @uses size_t. */
 #include <stddef.h>
 
+/*! @uses e_intt_result_t. */
+#include "intt.h"
+
+/*! @uses uintptr_t. */
+#include <stdint.h>
+
+/*! @uses dyna_define. */
+#include <tapi/dyna.h>
+
+/** a mapping of the process, with its protection flags. */
+typedef struct {
+    uintptr_t start, end;
+    size_t flags;
+} guard_map_t;
+
+/* a typed vector of the mappings of the process, ordered by address. */
+dyna_define(guard_maps, guard_map_t, 128u)
+
 /** a data structure for a memory protection guard. */
 typedef struct {
-    void* address; /* address in memory to be written to. */
-    size_t length, flags; /* length and old flags for memory (winapi). */
+    void* address; /* page-aligned address in memory to be written to. */
+    size_t length, flags; /* page-aligned length and the old protection flags of the memory. */
 } guard_t;
 
+/* a typed vector of guards, one per mapping a range spans. */
+dyna_define(guard_list, guard_t, 4u)
+
+/**
+ * @brief read the mappings of the process and their protection, once for any number of guards;
+ *  the first 128 are kept without allocating.
+ *
+ * @param maps the mappings to be filled in, freed with guard_maps_free().
+ * @return ref. to intt.h for enum.
+ */
+e_intt_result_t
+guard_maps_read(guard_maps_t* maps);
+
 /**
- * @brief create a write-protect guard for an address in memory.
+ * @brief make an address range writable, over every page it touches, with a guard per mapping
+ *  it spans, each keeping the protection of its own mapping to be restored by guard_close().
  *
+ * @param guards the guards to be filled in.
  * @param address the address to be given write protection in memory.
  * @param length the length of bytes to be protected.
- * @return a allocated pguard_t structure.
+ * @param maps the mappings, as read by guard_maps_read(); without them, the range is taken to
+ *  be code (read and exec).
+ * @return ref. to intt.h for enum.
  */
-guard_t*
-guard_create(void* address, size_t length);
+e_intt_result_t
+guard_open(guard_list_t* guards, void* address, size_t length, const guard_maps_t* maps);
+
+/** @return the page size. */
+size_t
+guard_page_size(void);
 
 /**
- * @brief close/ restore the write-protect guard.
+ * @brief close/ restore the write-protect guards of a range.
  *
- * @param guard the guard to be closed/ restored.
+ * @param guards the guards to be closed/ restored, they are freed.
  */
 void
-guard_close(guard_t* guard);
+guard_close(guard_list_t* guards);
 #endif /* PGUARD_H */
\ No newline at end of file
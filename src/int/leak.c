@@ -0,0 +1,345 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-10-19
+ */
+/* we have to define this to use dladdr() and MAP_ANONYMOUS. */
+#define _GNU_SOURCE
+
+#include "leak.h"
+
+/*! @uses fprintf. */
+#include <stdio.h>
+
+/*! @uses strrchr. */
+#include <string.h>
+
+/*! @uses getenv. */
+#include <stdlib.h>
+
+/*! @uses bool. */
+#include <stdbool.h>
+
+/*! @uses dladdr, Dl_info. */
+#include <dlfcn.h>
+
+/*! @uses mmap, munmap, MAP_FAILED. */
+#include <sys/mman.h>
+
+/*! @uses tapi_leak_check, e_tapi_leak_t. */
+#include <tapi/alloc.h>
+
+/*! @uses internal. */
+#include "intt.h"
+
+/** a tracked block; an empty slot has a ptr of 0. */
+typedef struct {
+    uintptr_t ptr;
+    const void* site;
+    size_t size;
+    uint32_t epoch;
+} entry_t;
+
+/** the leaked blocks of a site, while a report is collected. */
+typedef struct {
+    const void* site;
+    size_t count, bytes;
+} group_t;
+
+/* the mode, the active epoch (0 for none), and the last epoch handed out. */
+static e_tapi_leak_t l_mode;
+static uint32_t l_epoch, l_last;
+
+/* the pause depth of this thread; initial-exec so reading it never allocates. */
+static _Thread_local uint32_t l_paused __attribute__((tls_model("initial-exec")));
+
+/* the table of tracked blocks, mmap'd so tracking never calls the allocator we interpose. */
+static entry_t* l_entries;
+static size_t l_count, l_capacity;
+static bool l_lock;
+
+/** @brief take the table lock. */
+internal void
+lock(void) {
+    while (__atomic_test_and_set(&l_lock, __ATOMIC_ACQUIRE));
+}
+
+/** @brief release the table lock. */
+internal void
+unlock(void) {
+    __atomic_clear(&l_lock, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief the home slot of a block.
+ *
+ * @param ptr the block.
+ * @param capacity the capacity of the table (a power of two).
+ * @return the index of the home slot.
+ */
+internal size_t
+home(uintptr_t ptr, size_t capacity) {
+    return (size_t)(((uint64_t) ptr >> 4u) * 0x9e3779b97f4a7c15ull >> 20u) & (capacity - 1u);
+}
+
+/**
+ * @brief insert an entry into a table, without growing it.
+ *
+ * @param entries the table.
+ * @param capacity the capacity of the table.
+ * @param entry the entry to be inserted.
+ */
+internal void
+insert(entry_t* entries, size_t capacity, entry_t entry) {
+    size_t i = home(entry.ptr, capacity);
+    while (entries[i].ptr != 0u && entries[i].ptr != entry.ptr)
+        i = (i + 1u) & (capacity - 1u);
+    entries[i] = entry;
+}
+
+/**
+ * @brief remove the entry at a slot, shifting the following entries back so no probe sequence
+ *  is broken (no tombstones).
+ *
+ * @param i the slot to be emptied.
+ */
+internal void
+remove_at(size_t i) {
+    size_t mask = l_capacity - 1u;
+    for (size_t j = (i + 1u) & mask; l_entries[j].ptr != 0u; j = (j + 1u) & mask) {
+        /* move j into the hole at i if its home is not cyclically within (i, j]. */
+        size_t k = home(l_entries[j].ptr, l_capacity);
+        if ((j > i && (k <= i || k > j)) || (j < i && (k <= i && k > j))) {
+            l_entries[i] = l_entries[j];
+            i = j;
+        }
+    }
+    l_entries[i] = (entry_t) { 0 };
+    l_count--;
+}
+
+/**
+ * @brief grow the table to twice its capacity.
+ *
+ * @return ref. to intt.h for enum.
+ */
+internal e_intt_result_t
+grow(void) {
+    size_t capacity = l_capacity ? l_capacity * 2u : 4096u;
+    entry_t* entries = mmap(0x0, capacity * sizeof *entries, PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (entries == MAP_FAILED)
+        return E_INTT_RESULT_FAILURE;
+    for (size_t i = 0u; i < l_capacity; i++)
+        if (l_entries[i].ptr != 0u)
+            insert(entries, capacity, l_entries[i]);
+    if (l_entries != 0x0)
+        munmap(l_entries, l_capacity * sizeof *l_entries);
+    l_entries = entries;
+    l_capacity = capacity;
+    return E_INTT_RESULT_SUCCESS;
+}
+
+/**
+ * @brief set whether blocks allocated by a test and still live after its teardown are
+ *  reported, or also fail the test; the environment variable `TAPI_LEAK_CHECK` ("report" or
+ *  "fail") sets the mode when the library is loaded, so a call made later still applies.
+ *
+ * @param mode the leak checking mode.
+ */
+void
+tapi_leak_check(e_tapi_leak_t mode) {
+    l_mode = mode;
+}
+
+/** @brief read the leak checking mode from the environment, once when the library is loaded. */
+void
+leak_setup(void) {
+    const char* mode = getenv("TAPI_LEAK_CHECK");
+    if (mode != 0x0 && strcmp(mode, "report") == 0)
+        l_mode = E_TAPI_LEAK_REPORT;
+    else if (mode != 0x0 && strcmp(mode, "fail") == 0)
+        l_mode = E_TAPI_LEAK_FAIL;
+}
+
+/** @return the leak checking mode. */
+e_tapi_leak_t
+leak_mode(void) {
+    return l_mode;
+}
+
+/**
+ * @brief start tracking the blocks allocated (by any thread) from now on.
+ *
+ * @return the epoch the blocks are tracked under, or 0 if leak checking is off.
+ */
+uint32_t
+leak_begin(void) {
+    if (leak_mode() == E_TAPI_LEAK_OFF)
+        return 0u;
+    uint32_t epoch = ++l_last ? l_last : ++l_last;
+    __atomic_store_n(&l_epoch, epoch, __ATOMIC_RELEASE);
+    return epoch;
+}
+
+/** @brief stop tracking new blocks; blocks already tracked are still untracked when freed. */
+void
+leak_end(void) {
+    __atomic_store_n(&l_epoch, 0u, __ATOMIC_RELEASE);
+}
+
+/** @brief stop tracking the blocks the calling thread allocates, until leak_resume(). */
+void
+leak_pause(void) {
+    l_paused++;
+}
+
+/** @brief undo a leak_pause(). */
+void
+leak_resume(void) {
+    l_paused--;
+}
+
+/**
+ * @brief track a block, if an epoch is active.
+ *
+ * @param ptr the allocated block.
+ * @param size the number of bytes requested.
+ * @param site the address the allocation was made from.
+ */
+void
+leak_track(const void* ptr, size_t size, const void* site) {
+    uint32_t epoch = __atomic_load_n(&l_epoch, __ATOMIC_RELAXED);
+    if (epoch == 0u || ptr == 0x0 || l_paused != 0u)
+        return;
+
+    /* keep the load under 1/2, so probe sequences stay short. */
+    lock();
+    if ((l_count + 1u) * 2u > l_capacity && !e_intt_passed(grow())) {
+        unlock();
+        return;
+    }
+    insert(l_entries, l_capacity, (entry_t) { .ptr = (uintptr_t) ptr, .site = site,
+                                              .size = size, .epoch = epoch });
+    l_count++;
+    unlock();
+}
+
+/**
+ * @brief stop tracking a block that is being freed.
+ *
+ * @param ptr the block being freed.
+ */
+void
+leak_untrack(const void* ptr) {
+    if (__atomic_load_n(&l_count, __ATOMIC_RELAXED) == 0u || ptr == 0x0)
+        return;
+    lock();
+    if (l_capacity != 0u) {
+        size_t i = home((uintptr_t) ptr, l_capacity);
+        while (l_entries[i].ptr != 0u && l_entries[i].ptr != (uintptr_t) ptr)
+            i = (i + 1u) & (l_capacity - 1u);
+        if (l_entries[i].ptr != 0u)
+            remove_at(i);
+    }
+    unlock();
+}
+
+/**
+ * @brief collect (and stop tracking) the blocks of an epoch that are still live.
+ *
+ * @param epoch the epoch to collect.
+ * @param report the report to fill in.
+ */
+void
+leak_collect(uint32_t epoch, leak_report_t* report) {
+    *report = (leak_report_t) { 0 };
+    lock();
+    size_t blocks = 0u;
+    for (size_t i = 0u; i < l_capacity; i++)
+        blocks += l_entries[i].ptr != 0u && l_entries[i].epoch == epoch;
+
+    /* group by site in a table with room for a site per block, mmap'd like the block table. */
+    size_t capacity = 16u;
+    while (capacity < blocks * 2u)
+        capacity *= 2u;
+    group_t* groups = mmap(0x0, capacity * sizeof *groups, PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    for (size_t i = 0u; i < l_capacity;) {
+        entry_t entry = l_entries[i];
+        if (entry.ptr == 0u || entry.epoch != epoch) {
+            i++;
+            continue;
+        }
+
+        /* add to the group of its site, or open one; without a table only the totals are kept. */
+        report->count++;
+        report->bytes += entry.size;
+        if (groups != MAP_FAILED) {
+            size_t g = home((uintptr_t) entry.site, capacity);
+            while (groups[g].count != 0u && groups[g].site != entry.site)
+                g = (g + 1u) & (capacity - 1u);
+            if (groups[g].count == 0u) {
+                groups[g].site = entry.site;
+                report->sites++;
+            }
+            groups[g].count++;
+            groups[g].bytes += entry.size;
+        }
+
+        /* removing shifts a later entry into this slot, so look at it again. */
+        remove_at(i);
+    }
+    unlock();
+    if (groups == MAP_FAILED)
+        return;
+
+    /* keep the sites with the most bytes, in order; the smallest falls off once all are kept. */
+    size_t kept = 0u;
+    for (size_t g = 0u; g < capacity; g++) {
+        if (groups[g].count == 0u)
+            continue;
+        size_t at = kept < LEAK_SITES ? kept++ : LEAK_SITES;
+        while (at > 0u && report->groups[at - 1u].bytes < groups[g].bytes) {
+            if (at < LEAK_SITES)
+                report->groups[at] = report->groups[at - 1u];
+            at--;
+        }
+        if (at < LEAK_SITES) {
+            report->groups[at].site = groups[g].site;
+            report->groups[at].count = groups[g].count;
+            report->groups[at].bytes = groups[g].bytes;
+        }
+    }
+    munmap(groups, capacity * sizeof *groups);
+}
+
+/**
+ * @brief print a leak report, one line per site, symbolized where possible.
+ *
+ * @param report the report to be printed.
+ * @param stream the stream to print to.
+ */
+void
+leak_print(const leak_report_t* report, tapi_stream_t stream) {
+    if (report->count == 0u)
+        return;
+    fprintf(stream, "\tleaked %zu block(s), %zu bytes, from %zu site(s):\n", report->count,
+            report->bytes, report->sites);
+    for (size_t g = 0u; g < report->sites && g < LEAK_SITES; g++) {
+        fprintf(stream, "\t  %zu block(s), %zu bytes at %p", report->groups[g].count,
+                report->groups[g].bytes, report->groups[g].site);
+        Dl_info info;
+        if (dladdr(report->groups[g].site, &info) != 0 && info.dli_fname != 0x0) {
+            const char* file = strrchr(info.dli_fname, '/');
+            file = file != 0x0 ? file + 1 : info.dli_fname;
+            if (info.dli_sname != 0x0)
+                fprintf(stream, " (%s+0x%tx in %s)", info.dli_sname,
+                        (const char*) report->groups[g].site - (const char*) info.dli_saddr,
+                        file);
+            else fprintf(stream, " (in %s)", file);
+        }
+        fprintf(stream, "\n");
+    }
+    if (report->sites > LEAK_SITES)
+        fprintf(stream, "\t  ... and %zu more site(s).\n", report->sites - LEAK_SITES);
+}
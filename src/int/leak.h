@@ -0,0 +1,100 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-10-19
+ */
+#ifndef LEAK_H
+#define LEAK_H
+
+/*! @uses size_t. */
+#include <stddef.h>
+
+/*! @uses uint32_t. */
+#include <stdint.h>
+
+/*! @uses tapi_stream_t. */
+#include <tapi/sink.h>
+
+/*! @uses e_tapi_leak_t. */
+#include <tapi/alloc.h>
+
+/* number of allocation sites a leak report keeps apart. */
+#define LEAK_SITES 16u
+
+/** the leaks of a single test, grouped by the site that allocated them. */
+typedef struct {
+    /** number of leaked blocks and bytes over all sites, and the number of sites. */
+    size_t count, bytes, sites;
+    /** the sites with the most leaked bytes, the most first. */
+    struct {
+        const void* site;
+        size_t count, bytes;
+    } groups[LEAK_SITES];
+} leak_report_t;
+
+/** @brief read the leak checking mode from the environment, once when the library is loaded. */
+void
+leak_setup(void);
+
+/** @return the leak checking mode. */
+e_tapi_leak_t
+leak_mode(void);
+
+/**
+ * @brief start tracking the blocks allocated (by any thread) from now on.
+ *
+ * @return the epoch the blocks are tracked under, or 0 if leak checking is off.
+ */
+uint32_t
+leak_begin(void);
+
+/** @brief stop tracking new blocks; blocks already tracked are still untracked when freed. */
+void
+leak_end(void);
+
+/**
+ * @brief stop tracking the blocks the calling thread allocates, until leak_resume(); for
+ *  memory tapi allocates on behalf of a test and keeps, which is not the test's leak. pauses nest.
+ */
+void
+leak_pause(void);
+
+/** @brief undo a leak_pause(). */
+void
+leak_resume(void);
+
+/**
+ * @brief track a block, if an epoch is active.
+ *
+ * @param ptr the allocated block.
+ * @param size the number of bytes requested.
+ * @param site the address the allocation was made from.
+ */
+void
+leak_track(const void* ptr, size_t size, const void* site);
+
+/**
+ * @brief stop tracking a block that is being freed.
+ *
+ * @param ptr the block being freed.
+ */
+void
+leak_untrack(const void* ptr);
+
+/**
+ * @brief collect (and stop tracking) the blocks of an epoch that are still live.
+ *
+ * @param epoch the epoch to collect.
+ * @param report the report to fill in.
+ */
+void
+leak_collect(uint32_t epoch, leak_report_t* report);
+
+/**
+ * @brief print a leak report, one line per site, symbolized where possible.
+ *
+ * @param report the report to be printed.
+ * @param stream the stream to print to.
+ */
+void
+leak_print(const leak_report_t* report, tapi_stream_t stream);
+#endif /* LEAK_H */
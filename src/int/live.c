@@ -0,0 +1,507 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-10-19
+ */
+#define _GNU_SOURCE
+#include "live.h"
+
+/*! @uses sigaction, siginfo_t, sigemptyset, raise, SIGTRAP, SIGRTMIN, SI_QUEUE. */
+#include <signal.h>
+
+/*! @uses ucontext_t, REG_RIP, REG_EIP. */
+#include <ucontext.h>
+
+/*! @uses SYS_membarrier, SYS_rt_tgsigqueueinfo, SYS_getdents64, SYS_gettid. */
+#include <sys/syscall.h>
+
+/*! @uses MEMBARRIER_CMD_PRIVATE_EXPEDITED_SYNC_CORE. */
+#include <linux/membarrier.h>
+
+/*! @uses syscall, getpid, getuid, close. */
+#include <unistd.h>
+
+/*! @uses open, O_RDONLY, O_DIRECTORY. */
+#include <fcntl.h>
+
+/*! @uses pthread_mutex_t, pthread_mutex_lock, pthread_mutex_unlock. */
+#include <pthread.h>
+
+/*! @uses clock_gettime, nanosleep, struct timespec. */
+#include <time.h>
+
+/*! @uses fprintf, stderr. */
+#include <stdio.h>
+
+/*! @uses getenv, strtol. */
+#include <stdlib.h>
+
+/*! @uses memcpy, memset, strcmp. */
+#include <string.h>
+
+/*! @uses internal. */
+#include "intt.h"
+
+/* the signal every other thread is stopped with; a thread blocking it can't be patched around. */
+#define LIVE_SIGNAL SIGRTMIN
+
+/* most threads whose stopped pc is kept, times a stop is retried, and how long one waits. */
+#define LIVE_THREADS 1024u
+#define LIVE_TRIES 64u
+#define LIVE_TIMEOUT_NS 1000000000ll
+
+/* is the mode on (-1 until the environment is read)? */
+static int l_enabled = -1;
+
+/* one commit at a time. */
+static pthread_mutex_t l_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* the handlers there were before ours, for signals that aren't ours. */
+static struct sigaction l_old_trap, l_old_stop;
+
+/* the int3 in progress; a thread running into one waits while this is set. */
+static int l_patching;
+
+/* the stop in progress, its round in the high half and the threads that joined it in the low
+ *  half (0 once it is closed; a thread can only join the round it was signalled with), how many
+ *  of them have kept their pc and left, and the pc of each. */
+static uint32_t l_round;
+static uint64_t l_stop;
+static uint32_t l_arrived, l_left, l_go;
+static uintptr_t l_pcs[LIVE_THREADS];
+
+/* an entry of getdents64(), there is no libc header for it. */
+typedef struct {
+    uint64_t ino;
+    int64_t off;
+    unsigned short reclen;
+    unsigned char type;
+    char name[];
+} dirent_t;
+
+/** @return are writes made safe for other running threads (TAPI_MOCK_LIVE=1)? */
+bool
+live_enabled(void) {
+    int enabled = __atomic_load_n(&l_enabled, __ATOMIC_ACQUIRE);
+    if (enabled < 0) {
+        const char* live = getenv("TAPI_MOCK_LIVE");
+        int value = live != 0x0 && strcmp(live, "0") != 0;
+        if (!__atomic_compare_exchange_n(&l_enabled, &enabled, value, false, __ATOMIC_ACQ_REL,
+                                         __ATOMIC_ACQUIRE))
+            return enabled;
+        enabled = value;
+    }
+    return enabled;
+}
+
+/**
+ * @brief turn safe writes on or off, over what the environment says.
+ *
+ * @param enabled are they to be safe?
+ */
+void
+live_set(bool enabled) {
+    __atomic_store_n(&l_enabled, enabled ? 1 : 0, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief the pc a thread was interrupted at.
+ *
+ * @param context the ucontext_t of the signal.
+ * @return the pc, or 0 if it can't be found on this architecture.
+ */
+internal uintptr_t
+context_pc(const void* context) {
+    const ucontext_t* uc = context;
+#if defined(__x86_64__)
+    return (uintptr_t) uc->uc_mcontext.gregs[REG_RIP];
+#elif defined(__i386__)
+    return (uintptr_t) uc->uc_mcontext.gregs[REG_EIP];
+#elif defined(__aarch64__)
+    return (uintptr_t) uc->uc_mcontext.pc;
+#elif defined(__arm__)
+    return (uintptr_t) uc->uc_mcontext.arm_pc;
+#else
+    (void) uc;
+    return 0u;
+#endif
+}
+
+/**
+ * @brief hand a signal that isn't ours to the handler there was before ours.
+ *
+ * @param signal the signal.
+ * @param info the signal info.
+ * @param context the ucontext_t of the signal.
+ * @param old the handler there was before.
+ */
+internal void
+chain_signal(int signal, siginfo_t* info, void* context, const struct sigaction* old) {
+    if (old->sa_flags & SA_SIGINFO) {
+        if (old->sa_sigaction != 0x0)
+            old->sa_sigaction(signal, info, context);
+    }
+    else if (old->sa_handler == SIG_DFL) {
+        /* the default action happens once we return, the signal is blocked until then. */
+        sigaction(signal, old, 0x0);
+        raise(signal);
+    }
+    else if (old->sa_handler != SIG_IGN)
+        old->sa_handler(signal);
+}
+
+/**
+ * @brief install a handler once, keeping the one there was for chain_signal(); it stays, as a
+ *  signal we caused can arrive after we are done with it.
+ *
+ * @param signal the signal.
+ * @param handler our handler.
+ * @param old the handler there was before, to be filled in.
+ */
+internal void
+install_handler(int signal, void (*handler)(int, siginfo_t*, void*), struct sigaction* old) {
+    struct sigaction current;
+    if (sigaction(signal, 0x0, &current) == 0 && (current.sa_flags & SA_SIGINFO) &&
+        current.sa_sigaction == handler)
+        return;
+    struct sigaction action;
+    memset(&action, 0, sizeof action);
+    action.sa_sigaction = handler;
+    action.sa_flags = SA_SIGINFO | SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    sigaction(signal, &action, old);
+}
+
+/**
+ * @brief the int3 handler; a thread that ran into an int3 we wrote waits for the instruction to
+ *  be finished, and then runs it again. an int3 that is still there once we are done isn't ours.
+ *
+ * @param signal the signal.
+ * @param info the signal info.
+ * @param context the ucontext_t of the signal.
+ */
+internal void
+trap_handler(int signal, siginfo_t* info, void* context) {
+#if defined(__x86_64__) || defined(__i386__)
+    ucontext_t* uc = context;
+    volatile uint8_t* at = (volatile uint8_t*)(context_pc(context) - 1u);
+    while (info->si_code == SI_KERNEL && *at == 0xcc &&
+           __atomic_load_n(&l_patching, __ATOMIC_ACQUIRE));
+    if (info->si_code == SI_KERNEL && *at != 0xcc) {
+#if defined(__x86_64__)
+        uc->uc_mcontext.gregs[REG_RIP] = (greg_t) at;
+#else
+        uc->uc_mcontext.gregs[REG_EIP] = (greg_t) at;
+#endif
+        return;
+    }
+#endif
+    chain_signal(signal, info, context, &l_old_trap);
+}
+
+/**
+ * @brief the stop handler; a thread keeps where it was stopped, and waits to be let go.
+ *
+ * @param signal the signal.
+ * @param info the signal info.
+ * @param context the ucontext_t of the signal.
+ */
+internal void
+stop_handler(int signal, siginfo_t* info, void* context) {
+    if (info->si_code != SI_QUEUE || info->si_pid != getpid()) {
+        chain_signal(signal, info, context, &l_old_stop);
+        return;
+    }
+
+    /* join the round it was signalled with; a stop that has been closed is ignored. */
+    uint64_t round = (uint32_t) info->si_value.sival_int;
+    uint64_t stop = __atomic_load_n(&l_stop, __ATOMIC_ACQUIRE);
+    do {
+        if ((stop >> 32u) != round)
+            return;
+    } while (!__atomic_compare_exchange_n(&l_stop, &stop, stop + 1u, true, __ATOMIC_ACQ_REL,
+                                          __ATOMIC_ACQUIRE));
+    uint32_t slot = (uint32_t) stop;
+    if (slot < LIVE_THREADS)
+        l_pcs[slot] = context_pc(context);
+    __atomic_fetch_add(&l_arrived, 1u, __ATOMIC_ACQ_REL);
+    while (!__atomic_load_n(&l_go, __ATOMIC_ACQUIRE));
+    __atomic_fetch_add(&l_left, 1u, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief go over every other thread of the process, from /proc/self/task; it is read with a
+ *  stack buffer, so nothing is allocated (the stop can't be holding the allocator's lock).
+ *
+ * @param send are they to be signalled, or only counted?
+ * @param round the stop to signal them with.
+ * @return the number of threads (signalled).
+ */
+internal size_t
+other_threads(bool send, int round) {
+    int fd = open("/proc/self/task", O_RDONLY | O_DIRECTORY);
+    if (fd < 0)
+        return 0u;
+    int pid = getpid();
+    long self = syscall(SYS_gettid);
+    size_t count = 0u;
+    char buffer[4096u];
+    long got;
+    while ((got = syscall(SYS_getdents64, fd, buffer, sizeof buffer)) > 0) {
+        for (long offset = 0; offset < got;) {
+            const dirent_t* entry = (const dirent_t*)(buffer + offset);
+            offset += entry->reclen;
+            if (entry->name[0] < '0' || entry->name[0] > '9')
+                continue;
+            long tid = strtol(entry->name, 0x0, 10);
+            if (tid == self)
+                continue;
+            if (!send) {
+                count++;
+                continue;
+            }
+
+            /* queued, so the round comes with it. */
+            siginfo_t info;
+            memset(&info, 0, sizeof info);
+            info.si_signo = LIVE_SIGNAL;
+            info.si_code = SI_QUEUE;
+            info.si_pid = pid;
+            info.si_uid = getuid();
+            info.si_value.sival_int = round;
+            if (syscall(SYS_rt_tgsigqueueinfo, pid, tid, LIVE_SIGNAL, &info) == 0)
+                count++;
+        }
+    }
+    close(fd);
+    return count;
+}
+
+/**
+ * @brief make every core of the process drop what it fetched of the code before now.
+ *
+ * @return could they be (the kernel may not support it)?
+ */
+internal bool
+sync_cores(void) {
+    static int registered;
+    if (registered == 0) {
+        registered = syscall(SYS_membarrier, MEMBARRIER_CMD_REGISTER_PRIVATE_EXPEDITED_SYNC_CORE,
+                             0, 0) == 0 ? 1 : -1;
+    }
+    return registered > 0 &&
+           syscall(SYS_membarrier, MEMBARRIER_CMD_PRIVATE_EXPEDITED_SYNC_CORE, 0, 0) == 0;
+}
+
+/**
+ * @brief write with a single store, if the write is one naturally aligned store.
+ *
+ * @param write the write.
+ * @return was it written?
+ */
+internal bool
+store_atomic(const live_write_t* write) {
+    size_t size = write->size;
+    if (size == 0u || (size & (size - 1u)) != 0u || size > sizeof(void*) ||
+        ((uintptr_t) write->address & (size - 1u)) != 0u)
+        return false;
+    switch (size) {
+        case 1u: {
+            __atomic_store_n((uint8_t*) write->address, write->bytes[0], __ATOMIC_RELEASE);
+            break;
+        }
+        case 2u: {
+            uint16_t value;
+            /* NOLINTNEXTLINE */
+            memcpy(&value, write->bytes, sizeof value);
+            __atomic_store_n((uint16_t*) write->address, value, __ATOMIC_RELEASE);
+            break;
+        }
+        case 4u: {
+            uint32_t value;
+            /* NOLINTNEXTLINE */
+            memcpy(&value, write->bytes, sizeof value);
+            __atomic_store_n((uint32_t*) write->address, value, __ATOMIC_RELEASE);
+            break;
+        }
+        default: {
+            uint64_t value;
+            /* NOLINTNEXTLINE */
+            memcpy(&value, write->bytes, sizeof value);
+            __atomic_store_n((uint64_t*) write->address, value, __ATOMIC_RELEASE);
+            break;
+        }
+    }
+    __builtin___clear_cache((char*) write->address, (char*) write->address + size);
+    return true;
+}
+
+/**
+ * @brief can a write be a single store? a run of instructions only can be if it is a single
+ *  instruction anyway (a fixed size one), as a thread may be stopped in the middle of it.
+ *
+ * @param write the write.
+ * @return can it?
+ */
+internal bool
+is_atomic(const live_write_t* write) {
+#if defined(__aarch64__)
+    return write->kind != E_LIVE_KIND_CODE || write->size == 4u;
+#else
+    return write->kind != E_LIVE_KIND_CODE;
+#endif
+}
+
+/**
+ * @brief write single instructions behind int3s: an int3 over the first byte, then the rest of
+ *  the instruction, then the first byte, syncing every core in between; a thread can only ever
+ *  run the old instruction, the new one, or the int3 (and wait in trap_handler()).
+ *
+ * @param writes the writes.
+ * @param count the number of writes.
+ */
+internal void
+write_int3(const live_write_t* const* writes, size_t count) {
+    install_handler(SIGTRAP, trap_handler, &l_old_trap);
+    __atomic_store_n(&l_patching, 1, __ATOMIC_RELEASE);
+    for (size_t i = 0u; i < count; i++)
+        __atomic_store_n((uint8_t*) writes[i]->address, 0xccu, __ATOMIC_RELEASE);
+    sync_cores();
+    for (size_t i = 0u; i < count; i++) {
+        /* NOLINTNEXTLINE */
+        memcpy((uint8_t*) writes[i]->address + 1u, writes[i]->bytes + 1u, writes[i]->size - 1u);
+    }
+    sync_cores();
+    for (size_t i = 0u; i < count; i++)
+        __atomic_store_n((uint8_t*) writes[i]->address, writes[i]->bytes[0], __ATOMIC_RELEASE);
+    sync_cores();
+    __atomic_store_n(&l_patching, 0, __ATOMIC_RELEASE);
+}
+
+/** @return the monotonic time, in nanoseconds. */
+internal long long
+now_ns(void) {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (long long) time.tv_sec * 1000000000ll + time.tv_nsec;
+}
+
+/**
+ * @brief write with every other thread stopped, none of them within the bytes being written.
+ *
+ * @param writes the writes.
+ * @param count the number of writes.
+ * @return were they written?
+ */
+internal bool
+write_stopped(const live_write_t* const* writes, size_t count) {
+    install_handler(LIVE_SIGNAL, stop_handler, &l_old_stop);
+    for (size_t try = 0u; try < LIVE_TRIES; try++) {
+        /* a new round (never 0, that is a closed stop), every thread of the last one has left. */
+        __atomic_store_n(&l_arrived, 0u, __ATOMIC_RELAXED);
+        __atomic_store_n(&l_left, 0u, __ATOMIC_RELAXED);
+        __atomic_store_n(&l_go, 0u, __ATOMIC_RELAXED);
+        if (++l_round == 0u)
+            l_round = 1u;
+        __atomic_store_n(&l_stop, (uint64_t) l_round << 32u, __ATOMIC_RELEASE);
+        size_t sent = other_threads(true, (int) l_round);
+
+        /* wait for them to stop (a thread that exited, or blocks the signal, never does). */
+        long long deadline = now_ns() + LIVE_TIMEOUT_NS;
+        while (__atomic_load_n(&l_arrived, __ATOMIC_ACQUIRE) < sent && now_ns() < deadline);
+
+        /* close the round, a thread that is late to it won't join it now; those that did have
+         *  all kept their pc once they have arrived. */
+        uint32_t joined = (uint32_t) __atomic_exchange_n(&l_stop, 0u, __ATOMIC_ACQ_REL);
+        while (__atomic_load_n(&l_arrived, __ATOMIC_ACQUIRE) < joined);
+        bool stopped = joined >= sent && joined <= LIVE_THREADS;
+
+        /* is any of them within the code being written? */
+        for (uint32_t i = 0u; stopped && i < joined; i++) {
+            for (size_t j = 0u; j < count; j++) {
+                uintptr_t start = (uintptr_t) writes[j]->address;
+                if (l_pcs[i] > start && l_pcs[i] < start + writes[j]->size)
+                    stopped = false;
+            }
+        }
+        if (stopped) {
+            for (size_t i = 0u; i < count; i++) {
+                /* NOLINTNEXTLINE */
+                memcpy(writes[i]->address, writes[i]->bytes, writes[i]->size);
+                __builtin___clear_cache((char*) writes[i]->address,
+                                        (char*) writes[i]->address + writes[i]->size);
+            }
+        }
+
+        /* let them go, and have them leave before the next round. */
+        __atomic_store_n(&l_go, 1u, __ATOMIC_RELEASE);
+        while (__atomic_load_n(&l_left, __ATOMIC_ACQUIRE) < joined);
+        if (stopped)
+            return true;
+        struct timespec wait = { 0, 1000000 };
+        nanosleep(&wait, 0x0);
+    }
+    return false;
+}
+
+/**
+ * @brief write code that other threads could be running, to memory already made writable. a
+ *  write that is a single aligned store is made atomically; a single instruction on x86 is
+ *  written behind an int3 breakpoint, that any thread running into it waits on; everything
+ *  else is written with every other thread stopped, and retried while one of them is stopped
+ *  within the bytes being written.
+ *
+ * @param writes the writes.
+ * @param count the number of writes.
+ * @return the number of writes written.
+ */
+size_t
+live_commit(const live_write_t* writes, size_t count) {
+    pthread_mutex_lock(&l_lock);
+    size_t written = 0u;
+
+    /* nobody else is running. */
+    if (other_threads(false, 0) == 0u) {
+        for (size_t i = 0u; i < count; i++) {
+            /* NOLINTNEXTLINE */
+            memcpy(writes[i].address, writes[i].bytes, writes[i].size);
+        }
+        pthread_mutex_unlock(&l_lock);
+        return count;
+    }
+
+    /* what can be a single store is; the rest is split by how it has to be written. */
+    const live_write_t* int3s[64u], * stops[64u];
+    size_t int3_count = 0u, stop_count = 0u;
+#if defined(__x86_64__) || defined(__i386__)
+    bool can_int3 = sync_cores();
+#else
+    bool can_int3 = false;
+#endif
+    for (size_t i = 0u; i < count; i++) {
+        const live_write_t* write = &writes[i];
+        if (is_atomic(write) && store_atomic(write))
+            written++;
+        else if (can_int3 && write->kind == E_LIVE_KIND_INSN && write->size > 1u)
+            int3s[int3_count++] = write;
+        else stops[stop_count++] = write;
+
+        /* flush either, when full or at the end. */
+        if (int3_count == 64u || (i + 1u == count && int3_count != 0u)) {
+            write_int3(int3s, int3_count);
+            written += int3_count;
+            int3_count = 0u;
+        }
+        if (stop_count == 64u || (i + 1u == count && stop_count != 0u)) {
+            if (write_stopped(stops, stop_count))
+                written += stop_count;
+            else {
+                /* NOLINTNEXTLINE */
+                fprintf(stderr, "tapi, live_commit; could not stop every other thread outside "
+                                "of %zu write(s); not written.\n", stop_count);
+            }
+            stop_count = 0u;
+        }
+    }
+    pthread_mutex_unlock(&l_lock);
+    return written;
+}
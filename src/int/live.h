@@ -0,0 +1,63 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-10-19
+ */
+#ifndef LIVE_H
+#define LIVE_H
+
+/*! @uses size_t. */
+#include <stddef.h>
+
+/*! @uses uint8_t. */
+#include <stdint.h>
+
+/*! @uses bool. */
+#include <stdbool.h>
+
+/*! @uses dyna_define. */
+#include <tapi/dyna.h>
+
+/** what is being written. */
+typedef enum {
+    E_LIVE_KIND_INSN = 0x0, /* a single instruction (a call). */
+    E_LIVE_KIND_CODE, /* a run of instructions (an entry patch, or a trampoline). */
+    E_LIVE_KIND_DATA /* data that code reads (a got slot). */
+} e_live_kind_t;
+
+/** code to be written while other threads could be running it. */
+typedef struct {
+    void* address;
+    const uint8_t* bytes;
+    size_t size;
+    e_live_kind_t kind;
+} live_write_t;
+
+/* a typed vector of writes. */
+dyna_define(live_writes, live_write_t, 8u)
+
+/** @return are writes made safe for other running threads (TAPI_MOCK_LIVE=1)? */
+bool
+live_enabled(void);
+
+/**
+ * @brief turn safe writes on or off, over what the environment says.
+ *
+ * @param enabled are they to be safe?
+ */
+void
+live_set(bool enabled);
+
+/**
+ * @brief write code that other threads could be running, to memory already made writable. a
+ *  write that is a single aligned store is made atomically; a single instruction on x86 is
+ *  written behind an int3 breakpoint, that any thread running into it waits on; everything
+ *  else is written with every other thread stopped, and retried while one of them is stopped
+ *  within the bytes being written.
+ *
+ * @param writes the writes.
+ * @param count the number of writes.
+ * @return the number of writes written.
+ */
+size_t
+live_commit(const live_write_t* writes, size_t count);
+#endif /* LIVE_H */
@@ -7,10 +7,19 @@
 /*! @uses fprintf, stderr. */
 #include <stdio.h>
 
+/*! @uses memcpy. */
+#include <string.h>
+
+/*! @uses live_write_t, live_enabled, live_commit. */
+#include "live.h"
+
 /*! @uses arch_t, get_arch. */
 #include "arch.h"
 
-/*! @uses guard_create, guard_close. */
+/*! @uses tramp_veneer. */
+#include "tramp.h"
+
+/*! @uses guard_maps_t, guard_maps_read, guard_list_t, guard_open, guard_close, guard_page_size. */
 #include "guard.h"
 
 /*! @uses internal. */
@@ -32,17 +41,18 @@ flush_insn_cache(void* address, size_t size) {
 }
 
 /**
- * @brief patch a relative call on x86 architectures (assuming it is an 0xe8 call).
+ * @brief patch a relative call on x86 architectures (an 0xe8 call, or an ff 15 indirect call).
  *
  * @param call the pointer to the call insn. within a function.
  * @param size the size of the insn.
  * @param new_target the pointer to the new call target.
+ * @param code a copy of the insn., to be rewritten.
  * @return ref. to intt.h for enum.
  */
 internal e_intt_result_t
-patch_relative_bx86(void* call, const size_t size, const void* new_target) {
+patch_relative_bx86(const void* call, const size_t size, const void* new_target, void* code) {
     /* get the given byte code. */
-    uint8_t* code = call;
+    uint8_t* bytes = code;
 
     /* x64 rel. call is always 5 bytes. */
     if (size < 5u) {
@@ -51,18 +61,28 @@ patch_relative_bx86(void* call, const size_t size, const void* new_target) {
         return E_INTT_RESULT_FAILURE;
     }
 
+    /* an indirect call through memory (ff 15, after a notrack prefix or not) becomes an addr32
+     *  prefixed direct call (after a nop, for the notrack form), so it ends where the original
+     *  did, and a call in flight returns to the same place either way. */
+    size_t at = 0u;
+    if ((size == 6u || size == 7u) && bytes[size - 6u] == 0xff && bytes[size - 5u] == 0x15) {
+        /* NOLINTNEXTLINE */
+        memcpy(bytes, size == 6u ? "\x67\xe8" : "\x90\x67\xe8", size - 4u);
+        at = size - 5u;
+    }
+
     /* verify its actually an e8 rel. call */
-    if (code[0] != 0xe8) {
+    if (bytes[at] != 0xe8) {
         /* NOLINTNEXTLINE */
-        fprintf(stderr, "bx86/64; not a rel. call (0x%02x).\n", code[0]);
+        fprintf(stderr, "bx86/64; not a rel. call (0x%02x).\n", bytes[at]);
         return E_INTT_RESULT_FAILURE;
     }
 
-    /* calculate new offset. */
-    int64_t offset64 = (int64_t)new_target - ((int64_t)call + 5u);
+    /* calculate new offset, from the end of the call. */
+    int64_t offset64 = (int64_t)new_target - ((int64_t)call + (int64_t)(at + 5u));
 
-    /* check if the offset is 32-bit signed. */
-    if (offset64 > INT32_MAX || offset64 < INT32_MIN) {
+    /* check if the offset is 32-bit signed (on i386 it wraps around, and reaches everywhere). */
+    if (sizeof(void*) == 8u && (offset64 > INT32_MAX || offset64 < INT32_MIN)) {
         /* NOLINTNEXTLINE */
         fprintf(stderr, "bx86/64; new target out of range (>2gb).\n");
         return E_INTT_RESULT_FAILURE;
@@ -70,7 +90,8 @@ patch_relative_bx86(void* call, const size_t size, const void* new_target) {
     int32_t offset = (int32_t)offset64;
 
     /* write to e8 ?? ?? ?? ??, and return. */
-    *(int32_t*)(code + 1u) = offset;
+    /* NOLINTNEXTLINE */
+    memcpy(bytes + at + 1u, &offset, sizeof offset);
     return E_INTT_RESULT_SUCCESS;
 }
 
@@ -80,10 +101,11 @@ patch_relative_bx86(void* call, const size_t size, const void* new_target) {
  * @param call the pointer to the call insn. within a function.
  * @param size the size of the insn.
  * @param new_target the pointer to the new call target.
+ * @param code a copy of the insn., to be rewritten.
  * @return ref. to intt.h for enum.
  */
 internal e_intt_result_t
-patch_relative_barm(void* call, const size_t size, const void* new_target) {
+patch_relative_barm(const void* call, const size_t size, const void* new_target, void* code) {
     /* we only expect 4 bytes. */
     if (size != 4u) {
         /* NOLINTNEXTLINE */
@@ -92,7 +114,7 @@ patch_relative_barm(void* call, const size_t size, const void* new_target) {
     }
 
     /* check if its a bl instruction (opcode bits 31-24 = 0xeb). */
-    uint32_t* insn = call;
+    uint32_t* insn = code;
     if ((*insn & 0xff000000) != 0xeb000000) {
         /* NOLINTNEXTLINE */
         fprintf(stderr, "barm32; not a bl insn. (0x%08x).\n", *insn);
@@ -104,10 +126,10 @@ patch_relative_barm(void* call, const size_t size, const void* new_target) {
     uint64_t target = (uint64_t)new_target;
     int32_t offset = (int32_t)(target - (pc + 8u));
 
-    /* check 24-bit signed range (+32mb). */
-    if (offset > 0x7fffff || offset < -0x800000) {
+    /* check 24-bit signed range of words (+/-32mb). */
+    if (offset > 0x1fffffc || offset < -0x2000000) {
         /* NOLINTNEXTLINE */
-        fprintf(stderr, "barm32; target out of range (+32mb).\n");
+        fprintf(stderr, "barm32; target out of range (+/-32mb).\n");
         return E_INTT_RESULT_FAILURE;
     }
 
@@ -128,10 +150,11 @@ patch_relative_barm(void* call, const size_t size, const void* new_target) {
  * @param call the pointer to the call insn. within a function.
  * @param size the size of the insn.
  * @param new_target the pointer to the new call target.
+ * @param code a copy of the insn., to be rewritten.
  * @return ref. to intt.h for enum.
  */
 internal e_intt_result_t
-patch_relative_barmth(void* call, const size_t size, const void* new_target) {
+patch_relative_barmth(const void* call, const size_t size, const void* new_target, void* code) {
     /* we only expect 4 bytes. */
     if (size != 4u) {
         /* NOLINTNEXTLINE */
@@ -140,7 +163,7 @@ patch_relative_barmth(void* call, const size_t size, const void* new_target) {
     }
 
     /* check if its a bl insn (first half = 0xf). */
-    uint16_t* insn = call;
+    uint16_t* insn = code;
     if ((insn[0] & 0xf800) != 0xf000) {
         /* NOLINTNEXTLINE */
         fprintf(stderr, "barmth; not a bl insn. (0x%04x)\n", insn[0]);
@@ -185,22 +208,27 @@ patch_relative_barmth(void* call, const size_t size, const void* new_target) {
 }
 
 /**
- * @brief patch a relative call on a 64-bit arm architecture.
+ * @brief patch a relative call on a 64-bit arm architecture (a bl, or a blr through a register).
  *
  * @param call the pointer to the call insn. within a function.
  * @param size the size of the insn.
  * @param new_target the pointer to the new call target.
+ * @param code a copy of the insn., to be rewritten.
  * @return ref. to intt.h for enum.
  */
 internal e_intt_result_t
-patch_relative_barm64(void* call, const size_t size, const void* new_target) {
+patch_relative_barm64(const void* call, const size_t size, const void* new_target, void* code) {
     /* we only expect 4 bytes. */
     if (size != 4u) {
         /* NOLINTNEXTLINE */
         fprintf(stderr, "barm64; expected 4-byte insn., got %zu bytes.\n", size);
         return E_INTT_RESULT_FAILURE;
     }
-    uint32_t* instr = call;
+    uint32_t* instr = code;
+
+    /* a blr through a register becomes a bl; the register keeps the pointer, as after a blr. */
+    if ((*instr & 0xfffffc1f) == 0xd63f0000)
+        *instr = 0x94000000;
 
     /* check if its a bl instruction (opcode bits 31-26 = 0x25). */
     if ((*instr & 0xfc000000) != 0x94000000) {
@@ -214,10 +242,10 @@ patch_relative_barm64(void* call, const size_t size, const void* new_target) {
     uint64_t target = (uint64_t)new_target;
     int64_t offset64 = (int64_t)(target - pc);
 
-    /* check 26-bit signed range (+128mb). */
-    if (offset64 > 0x3ffffff || offset64 < -0x4000000) {
+    /* check 26-bit signed range of words (+/-128mb). */
+    if (offset64 > 0x7fffffc || offset64 < -0x8000000) {
         /* NOLINTNEXTLINE */
-        fprintf(stderr, "barm64; target out of range (+128mb)\n");
+        fprintf(stderr, "barm64; target out of range (+/-128mb)\n");
         return E_INTT_RESULT_FAILURE;
     }
 
@@ -232,6 +260,106 @@ patch_relative_barm64(void* call, const size_t size, const void* new_target) {
     return E_INTT_RESULT_SUCCESS;
 }
 
+/**
+ * @brief can a relative call reach a target directly?
+ *
+ * @param call the call.
+ * @param target the target.
+ * @param architecture the architecture.
+ * @return if the target is within range of the call.
+ */
+internal bool
+call_reaches(const det_call_t* call, const void* target, arch_t architecture) {
+    int64_t from = (int64_t)(uintptr_t) call->call, to = (int64_t)(uintptr_t) target;
+    switch (architecture.arch) {
+        case CS_ARCH_X86: {
+            /* the call ends where the instruction did, also for a rewritten ff 15. */
+            int64_t offset = to - (from + (int64_t) call->size);
+            return architecture.mode != CS_MODE_64 || (offset <= INT32_MAX && offset >= INT32_MIN);
+        }
+        case CS_ARCH_ARM: {
+            if (call->is_thumb) {
+                int64_t offset = (to & ~(int64_t) 1) - (from + 4);
+                return offset <= 0xfffffe && offset >= -0x1000000;
+            }
+            int64_t offset = to - (from + 8);
+            return offset <= 0x1fffffc && offset >= -0x2000000;
+        }
+        case CS_ARCH_AARCH64: {
+            int64_t offset = to - from;
+            return offset <= 0x7fffffc && offset >= -0x8000000;
+        }
+        default:
+            return true;
+    }
+}
+
+/**
+ * @brief encode the patch of a call, without writing it; it is written as a whole afterwards.
+ *
+ * @param call the call structure info representing the call to be patched.
+ * @param new_target the new target address to set the new call to.
+ * @param code the patched call to be filled in.
+ * @return ref. to intt.h for enum.
+ */
+e_intt_result_t
+patch_encode_call(const det_call_t* call, const void* new_target, uint8_t* code) {
+    if (!call->is_rel || call->size > PATCH_CODE_MAX) {
+        /* NOLINTNEXTLINE */
+        fprintf(stderr, "unknown architecture; cannot patch a non-relative call!\n");
+        return E_INTT_RESULT_FAILURE;
+    }
+    /* NOLINTNEXTLINE */
+    memcpy(code, call->call, call->size);
+
+    /* a target out of range (a mock in a far away shared object) is jumped to from a veneer. */
+    arch_t architecture = get_arch();
+    if (!call_reaches(call, new_target, architecture)) {
+        new_target = tramp_veneer(call->call, new_target, call->is_thumb);
+        if (new_target == 0x0) {
+            /* NOLINTNEXTLINE */
+            fprintf(stderr, "tapi, patch; no veneer could be placed near the call.\n");
+            return E_INTT_RESULT_FAILURE;
+        }
+    }
+
+    /* patch for a specific backend. */
+    switch (architecture.arch) {
+        case CS_ARCH_X86: {
+            if e_intt_passed(patch_relative_bx86(call->call, call->size, new_target, code))
+                return E_INTT_RESULT_SUCCESS;
+            /* NOLINTNEXTLINE */
+            fprintf(stderr, "bx86/64; patching relative call failed.\n");
+            break;
+        }
+        case CS_ARCH_ARM: {
+            /* arm thumb? */
+            if (call->is_thumb) {
+                if e_intt_passed(patch_relative_barmth(call->call, call->size, new_target, code))
+                    return E_INTT_RESULT_SUCCESS;
+            }
+            else if e_intt_passed(patch_relative_barm(call->call, call->size, new_target, code))
+                return E_INTT_RESULT_SUCCESS;
+            /* NOLINTNEXTLINE */
+            fprintf(stderr, "barm32/th; patching relative call failed.\n");
+            break;
+        }
+        case CS_ARCH_AARCH64: {
+            if e_intt_passed(patch_relative_barm64(call->call, call->size, new_target, code))
+                return E_INTT_RESULT_SUCCESS;
+            /* NOLINTNEXTLINE */
+            fprintf(stderr, "barm64; patching relative call failed.\n");
+            break;
+        }
+        default: {
+            /* NOLINTNEXTLINE */
+            fprintf(stderr, "unknown architecture; corrupted?");
+            break;
+        };
+    }
+    return E_INTT_RESULT_FAILURE;
+}
+
 /**
  * @brief binary patch a call to a target using
  *
@@ -241,60 +369,151 @@ patch_relative_barm64(void* call, const size_t size, const void* new_target) {
  */
 int32_t
 patch_call_target(const det_call_t* call, const void* new_target) {
-    /* create a write-protect guard for an entire page. */
-    guard_t* guard = guard_create(call->call, call->size);
+    patch_batch_t batch = { 0 };
+    patch_batch_add(&batch, call, new_target);
+    return patch_batch_commit(&batch) == 1u ? 1u : 0u;
+}
 
-    /* patch for a specific backend. */
-    arch_t architecture = get_arch();
-    if (call->is_rel) {
-        switch (architecture.arch) {
-            case CS_ARCH_X86: {
-                if e_intt_passed(patch_relative_bx86(call->call, call->size, new_target)) {
-                    break;
-                }
-                /* NOLINTNEXTLINE */
-                fprintf(stderr, "bx86/64; patching relative call failed.\n");
-                break;
-            }
-            case CS_ARCH_ARM: {
-                /* arm thumb? */
-                if (call->is_thumb) {
-                    if e_intt_passed(patch_relative_barmth(call->call, call->size, new_target)) {
-                        break;
-                    }
-                }
-                else if e_intt_passed(patch_relative_barm(call->call, call->size, new_target)) {
-                    break;
+/**
+ * @brief add a call to be patched to a batch; nothing is written until patch_batch_commit().
+ *
+ * @param batch the batch to be added to.
+ * @param call the call structure info representing the call to be patched.
+ * @param new_target the new target address to set the new call to.
+ */
+void
+patch_batch_add(patch_batch_t* batch, const det_call_t* call, const void* new_target) {
+    patch_t patch = { .call = *call, .target = new_target, .kind = E_LIVE_KIND_INSN,
+                      .order = batch->patches.length };
+    patch_list_push(&batch->patches, patch);
+}
+
+/**
+ * @brief add raw code to be written to a batch, e.g. an entry patch or a trampoline; the bytes
+ *  are not copied, and have to stay valid until patch_batch_commit().
+ *
+ * @param batch the batch to be added to.
+ * @param address the address to write to.
+ * @param bytes the code to be written.
+ * @param size the size of the code.
+ */
+void
+patch_batch_write(patch_batch_t* batch, void* address, const uint8_t* bytes, size_t size) {
+    patch_t patch = { .call = { .call = address, .size = size }, .bytes = bytes,
+                      .kind = E_LIVE_KIND_CODE };
+    patch_list_push(&batch->patches, patch);
+}
+
+/**
+ * @brief add bytes to be written to a batch, like patch_batch_write(), saying what they are (a
+ *  whole call, or a got slot), for how they are written with live patching.
+ *
+ * @param batch the batch to be added to.
+ * @param address the address to write to.
+ * @param bytes the bytes to be written.
+ * @param size the size of the bytes.
+ * @param kind what is being written.
+ */
+void
+patch_batch_write_as(patch_batch_t* batch, void* address, const uint8_t* bytes, size_t size,
+                     e_live_kind_t kind) {
+    patch_t patch = { .call = { .call = address, .size = size }, .bytes = bytes, .kind = kind,
+                      .order = batch->patches.length };
+    patch_list_push(&batch->patches, patch);
+}
+
+/**
+ * @brief order patches by the address of their call, then by when they were added; qsort isn't
+ *  stable, and the last write to an address has to land last.
+ *
+ * @param a the first patch.
+ * @param b the second patch.
+ * @return the order, as for qsort.
+ */
+internal int
+compare_patches(const void* a, const void* b) {
+    const patch_t* p = a, *q = b;
+    uintptr_t x = (uintptr_t) p->call.call, y = (uintptr_t) q->call.call;
+    if (x != y)
+        return (x > y) - (x < y);
+    return (p->order > q->order) - (p->order < q->order);
+}
+
+/**
+ * @brief write every patch of a batch; the pages are made writable once per contiguous range of
+ *  them, each mapping restored to its own protection after (the mappings are read once for the
+ *  batch), and the instruction cache is flushed once per range. with live patching
+ *  (TAPI_MOCK_LIVE=1) each range is written through live_commit(), so threads running the code
+ *  never see half a patch. the batch is emptied.
+ *
+ * @param batch the batch to be committed.
+ * @return the number of patches written.
+ */
+size_t
+patch_batch_commit(patch_batch_t* batch) {
+    size_t count = batch->patches.length, patched = 0u;
+    bool live = live_enabled();
+    if (count == 0u) {
+        patch_list_free(&batch->patches);
+        return 0u;
+    }
+    patch_t* patches = batch->patches.data;
+    patch_list_sort(&batch->patches, compare_patches);
+
+    /* the mappings are read once, then one set of guards per contiguous range of pages. */
+    guard_maps_t maps = { 0 };
+    if (!e_intt_passed(guard_maps_read(&maps))) {
+        /* NOLINTNEXTLINE */
+        fprintf(stderr, "tapi, patch_batch_commit; could not read the mappings; taking the "
+                        "patched pages to be code.\n");
+    }
+    uintptr_t page = (uintptr_t) guard_page_size();
+    for (size_t first = 0u; first < count;) {
+        uintptr_t start = (uintptr_t) patches[first].call.call & ~(page - 1u);
+        uintptr_t end = ((uintptr_t) patches[first].call.call + patches[first].call.size +
+                         page - 1u) & ~(page - 1u);
+        size_t last = first + 1u;
+        while (last < count && ((uintptr_t) patches[last].call.call & ~(page - 1u)) <= end) {
+            uintptr_t stop = ((uintptr_t) patches[last].call.call + patches[last].call.size +
+                              page - 1u) & ~(page - 1u);
+            if (stop > end) end = stop;
+            last++;
+        }
+
+        /* write every patch within the range. */
+        guard_list_t guards = { 0 };
+        if e_intt_passed(guard_open(&guards, (void*) start, (size_t)(end - start), &maps)) {
+            live_writes_t writes = { 0 };
+            for (size_t i = first; i < last; i++) {
+                patch_t* patch = &patches[i];
+                if (patch->bytes == 0x0) {
+                    if (!e_intt_passed(patch_encode_call(&patch->call, patch->target, patch->code)))
+                        continue;
+                    patch->bytes = patch->code;
                 }
-                /* NOLINTNEXTLINE */
-                fprintf(stderr, "barm32/th; patching relative call failed.\n");
-                break;
-            }
-            case CS_ARCH_AARCH64: {
-                if e_intt_passed(patch_relative_barm64(call->call, call->size, new_target)) {
-                    break;
+                if (live) {
+                    live_write_t write = { patch->call.call, patch->bytes, patch->call.size,
+                                           patch->kind };
+                    live_writes_push(&writes, write);
+                    continue;
                 }
                 /* NOLINTNEXTLINE */
-                fprintf(stderr, "barm64; patching relative call failed.\n");
-                break;
+                memcpy(patch->call.call, patch->bytes, patch->call.size);
+                patched++;
             }
-            default: {
-                /* NOLINTNEXTLINE */
-                fprintf(stderr, "unknown architecture; corrupted?");
-                return 0u;
-            };
+            if (writes.length != 0u)
+                patched += live_commit(writes.data, writes.length);
+            live_writes_free(&writes);
+            guard_close(&guards);
         }
-    } else {
-        /* NOLINTNEXTLINE */
-        fprintf(stderr, "unknown architecture; cannot patch a non-relative call!\n");
-        guard_close(guard);
-        free(guard);
-        return 0u;
-    }
 
-    /* close the guard and flush insn. cache. */
-    guard_close(guard);
-    free(guard);
-    flush_insn_cache(call->call, call->size);
-    return 1u;
-}
\ No newline at end of file
+        /* flush the insn. cache once over the range (ranges can be far apart, e.g. trampolines). */
+        uint8_t* low = patches[first].call.call;
+        uint8_t* high = (uint8_t*) patches[last - 1u].call.call + patches[last - 1u].call.size;
+        flush_insn_cache(low, (size_t)(high - low));
+        first = last;
+    }
+    guard_maps_free(&maps);
+    patch_list_free(&batch->patches);
+    return patched;
+}
@@ -5,9 +5,39 @@
 #ifndef PATCH_H
 #define PATCH_H
 
-/*! @uses det_call_t. */
+/*! @uses det_call_t, e_intt_result_t. */
 #include "det.h"
 
+/*! @uses dyna_define. */
+#include <tapi/dyna.h>
+
+/*! @uses e_live_kind_t. */
+#include "live.h"
+
+/* the longest call that can be patched (an x86 insn. is at most 15 bytes). */
+#define PATCH_CODE_MAX 16u
+
+/** a call to be patched, and where it is to go; or, with bytes, the code to be written over it. */
+typedef struct {
+    det_call_t call;
+    const void* target;
+    const uint8_t* bytes;
+    e_live_kind_t kind; /* how it is written with live patching. */
+    size_t order; /* when it was added; of two writes to the same address, the later wins. */
+    uint8_t code[PATCH_CODE_MAX]; /* the patched call, once encoded. */
+} patch_t;
+
+/* a typed vector of patches. */
+dyna_define(patch_list, patch_t, 8u)
+
+/**
+ * a batch of patches that are written together; the pages of the calls have their protection
+ *  changed once per contiguous range of them, rather than twice per call.
+ */
+typedef struct {
+    patch_list_t patches;
+} patch_batch_t;
+
 /**
  * @brief binary patch a call to a target using
  *
@@ -17,4 +47,65 @@
  */
 int32_t
 patch_call_target(const det_call_t* call, const void* new_target);
+
+/**
+ * @brief encode the patch of a call, without writing it; the call is read from memory, a
+ *  target out of its range goes through a veneer.
+ *
+ * @param call the call structure info representing the call to be patched.
+ * @param new_target the new target address to set the new call to.
+ * @param code the patched call to be filled in, PATCH_CODE_MAX bytes.
+ * @return ref. to intt.h for enum.
+ */
+e_intt_result_t
+patch_encode_call(const det_call_t* call, const void* new_target, uint8_t* code);
+
+/**
+ * @brief add a call to be patched to a batch; nothing is written until patch_batch_commit().
+ *
+ * @param batch the batch to be added to.
+ * @param call the call structure info representing the call to be patched.
+ * @param new_target the new target address to set the new call to.
+ */
+void
+patch_batch_add(patch_batch_t* batch, const det_call_t* call, const void* new_target);
+
+/**
+ * @brief add raw code to be written to a batch, e.g. an entry patch or a trampoline; the bytes
+ *  are not copied, and have to stay valid until patch_batch_commit().
+ *
+ * @param batch the batch to be added to.
+ * @param address the address to write to.
+ * @param bytes the code to be written.
+ * @param size the size of the code.
+ */
+void
+patch_batch_write(patch_batch_t* batch, void* address, const uint8_t* bytes, size_t size);
+
+/**
+ * @brief add bytes to be written to a batch, like patch_batch_write(), saying what they are (a
+ *  whole call, or a got slot), for how they are written with live patching.
+ *
+ * @param batch the batch to be added to.
+ * @param address the address to write to.
+ * @param bytes the bytes to be written.
+ * @param size the size of the bytes.
+ * @param kind what is being written.
+ */
+void
+patch_batch_write_as(patch_batch_t* batch, void* address, const uint8_t* bytes, size_t size,
+                     e_live_kind_t kind);
+
+/**
+ * @brief write every patch of a batch; the pages are made writable once per contiguous range of
+ *  them, each mapping restored to its own protection after (the mappings are read once for the
+ *  batch), and the instruction cache is flushed once per range. with live patching
+ *  (TAPI_MOCK_LIVE=1) each range is written through live_commit(), so threads running the code
+ *  never see half a patch. the batch is emptied.
+ *
+ * @param batch the batch to be committed.
+ * @return the number of patches written.
+ */
+size_t
+patch_batch_commit(patch_batch_t* batch);
 #endif /* PATCH_H */
\ No newline at end of file
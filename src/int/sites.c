@@ -0,0 +1,456 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-10-19
+ */
+#define _GNU_SOURCE
+#include "sites.h"
+
+/*! @uses dl_iterate_phdr, struct dl_phdr_info, ElfW. */
+#include <link.h>
+
+/*! @uses ELFMAG, SELFMAG, SHT_SYMTAB, SHT_DYNSYM, STT_FUNC, STT_NOTYPE, SHF_EXECINSTR, etc... */
+#include <elf.h>
+
+/*! @uses open, O_RDONLY. */
+#include <fcntl.h>
+
+/*! @uses fstat, struct stat. */
+#include <sys/stat.h>
+
+/*! @uses mmap, munmap. */
+#include <sys/mman.h>
+
+/*! @uses close, sysconf. */
+#include <unistd.h>
+
+/*! @uses pthread_t, pthread_create, pthread_join, pthread_mutex_t. */
+#include <pthread.h>
+
+/*! @uses fprintf, stderr. */
+#include <stdio.h>
+
+/*! @uses qsort, getenv, malloc, free. */
+#include <stdlib.h>
+
+/*! @uses memcmp, memcpy, strcmp, strchr. */
+#include <string.h>
+
+/*! @uses uintptr_t. */
+#include <stdint.h>
+
+/*! @uses dyna_define. */
+#include <tapi/dyna.h>
+
+/*! @uses leak_pause, leak_resume. */
+#include "leak.h"
+
+/* most threads the index is built on, and the fewest functions each of them is given. */
+#define SITES_THREADS 8u
+#define SITES_PER_THREAD 64u
+
+/** a range of code of a function found in a symbol table; a function with data in it (an arm
+ *  literal pool) is split into a range per run of code. */
+typedef struct {
+    void* address;
+    size_t size;
+    void* code; /* where the range starts (with the thumb bit on arm, for thumb code). */
+    size_t length;
+} function_t;
+
+/** an arm/ aarch64 mapping symbol; code of a kind, or data, starts at its address. */
+typedef struct {
+    uintptr_t address;
+    char kind; /* 'a' arm, 't' thumb, 'x' aarch64, or 'd' data. */
+} mapping_t;
+
+/* typed vectors of functions, mapping symbols and call sites. */
+dyna_define(functions, function_t, 64u)
+dyna_define(mappings, mapping_t, 64u)
+dyna_define(site_list, site_t, 1u)
+
+/** a range of functions decoded by a single thread, and the call sites found. */
+typedef struct {
+    const function_t* functions;
+    size_t count;
+    site_list_t sites;
+} worker_t;
+
+/* the index, sorted by callee and call address. */
+static pthread_mutex_t l_lock = PTHREAD_MUTEX_INITIALIZER;
+static site_t* l_sites;
+static size_t l_count;
+static bool l_built;
+
+/**
+ * @brief strip what isn't part of the address of a function (the thumb bit on arm).
+ *
+ * @param address the address.
+ * @return the address of the function.
+ */
+internal void*
+function_address(const void* address) {
+#if defined(__arm__)
+    return (void*)((uintptr_t) address & ~(uintptr_t) 1u);
+#else
+    return (void*) address;
+#endif
+}
+
+/**
+ * @brief order mapping symbols by their address.
+ *
+ * @param a the first mapping symbol.
+ * @param b the second mapping symbol.
+ * @return the order, as for qsort.
+ */
+internal int
+compare_mappings(const void* a, const void* b) {
+    uintptr_t x = ((const mapping_t*) a)->address, y = ((const mapping_t*) b)->address;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief push a range of code of a function.
+ *
+ * @param functions the functions to push onto.
+ * @param function the function, with its symbol address and size.
+ * @param start the start of the range.
+ * @param end the end of the range.
+ * @param kind the kind of code in the range, from its mapping symbol, or 0 for none.
+ */
+internal void
+push_range(functions_t* functions, function_t function, uintptr_t start, uintptr_t end,
+           char kind) {
+    if (end <= start || kind == 'd')
+        return;
+    function.code = (void*) start;
+    function.length = (size_t)(end - start);
+#if defined(__arm__)
+    /* the mapping symbol says which instruction set it is, o.w. the function symbol does. */
+    if (kind == 't' || (kind == 0 && ((uintptr_t) function.address & 1u)))
+        function.code = (void*)(start | 1u);
+#endif
+    functions_push(functions, function);
+}
+
+/**
+ * @brief push the ranges of code of a function, leaving out the data the mapping symbols mark
+ *  within it, so a literal pool is never decoded as instructions.
+ *
+ * @param functions the functions to push onto.
+ * @param function the function, with its symbol address and size.
+ * @param mappings the mapping symbols of its object, sorted by address.
+ */
+internal void
+push_function(functions_t* functions, function_t function, const mappings_t* mappings) {
+    uintptr_t start = (uintptr_t) function_address(function.address), end = start + function.size;
+
+    /* the last mapping symbol at or before the start says what the function starts with. */
+    size_t low = 0u, high = mappings->length;
+    while (low < high) {
+        size_t middle = low + (high - low) / 2u;
+        if (mappings->data[middle].address <= start)
+            low = middle + 1u;
+        else high = middle;
+    }
+    char kind = low != 0u ? mappings->data[low - 1u].kind : 0;
+
+    /* and every one within the function starts a new range. */
+    for (size_t i = low; i < mappings->length && mappings->data[i].address < end; i++) {
+        push_range(functions, function, start, mappings->data[i].address, kind);
+        start = mappings->data[i].address;
+        kind = mappings->data[i].kind;
+    }
+    push_range(functions, function, start, end, kind);
+}
+
+/**
+ * @brief collect every defined, executable function from the symbol table of an elf file.
+ *
+ * @param path the path of the file.
+ * @param bias the address the file is loaded at.
+ * @param functions the functions to push onto.
+ */
+internal void
+collect_symbols(const char* path, uintptr_t bias, functions_t* functions) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t) st.st_size < sizeof(ElfW(Ehdr))) {
+        close(fd);
+        return;
+    }
+    size_t length = (size_t) st.st_size;
+    const uint8_t* base = mmap(0x0, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED)
+        return;
+
+    /* only the native class, and only if the section headers are within the file. */
+    const ElfW(Ehdr)* ehdr = (const ElfW(Ehdr)*) base;
+    if (memcmp(ehdr->e_ident, ELFMAG, SELFMAG) != 0 || ehdr->e_shoff == 0u ||
+        ehdr->e_shoff + (size_t) ehdr->e_shnum * sizeof(ElfW(Shdr)) > length) {
+        munmap((void*) base, length);
+        return;
+    }
+    const ElfW(Shdr)* sections = (const ElfW(Shdr)*)(base + ehdr->e_shoff);
+
+    /* prefer the full symbol table, stripped files only have the dynamic one. */
+    const ElfW(Shdr)* table = 0x0;
+    for (size_t i = 0u; i < ehdr->e_shnum; i++) {
+        if (sections[i].sh_type == SHT_SYMTAB) {
+            table = &sections[i];
+            break;
+        }
+        if (sections[i].sh_type == SHT_DYNSYM)
+            table = &sections[i];
+    }
+    if (table == 0x0 || table->sh_offset + table->sh_size > length) {
+        munmap((void*) base, length);
+        return;
+    }
+
+    /* the mapping symbols ($a, $t, $x and $d, maybe with a suffix) are only in the full table. */
+    const ElfW(Sym)* symbols = (const ElfW(Sym)*)(base + table->sh_offset);
+    size_t count = table->sh_size / sizeof(ElfW(Sym));
+    mappings_t mappings = { 0 };
+    const ElfW(Shdr)* strings = table->sh_link < ehdr->e_shnum ? &sections[table->sh_link] : 0x0;
+    if (strings != 0x0 && strings->sh_offset + strings->sh_size <= length) {
+        const char* names = (const char*)(base + strings->sh_offset);
+        for (size_t i = 0u; i < count; i++) {
+            const ElfW(Sym)* symbol = &symbols[i];
+            const char* name = names + symbol->st_name;
+            if (ELF64_ST_TYPE(symbol->st_info) != STT_NOTYPE || symbol->st_name + 3u >
+                strings->sh_size || name[0] != '$' || (name[2] != '\0' && name[2] != '.') ||
+                strchr("atxd", name[1]) == 0x0 || name[1] == '\0')
+                continue;
+            mapping_t mapping = { (uintptr_t) function_address((void*)(bias + symbol->st_value)),
+                                  name[1] };
+            mappings_push(&mappings, mapping);
+        }
+        mappings_sort(&mappings, compare_mappings);
+    }
+
+    /* every defined function in an executable section (st_info is the same for either class). */
+    for (size_t i = 0u; i < count; i++) {
+        const ElfW(Sym)* symbol = &symbols[i];
+        if (ELF64_ST_TYPE(symbol->st_info) != STT_FUNC || symbol->st_size == 0u ||
+            symbol->st_shndx == SHN_UNDEF || symbol->st_shndx >= ehdr->e_shnum ||
+            !(sections[symbol->st_shndx].sh_flags & SHF_EXECINSTR))
+            continue;
+        function_t function = { (void*)(bias + symbol->st_value), symbol->st_size, 0x0, 0u };
+        push_function(functions, function, &mappings);
+    }
+    mappings_free(&mappings);
+    munmap((void*) base, length);
+}
+
+/* what collect_object() is given. */
+typedef struct {
+    functions_t* functions;
+    bool shared;
+} collect_t;
+
+/**
+ * @brief collect the functions of a loaded object; the executable is always first.
+ *
+ * @param info the object.
+ * @param size the size of info.
+ * @param data the collect_t.
+ * @return 0, to keep iterating.
+ */
+internal int
+collect_object(struct dl_phdr_info* info, size_t size, void* data) {
+    (void) size;
+    collect_t* collect = data;
+    if (info->dlpi_name == 0x0 || info->dlpi_name[0] == '\0') {
+        /* the executable has no name, but it can always be found. */
+        collect_symbols("/proc/self/exe", (uintptr_t) info->dlpi_addr, collect->functions);
+        return 0;
+    }
+    if (collect->shared)
+        collect_symbols(info->dlpi_name, (uintptr_t) info->dlpi_addr, collect->functions);
+    return 0;
+}
+
+/**
+ * @brief order ranges of functions by their address.
+ *
+ * @param a the first function.
+ * @param b the second function.
+ * @return the order, as for qsort.
+ */
+internal int
+compare_functions(const void* a, const void* b) {
+    uintptr_t x = (uintptr_t)((const function_t*) a)->code;
+    uintptr_t y = (uintptr_t)((const function_t*) b)->code;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief order call sites by their callee, and then by where the call is.
+ *
+ * @param a the first call site.
+ * @param b the second call site.
+ * @return the order, as for qsort.
+ */
+internal int
+compare_sites(const void* a, const void* b) {
+    const site_t* x = a, *y = b;
+    if (x->callee != y->callee)
+        return (uintptr_t) x->callee > (uintptr_t) y->callee ? 1 : -1;
+    return (x->call.call > y->call.call) - (x->call.call < y->call.call);
+}
+
+/**
+ * @brief decode a range of functions, collecting their call sites.
+ *
+ * @param arg the worker_t.
+ * @return 0x0.
+ */
+internal void*
+worker_run(void* arg) {
+    /* the index belongs to tapi, whatever test happens to be running. */
+    leak_pause();
+    worker_t* worker = arg;
+    det_scan_t scan;
+    for (size_t i = 0u; i < worker->count; i++) {
+        const function_t* function = &worker->functions[i];
+        if (!e_intt_passed(det_decode(function->code, function->length, &scan)))
+            break;
+        for (size_t j = 0u; j < scan.count; j++) {
+            site_t site = { function_address(scan.calls[j].dest), function->address,
+                            function->size, scan.calls[j] };
+            site_list_push(&worker->sites, site);
+        }
+    }
+    det_close();
+    leak_resume();
+    return 0x0;
+}
+
+/**
+ * @brief build the index of every call site in the executable (and, with TAPI_MOCK_SHARED=1, in
+ *  every loaded shared object) from the function symbols, decoding them on several threads; it
+ *  is only built once, the first time, and should be built before any code is patched.
+ *
+ * @return ref. to intt.h for enum, fails if no function could be found.
+ */
+e_intt_result_t
+sites_build(void) {
+    pthread_mutex_lock(&l_lock);
+    if (l_built) {
+        pthread_mutex_unlock(&l_lock);
+        return l_count != 0u ? E_INTT_RESULT_SUCCESS : E_INTT_RESULT_FAILURE;
+    }
+    l_built = true;
+    leak_pause();
+
+    /* find every range of code once, aliases share an address. */
+    functions_t functions = { 0 };
+    const char* shared = getenv("TAPI_MOCK_SHARED");
+    collect_t collect = { &functions, shared != 0x0 && strcmp(shared, "0") != 0 };
+    dl_iterate_phdr(collect_object, &collect);
+    functions_sort(&functions, compare_functions);
+    size_t unique = 0u;
+    for (size_t i = 0u; i < functions.length; i++) {
+        if (unique == 0u || functions.data[unique - 1u].code != functions.data[i].code)
+            functions.data[unique++] = functions.data[i];
+    }
+    functions.length = unique;
+    if (unique == 0u) {
+        /* NOLINTNEXTLINE */
+        fprintf(stderr, "tapi, sites_build; no function symbols found; is the program stripped?\n");
+        functions_free(&functions);
+        leak_resume();
+        pthread_mutex_unlock(&l_lock);
+        return E_INTT_RESULT_FAILURE;
+    }
+
+    /* split them into ranges, one per thread. */
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t threads = cpus > 0 ? (size_t) cpus : 1u;
+    if (threads > SITES_THREADS) threads = SITES_THREADS;
+    if (threads > unique / SITES_PER_THREAD) threads = unique / SITES_PER_THREAD;
+    if (threads == 0u) threads = 1u;
+    worker_t workers[SITES_THREADS] = { 0 };
+    pthread_t handles[SITES_THREADS];
+    bool started[SITES_THREADS] = { 0 };
+    size_t per = (unique + threads - 1u) / threads;
+    for (size_t i = 0u; i < threads; i++) {
+        size_t first = i * per;
+        workers[i].functions = functions.data + first;
+        workers[i].count = first >= unique ? 0u : (unique - first < per ? unique - first : per);
+        started[i] = pthread_create(&handles[i], 0x0, worker_run, &workers[i]) == 0;
+    }
+
+    /* a range whose thread could not be started is decoded here instead. */
+    for (size_t i = 0u; i < threads; i++) {
+        if (started[i])
+            pthread_join(handles[i], 0x0);
+        else worker_run(&workers[i]);
+    }
+
+    /* merge and sort them for searching. */
+    size_t total = 0u;
+    for (size_t i = 0u; i < threads; i++)
+        total += workers[i].sites.length;
+    l_sites = total != 0u ? malloc(sizeof *l_sites * total) : 0x0;
+    l_count = 0u;
+    for (size_t i = 0u; i < threads; i++) {
+        if (l_sites != 0x0 && workers[i].sites.length != 0u) {
+            /* NOLINTNEXTLINE */
+            memcpy(l_sites + l_count, workers[i].sites.data,
+                   sizeof *l_sites * workers[i].sites.length);
+            l_count += workers[i].sites.length;
+        }
+        site_list_free(&workers[i].sites);
+    }
+    if (l_count > 1u)
+        qsort(l_sites, l_count, sizeof *l_sites, compare_sites);
+    functions_free(&functions);
+    leak_resume();
+    pthread_mutex_unlock(&l_lock);
+    return l_count != 0u ? E_INTT_RESULT_SUCCESS : E_INTT_RESULT_FAILURE;
+}
+
+/**
+ * @brief find every call site of a function.
+ *
+ * @param callee the called function.
+ * @param count the number of call sites to be filled in.
+ * @return the first call site, or 0x0 if there are none (or no index).
+ */
+const site_t*
+sites_find(const void* callee, size_t* count) {
+    *count = 0u;
+    uintptr_t key = (uintptr_t) function_address(callee);
+
+    /* the first site whose callee isn't below the key. */
+    size_t low = 0u, high = l_count;
+    while (low < high) {
+        size_t middle = low + (high - low) / 2u;
+        if ((uintptr_t) l_sites[middle].callee < key)
+            low = middle + 1u;
+        else high = middle;
+    }
+
+    /* and the run of them. */
+    size_t end = low;
+    while (end < l_count && (uintptr_t) l_sites[end].callee == key)
+        end++;
+    *count = end - low;
+    return *count != 0u ? &l_sites[low] : 0x0;
+}
+
+/** @brief release the index; the next sites_build() starts over. */
+void
+sites_release(void) {
+    pthread_mutex_lock(&l_lock);
+    free(l_sites);
+    l_sites = 0x0;
+    l_count = 0u;
+    l_built = false;
+    pthread_mutex_unlock(&l_lock);
+}
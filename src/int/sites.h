@@ -0,0 +1,51 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-10-19
+ */
+#ifndef SITES_H
+#define SITES_H
+
+/*! @uses size_t. */
+#include <stddef.h>
+
+/*! @uses det_call_t. */
+#include "det.h"
+
+/*! @uses e_intt_result_t. */
+#include "intt.h"
+
+/**
+ * a call site within the program; the index is sorted by callee, and then by the address of the
+ *  call, so every caller of a function is a contiguous run.
+ */
+typedef struct {
+    void* callee; /* the called address (without the thumb bit on arm). */
+    void* function; /* the function the call is in (as its symbol gives it). */
+    size_t size; /* the size of that function. */
+    det_call_t call; /* the call itself, ready to be patched. */
+} site_t;
+
+/**
+ * @brief build the index of every call site in the executable (and, with TAPI_MOCK_SHARED=1, in
+ *  every loaded shared object) from the function symbols, decoding them on several threads; it
+ *  is only built once, the first time, and should be built before any code is patched.
+ *
+ * @return ref. to intt.h for enum, fails if no function could be found.
+ */
+e_intt_result_t
+sites_build(void);
+
+/**
+ * @brief find every call site of a function.
+ *
+ * @param callee the called function.
+ * @param count the number of call sites to be filled in.
+ * @return the first call site, or 0x0 if there are none (or no index).
+ */
+const site_t*
+sites_find(const void* callee, size_t* count);
+
+/** @brief release the index; the next sites_build() starts over. */
+void
+sites_release(void);
+#endif /* SITES_H */
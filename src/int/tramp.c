@@ -0,0 +1,1063 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-10-19
+ */
+#define _GNU_SOURCE
+#include "tramp.h"
+
+/*! @uses mmap, munmap, PROT_READ, PROT_EXEC, MAP_ANONYMOUS. */
+#include <sys/mman.h>
+
+/*! @uses pthread_mutex_t, pthread_mutex_lock, pthread_mutex_unlock. */
+#include <pthread.h>
+
+/*! @uses fprintf, stderr. */
+#include <stdio.h>
+
+/*! @uses memcpy, memset. */
+#include <string.h>
+
+/*! @uses bool, true, false. */
+#include <stdbool.h>
+
+/*! @uses dyna_define. */
+#include <tapi/dyna.h>
+
+/*! @uses arch_t, get_arch. */
+#include "arch.h"
+
+/*! @uses det_prologue_t, det_prologue, det_scan. */
+#include "det.h"
+
+/*! @uses guard_list_t, guard_open, guard_close, guard_page_size. */
+#include "guard.h"
+
+/*! @uses leak_pause, leak_resume. */
+#include "leak.h"
+
+/* the most code a trampoline can take; a displaced instruction grows to at most 24 bytes. */
+#define TRAMP_CODE_MAX (DET_PROLOGUE_MAX * 24u + 32u)
+
+/* the code is placed near what branches to it: on x86_64 within 1gb (for rip-relative operands
+ *  too), on aarch64 within 64mb (a bl reaches 128mb), on arm within 8mb (a thumb bl reaches 16mb);
+ *  a rel32 on i386 reaches everywhere. */
+#if defined(__x86_64__)
+#define TRAMP_NEAR_RANGE (1ull << 30u)
+#elif defined(__aarch64__)
+#define TRAMP_NEAR_RANGE (1ull << 26u)
+#elif defined(__arm__)
+#define TRAMP_NEAR_RANGE (1ull << 23u)
+#endif
+#define TRAMP_NEAR_STEP (TRAMP_NEAR_RANGE >> 6u)
+
+/** a page of trampolines, and how much of it is used. */
+typedef struct {
+    uint8_t* base;
+    size_t used;
+} tramp_page_t;
+
+/* a typed vector of the pages. */
+dyna_define(tramp_pages, tramp_page_t, 4u)
+
+/** a veneer, an absolute jump to a destination out of range of a call. */
+typedef struct {
+    const void* dest;
+    void* code;
+    bool is_thumb;
+} tramp_veneer_t;
+
+/* a typed vector of the veneers. */
+dyna_define(tramp_veneers, tramp_veneer_t, 8u)
+
+/* every page of trampolines, and the veneers in them, shared between threads. */
+static pthread_mutex_t l_lock = PTHREAD_MUTEX_INITIALIZER;
+static tramp_pages_t l_pages;
+static tramp_veneers_t l_veneers;
+
+/** code being generated for where it will run. */
+typedef struct {
+    uintptr_t base; /* where the code will run. */
+    uint8_t bytes[TRAMP_CODE_MAX];
+    size_t size;
+    bool overflow;
+} emit_t;
+
+/**
+ * @brief append code.
+ *
+ * @param emit the code.
+ * @param bytes the bytes to be appended.
+ * @param size the number of bytes.
+ */
+internal void
+emit_bytes(emit_t* emit, const void* bytes, size_t size) {
+    if (emit->size + size > sizeof emit->bytes) {
+        emit->overflow = true;
+        return;
+    }
+    /* NOLINTNEXTLINE */
+    memcpy(emit->bytes + emit->size, bytes, size);
+    emit->size += size;
+}
+
+/* append a value of each width, in the byte order of the machine. */
+internal void emit_u8(emit_t* emit, uint8_t value) { emit_bytes(emit, &value, 1u); }
+internal void emit_u16(emit_t* emit, uint16_t value) { emit_bytes(emit, &value, 2u); }
+internal void emit_u32(emit_t* emit, uint32_t value) { emit_bytes(emit, &value, 4u); }
+internal void emit_u64(emit_t* emit, uint64_t value) { emit_bytes(emit, &value, 8u); }
+
+/** @return where the next byte will run. */
+internal uintptr_t
+emit_pc(const emit_t* emit) {
+    return emit->base + emit->size;
+}
+
+/**
+ * @brief sign extend the low bits of a value.
+ *
+ * @param value the value, masked to its bits.
+ * @param bits the number of bits.
+ * @return the value.
+ */
+internal int64_t
+sign_extend(uint64_t value, uint32_t bits) {
+    uint64_t sign = 1ull << (bits - 1u);
+    return (int64_t)((value ^ sign) - sign);
+}
+
+/**
+ * @brief does a branch land within the displaced instructions? it would land on the patch; from
+ *  a displaced instruction, a branch back to the start would go to the mock rather than loop.
+ *
+ * @param prologue the displaced instructions.
+ * @param dest the destination of the branch.
+ * @param with_start if a branch to the start counts.
+ * @return if it does.
+ */
+internal bool
+is_displaced(const det_prologue_t* prologue, uintptr_t dest, bool with_start) {
+    uintptr_t start = (uintptr_t) prologue->address;
+    dest &= ~(uintptr_t)(prologue->is_thumb ? 1u : 0u);
+    return (dest > start || (with_start && dest == start)) && dest < start + prologue->size;
+}
+
+/**
+ * @brief is a displaced instruction a call of any kind, leaving a return address into the
+ *  function behind?
+ *
+ * @param insn the instruction.
+ * @param architecture the architecture.
+ * @param is_thumb if the function is thumb.
+ * @return if it is.
+ */
+internal bool
+is_call(const det_insn_t* insn, arch_t architecture, bool is_thumb) {
+    const uint8_t* bytes = insn->bytes;
+    if (architecture.arch == CS_ARCH_X86) {
+        /* a call rel32, or call/ lcall through a register or memory, past any prefixes. */
+        size_t i = 0u;
+        while (i < insn->size && (bytes[i] == 0x26 || bytes[i] == 0x2e || bytes[i] == 0x36 ||
+                                  bytes[i] == 0x3e || bytes[i] == 0x64 || bytes[i] == 0x65 ||
+                                  bytes[i] == 0x66 || bytes[i] == 0x67 || bytes[i] == 0xf2 ||
+                                  bytes[i] == 0xf3 || (architecture.mode == CS_MODE_64 &&
+                                                       (bytes[i] & 0xf0) == 0x40)))
+            i++;
+        if (i < insn->size && bytes[i] == 0xe8)
+            return true;
+        return i + 1u < insn->size && bytes[i] == 0xff && (((bytes[i + 1u] >> 3u) & 7u) == 2u ||
+                                                           ((bytes[i + 1u] >> 3u) & 7u) == 3u);
+    }
+    if (is_thumb) {
+        /* bl, blx (imm.), and blx through a register. */
+        uint16_t hw0 = (uint16_t)(bytes[0] | (bytes[1] << 8u));
+        uint16_t hw1 = (uint16_t)(bytes[2] | (bytes[3] << 8u));
+        if (insn->size == 4u)
+            return (hw0 & 0xf800) == 0xf000 && (hw1 & 0xc000) == 0xc000;
+        return (hw0 & 0xff87) == 0x4780;
+    }
+    uint32_t w;
+    /* NOLINTNEXTLINE */
+    memcpy(&w, bytes, 4u);
+    if (architecture.arch == CS_ARCH_AARCH64)
+        return (w & 0xfc000000) == 0x94000000 || (w & 0xfffffc1f) == 0xd63f0000;
+    /* bl, blx (imm.), and blx through a register. */
+    return ((w & 0x0f000000) == 0x0b000000 && (w >> 28u) != 0xfu) ||
+           (w & 0xfe000000) == 0xfa000000 || (w & 0x0ffffff0) == 0x012fff30;
+}
+
+/**
+ * @brief emit an unconditional jump; jmp [rip] with the address after it on x86_64, so it reaches
+ *  anywhere, o.w. a jmp rel32.
+ *
+ * @param emit the code.
+ * @param dest the destination.
+ * @param is_64 if this is x86_64.
+ */
+internal void
+emit_jump_bx86(emit_t* emit, uintptr_t dest, bool is_64) {
+    if (is_64) {
+        const uint8_t code[] = { 0xff, 0x25, 0x00, 0x00, 0x00, 0x00 };
+        emit_bytes(emit, code, sizeof code);
+        emit_u64(emit, dest);
+        return;
+    }
+    emit_u8(emit, 0xe9);
+    emit_u32(emit, (uint32_t)(dest - (emit_pc(emit) + 4u)));
+}
+
+/**
+ * @brief the register loaded by an i386 pc thunk (mov reg, [esp]; ret), if a call goes to one.
+ *
+ * @param dest the destination of the call.
+ * @return the register, or -1 if it isn't a pc thunk.
+ */
+internal int32_t
+pc_thunk_bx86(const void* dest) {
+    const uint8_t* code = dest;
+    if (code[0] == 0x8b && (code[1] & 0xc7) == 0x04 && code[2] == 0x24 && code[3] == 0xc3)
+        return (code[1] >> 3u) & 7u;
+    return -1;
+}
+
+/**
+ * @brief relocate a displaced instruction on x86 architectures.
+ *
+ * @param emit the code.
+ * @param insn the instruction.
+ * @param prologue the displaced instructions.
+ * @param is_64 if this is x86_64.
+ * @return ref. to intt.h for enum.
+ */
+internal e_intt_result_t
+relocate_bx86(emit_t* emit, const det_insn_t* insn, const det_prologue_t* prologue, bool is_64) {
+    uintptr_t dest = (uintptr_t) insn->dest;
+    if ((insn->kind == E_DET_INSN_JUMP || insn->kind == E_DET_INSN_JCC) &&
+        is_displaced(prologue, dest, true)) {
+        /* NOLINTNEXTLINE */
+        fprintf(stderr, "bx86/64; branch into the displaced instructions at %p.\n",
+                insn->address);
+        return E_INTT_RESULT_FAILURE;
+    }
+    switch (insn->kind) {
+        case E_DET_INSN_PLAIN: {
+            emit_bytes(emit, insn->bytes, insn->size);
+            return E_INTT_RESULT_SUCCESS;
+        }
+        case E_DET_INSN_PCREL: {
+            /* the same instruction, with its displacement from the new address. */
+            int64_t disp = (int64_t) dest - (int64_t)(emit_pc(emit) + insn->size);
+            if (disp > INT32_MAX || disp < INT32_MIN) {
+                /* NOLINTNEXTLINE */
+                fprintf(stderr, "bx86/64; trampoline out of range of a rip-relative operand.\n");
+                return E_INTT_RESULT_FAILURE;
+            }
+            int32_t disp32 = (int32_t) disp;
+            size_t at = emit->size;
+            emit_bytes(emit, insn->bytes, insn->size);
+            if (!emit->overflow) {
+                /* NOLINTNEXTLINE */
+                memcpy(emit->bytes + at + insn->disp_offset, &disp32, 4u);
+            }
+            return E_INTT_RESULT_SUCCESS;
+        }
+        case E_DET_INSN_JUMP: {
+            emit_jump_bx86(emit, dest, is_64);
+            return E_INTT_RESULT_SUCCESS;
+        }
+        case E_DET_INSN_JCC: {
+            /* find the condition, past any branch hint/ bnd prefixes. */
+            size_t i = 0u;
+            while (i < insn->size && (insn->bytes[i] == 0x2e || insn->bytes[i] == 0x3e ||
+                                      insn->bytes[i] == 0xf2))
+                i++;
+            int32_t cc = -1;
+            if (i < insn->size && (insn->bytes[i] & 0xf0) == 0x70)
+                cc = insn->bytes[i] & 0x0f;
+            else if (i + 1u < insn->size && insn->bytes[i] == 0x0f &&
+                     (insn->bytes[i + 1u] & 0xf0) == 0x80)
+                cc = insn->bytes[i + 1u] & 0x0f;
+            if (cc < 0)
+                break;
+            if (is_64) {
+                /* the inverted condition jumps over an absolute jump. */
+                emit_u8(emit, 0x70 | (cc ^ 1));
+                emit_u8(emit, 14u);
+                emit_jump_bx86(emit, dest, true);
+            }
+            else {
+                emit_u8(emit, 0x0f);
+                emit_u8(emit, 0x80 | cc);
+                emit_u32(emit, (uint32_t)(dest - (emit_pc(emit) + 4u)));
+            }
+            return E_INTT_RESULT_SUCCESS;
+        }
+        case E_DET_INSN_CALL: {
+            if (is_64) {
+                /* call [rip+2]; jmp over the address; the address. */
+                const uint8_t code[] = { 0xff, 0x15, 0x02, 0x00, 0x00, 0x00, 0xeb, 0x08 };
+                emit_bytes(emit, code, sizeof code);
+                emit_u64(emit, dest);
+                return E_INTT_RESULT_SUCCESS;
+            }
+
+            /* a pc thunk would give the address of the trampoline, so we load the real one. */
+            int32_t reg = pc_thunk_bx86(insn->dest);
+            if (reg >= 0) {
+                emit_u8(emit, (uint8_t)(0xb8 + reg));
+                emit_u32(emit, (uint32_t)((uintptr_t) insn->address + insn->size));
+                return E_INTT_RESULT_SUCCESS;
+            }
+            emit_u8(emit, 0xe8);
+            emit_u32(emit, (uint32_t)(dest - (emit_pc(emit) + 4u)));
+            return E_INTT_RESULT_SUCCESS;
+        }
+        default:
+            break;
+    }
+    /* NOLINTNEXTLINE */
+    fprintf(stderr, "bx86/64; cannot relocate instruction at %p.\n", insn->address);
+    return E_INTT_RESULT_FAILURE;
+}
+
+/**
+ * @brief build the entry patch on x86 architectures; a jmp rel32, or on x86_64 a jmp [rip] if the
+ *  mocked function is out of range of one.
+ *
+ * @param tramp the entry patch to be filled in.
+ * @param mocked the function it is to jump to.
+ * @param is_64 if this is x86_64.
+ */
+internal void
+entry_bx86(tramp_t* tramp, const void* mocked, bool is_64) {
+    emit_t emit = { .base = (uintptr_t) tramp->entry };
+    int64_t offset = (int64_t)(uintptr_t) mocked - (int64_t)((uintptr_t) tramp->entry + 5u);
+    if (!is_64 || (offset <= INT32_MAX && offset >= INT32_MIN)) {
+        emit_u8(&emit, 0xe9);
+        emit_u32(&emit, (uint32_t) offset);
+    }
+    else emit_jump_bx86(&emit, (uintptr_t) mocked, true);
+    /* NOLINTNEXTLINE */
+    memcpy(tramp->entry_bytes, emit.bytes, emit.size);
+    tramp->size = emit.size;
+}
+
+/**
+ * @brief emit an unconditional jump; ldr x16, #8; br x16; and the address.
+ *
+ * @param emit the code.
+ * @param dest the destination.
+ */
+internal void
+emit_jump_barm64(emit_t* emit, uintptr_t dest) {
+    emit_u32(emit, 0x58000050);
+    emit_u32(emit, 0xd61f0200);
+    emit_u64(emit, dest);
+}
+
+/**
+ * @brief emit a load of an address into a register; ldr xd, #8; b #12; and the address.
+ *
+ * @param emit the code.
+ * @param reg the register.
+ * @param value the address.
+ */
+internal void
+emit_load_barm64(emit_t* emit, uint32_t reg, uintptr_t value) {
+    emit_u32(emit, 0x58000040 | reg);
+    emit_u32(emit, 0x14000003);
+    emit_u64(emit, value);
+}
+
+/**
+ * @brief relocate a displaced instruction on aarch64; every pc-relative class is rewritten from
+ *  its encoding (b, bl, b.cond, cbz, tbz, adr, adrp and ldr literal).
+ *
+ * @param emit the code.
+ * @param insn the instruction.
+ * @param prologue the displaced instructions.
+ * @return ref. to intt.h for enum.
+ */
+internal e_intt_result_t
+relocate_barm64(emit_t* emit, const det_insn_t* insn, const det_prologue_t* prologue) {
+    uint32_t w;
+    /* NOLINTNEXTLINE */
+    memcpy(&w, insn->bytes, 4u);
+    uintptr_t pc = (uintptr_t) insn->address, dest = 0u;
+
+    /* b, bl. */
+    if ((w & 0x7c000000) == 0x14000000) {
+        dest = pc + (uintptr_t)(sign_extend(w & 0x03ffffff, 26u) * 4);
+        if (is_displaced(prologue, dest, true))
+            goto displaced;
+        if (w & 0x80000000) {
+            /* ldr x16, #8; b #12; the address; blr x16. */
+            emit_load_barm64(emit, 16u, dest);
+            emit_u32(emit, 0xd63f0200);
+        }
+        else emit_jump_barm64(emit, dest);
+        return E_INTT_RESULT_SUCCESS;
+    }
+
+    /* b.cond, cbz/cbnz and tbz/tbnz; the inverted condition jumps over an absolute jump. */
+    if ((w & 0xff000010) == 0x54000000) {
+        dest = pc + (uintptr_t)(sign_extend((w >> 5u) & 0x7ffff, 19u) * 4);
+        if (is_displaced(prologue, dest, true))
+            goto displaced;
+        if ((w & 0xf) < 14u)
+            emit_u32(emit, 0x54000000 | (5u << 5u) | ((w & 0xf) ^ 1u));
+        emit_jump_barm64(emit, dest);
+        return E_INTT_RESULT_SUCCESS;
+    }
+    if ((w & 0x7e000000) == 0x34000000) {
+        dest = pc + (uintptr_t)(sign_extend((w >> 5u) & 0x7ffff, 19u) * 4);
+        if (is_displaced(prologue, dest, true))
+            goto displaced;
+        emit_u32(emit, ((w & 0xff00001f) ^ 0x01000000) | (5u << 5u));
+        emit_jump_barm64(emit, dest);
+        return E_INTT_RESULT_SUCCESS;
+    }
+    if ((w & 0x7e000000) == 0x36000000) {
+        dest = pc + (uintptr_t)(sign_extend((w >> 5u) & 0x3fff, 14u) * 4);
+        if (is_displaced(prologue, dest, true))
+            goto displaced;
+        emit_u32(emit, ((w & 0xfff8001f) ^ 0x01000000) | (5u << 5u));
+        emit_jump_barm64(emit, dest);
+        return E_INTT_RESULT_SUCCESS;
+    }
+
+    /* adr, adrp. */
+    if ((w & 0x1f000000) == 0x10000000) {
+        int64_t imm = sign_extend((((w >> 5u) & 0x7ffff) << 2u) | ((w >> 29u) & 3u), 21u);
+        uintptr_t value = (w & 0x80000000) ? (pc & ~(uintptr_t) 0xfff) + (uintptr_t)(imm * 4096)
+                                           : pc + (uintptr_t) imm;
+        emit_load_barm64(emit, w & 0x1f, value);
+        return E_INTT_RESULT_SUCCESS;
+    }
+
+    /* ldr literal; the address is loaded into x17, and the load made from it. */
+    if ((w & 0x3b000000) == 0x18000000) {
+        uint32_t opc = w >> 30u, rt = w & 0x1f;
+        uintptr_t address = pc + (uintptr_t)(sign_extend((w >> 5u) & 0x7ffff, 19u) * 4);
+        if (w & 0x04000000) {
+            /* NOLINTNEXTLINE */
+            fprintf(stderr, "barm64; cannot relocate a simd ldr literal.\n");
+            return E_INTT_RESULT_FAILURE;
+        }
+        if (opc == 3u) {
+            /* prfm, only a hint; a nop. */
+            emit_u32(emit, 0xd503201f);
+            return E_INTT_RESULT_SUCCESS;
+        }
+        const uint32_t loads[] = { 0xb9400000, 0xf9400000, 0xb9800000 };
+        emit_load_barm64(emit, 17u, address);
+        emit_u32(emit, loads[opc] | (17u << 5u) | rt);
+        return E_INTT_RESULT_SUCCESS;
+    }
+
+    /* anything else doesn't read the pc. */
+    emit_u32(emit, w);
+    return E_INTT_RESULT_SUCCESS;
+
+displaced:
+    /* NOLINTNEXTLINE */
+    fprintf(stderr, "barm64; branch into the displaced instructions at %p.\n", insn->address);
+    return E_INTT_RESULT_FAILURE;
+}
+
+/**
+ * @brief build the entry patch on aarch64; a b, or an absolute jump if the mocked function is out
+ *  of range of one.
+ *
+ * @param tramp the entry patch to be filled in.
+ * @param mocked the function it is to jump to.
+ */
+internal void
+entry_barm64(tramp_t* tramp, const void* mocked) {
+    emit_t emit = { .base = (uintptr_t) tramp->entry };
+    int64_t offset = (int64_t)(uintptr_t) mocked - (int64_t)(uintptr_t) tramp->entry;
+    if (offset <= 0x7ffffff && offset >= -0x8000000)
+        emit_u32(&emit, 0x14000000 | ((uint32_t)(offset >> 2) & 0x03ffffff));
+    else emit_jump_barm64(&emit, (uintptr_t) mocked);
+    /* NOLINTNEXTLINE */
+    memcpy(tramp->entry_bytes, emit.bytes, emit.size);
+    tramp->size = emit.size;
+}
+
+/**
+ * @brief relocate a displaced instruction on arm32; b, bl, blx and ldr literal are rewritten to
+ *  load their address, anything else that reads the pc is refused.
+ *
+ * @param emit the code.
+ * @param insn the instruction.
+ * @param prologue the displaced instructions.
+ * @return ref. to intt.h for enum.
+ */
+internal e_intt_result_t
+relocate_barm(emit_t* emit, const det_insn_t* insn, const det_prologue_t* prologue) {
+    uint32_t w;
+    /* NOLINTNEXTLINE */
+    memcpy(&w, insn->bytes, 4u);
+    uintptr_t pc = (uintptr_t) insn->address;
+    uint32_t cond = w & 0xf0000000;
+
+    /* b, bl, and blx (imm.) which is always taken and goes to thumb. */
+    bool is_blx = (w & 0xfe000000) == 0xfa000000;
+    if (is_blx || (cond != 0xf0000000 && (w & 0x0e000000) == 0x0a000000)) {
+        uintptr_t dest = pc + 8u + (uintptr_t)(sign_extend(w & 0x00ffffff, 24u) * 4);
+        if (is_blx) {
+            dest = (dest + ((w >> 23u) & 2u)) | 1u;
+            cond = 0xe0000000;
+        }
+        if (is_displaced(prologue, dest, true)) {
+            /* NOLINTNEXTLINE */
+            fprintf(stderr, "barm32; branch into the displaced instructions.\n");
+            return E_INTT_RESULT_FAILURE;
+        }
+        /* (add lr, pc, #8); ldr pc, [pc, #0]; b over the address; the address. */
+        if (is_blx || (w & 0x01000000))
+            emit_u32(emit, cond | 0x028fe008);
+        emit_u32(emit, cond | 0x059ff000);
+        emit_u32(emit, 0xea000000);
+        emit_u32(emit, (uint32_t) dest);
+        return E_INTT_RESULT_SUCCESS;
+    }
+
+    /* ldr/ldrb literal, with an immediate offset and no writeback. */
+    uint32_t rn = (w >> 16u) & 0xf, rt = (w >> 12u) & 0xf;
+    if ((w & 0x0c000000) == 0x04000000 && rn == 15u) {
+        bool is_plain_load = !(w & 0x02000000) && (w & 0x01100000) == 0x01100000 &&
+            !(w & 0x00200000) && rt != 15u;
+        if (!is_plain_load) {
+            /* NOLINTNEXTLINE */
+            fprintf(stderr, "barm32; cannot relocate a pc-relative load/ store (0x%08x).\n", w);
+            return E_INTT_RESULT_FAILURE;
+        }
+        uintptr_t address = (w & 0x00800000) ? pc + 8u + (w & 0xfff) : pc + 8u - (w & 0xfff);
+        /* ldr rt, [pc, #0]; b over the address; the address; the load from [rt]. */
+        emit_u32(emit, cond | 0x059f0000 | (rt << 12u));
+        emit_u32(emit, 0xea000000);
+        emit_u32(emit, (uint32_t) address);
+        emit_u32(emit, (w & ~0x008f0fffu) | 0x00800000 | (rt << 16u));
+        return E_INTT_RESULT_SUCCESS;
+    }
+
+    /* data-processing (and the extra loads) reading the pc can't be moved; bx/blx aren't. */
+    bool is_bx = (w & 0x0ffffff0) == 0x012fff10 || (w & 0x0ffffff0) == 0x012fff30;
+    if (cond != 0xf0000000 && (w & 0x0c000000) == 0u && !is_bx &&
+        (rn == 15u || (!(w & 0x02000000) && (w & 0xf) == 15u))) {
+        /* NOLINTNEXTLINE */
+        fprintf(stderr, "barm32; cannot relocate an instruction reading the pc (0x%08x).\n", w);
+        return E_INTT_RESULT_FAILURE;
+    }
+    emit_u32(emit, w);
+    return E_INTT_RESULT_SUCCESS;
+}
+
+/**
+ * @brief emit an unconditional jump in thumb; ldr.w pc, [pc, #0] (4-byte aligned), and the
+ *  address.
+ *
+ * @param emit the code.
+ * @param dest the destination (with the thumb bit for thumb code).
+ */
+internal void
+emit_jump_barmth(emit_t* emit, uintptr_t dest) {
+    if (emit_pc(emit) & 2u)
+        emit_u16(emit, 0xbf00);
+    emit_u16(emit, 0xf8df);
+    emit_u16(emit, 0xf000);
+    emit_u32(emit, (uint32_t) dest);
+}
+
+/**
+ * @brief emit a load of an address into a register in thumb; ldr.w rt, [pc, #4]; b over the
+ *  address; the address; and with deref, ldr.w rt, [rt].
+ *
+ * @param emit the code.
+ * @param rt the register.
+ * @param value the address.
+ * @param deref if the value at the address is loaded.
+ */
+internal void
+emit_load_barmth(emit_t* emit, uint32_t rt, uintptr_t value, bool deref) {
+    if (emit_pc(emit) & 2u)
+        emit_u16(emit, 0xbf00);
+    emit_u16(emit, 0xf8df);
+    emit_u16(emit, (uint16_t)((rt << 12u) | 4u));
+    emit_u16(emit, 0xe002);
+    emit_u16(emit, 0xbf00);
+    emit_u32(emit, (uint32_t) value);
+    if (deref) {
+        emit_u16(emit, (uint16_t)(0xf8d0 | rt));
+        emit_u16(emit, (uint16_t)(rt << 12u));
+    }
+}
+
+/**
+ * @brief emit a conditional jump in thumb; the first half of the skip (a 16-bit instruction with
+ *  the inverted condition) is given, and jumps over an absolute jump.
+ *
+ * @param emit the code.
+ * @param skip the skip, without its offset.
+ * @param is_cbz if the skip is a cbz/ cbnz (whose offset is encoded differently).
+ * @param dest the destination.
+ */
+internal void
+emit_jcc_barmth(emit_t* emit, uint16_t skip, bool is_cbz, uintptr_t dest) {
+    /* the jump takes 8 bytes after the skip, and 2 more to align it. */
+    uint32_t pad = (emit_pc(emit) + 2u) & 2u, offset = pad + 8u - 2u;
+    if (is_cbz)
+        emit_u16(emit, (uint16_t)(skip | ((offset >> 1u) << 3u)));
+    else emit_u16(emit, (uint16_t)(skip | (offset >> 1u)));
+    emit_jump_barmth(emit, dest);
+}
+
+/**
+ * @brief relocate a displaced instruction in thumb; branches, calls, cbz, adr and ldr literal are
+ *  rewritten, it blocks and anything else that reads the pc are refused.
+ *
+ * @param emit the code.
+ * @param insn the instruction.
+ * @param prologue the displaced instructions.
+ * @return ref. to intt.h for enum.
+ */
+internal e_intt_result_t
+relocate_barmth(emit_t* emit, const det_insn_t* insn, const det_prologue_t* prologue) {
+    uint16_t hw0 = (uint16_t)(insn->bytes[0] | (insn->bytes[1] << 8u)), hw1 = 0u;
+    uintptr_t pc = (uintptr_t) insn->address + 4u, aligned = pc & ~(uintptr_t) 3u, dest = 0u;
+    if (insn->size == 4u) {
+        hw1 = (uint16_t)(insn->bytes[2] | (insn->bytes[3] << 8u));
+
+        /* bl, blx (imm.), b.w, and b<cond>.w. */
+        if ((hw0 & 0xf800) == 0xf000 && (hw1 & 0x8000)) {
+            uint32_t s = (hw0 >> 10u) & 1u, j1 = (hw1 >> 13u) & 1u, j2 = (hw1 >> 11u) & 1u;
+            if ((hw1 & 0x5000) == 0x0000 && ((hw0 >> 6u) & 0xf) < 14u) {
+                uint32_t cond = (hw0 >> 6u) & 0xf;
+                uint64_t imm = (s << 20u) | (j2 << 19u) | (j1 << 18u) | ((hw0 & 0x3fu) << 12u) |
+                    ((hw1 & 0x7ffu) << 1u);
+                dest = (pc + (uintptr_t) sign_extend(imm, 21u)) | 1u;
+                if (is_displaced(prologue, dest, true))
+                    goto displaced;
+                emit_jcc_barmth(emit, (uint16_t)(0xd000 | ((cond ^ 1u) << 8u)), false, dest);
+                return E_INTT_RESULT_SUCCESS;
+            }
+            if (hw1 & 0x5000) {
+                uint32_t i1 = !(j1 ^ s), i2 = !(j2 ^ s);
+                uint64_t imm = (s << 24u) | (i1 << 23u) | (i2 << 22u) | ((hw0 & 0x3ffu) << 12u) |
+                    ((hw1 & 0x7ffu) << 1u);
+                int64_t offset = sign_extend(imm, 25u);
+                bool is_call = (hw1 & 0x4000) != 0u, to_arm = is_call && !(hw1 & 0x1000);
+                dest = to_arm ? aligned + (uintptr_t) offset : (pc + (uintptr_t) offset) | 1u;
+                if (is_displaced(prologue, dest, true))
+                    goto displaced;
+                if (!is_call) {
+                    emit_jump_barmth(emit, dest);
+                    return E_INTT_RESULT_SUCCESS;
+                }
+                /* ldr.w ip, [pc, #4]; blx ip; b over the address; the address. */
+                if (emit_pc(emit) & 2u)
+                    emit_u16(emit, 0xbf00);
+                emit_u16(emit, 0xf8df);
+                emit_u16(emit, 0xc004);
+                emit_u16(emit, 0x47e0);
+                emit_u16(emit, 0xe001);
+                emit_u32(emit, (uint32_t) dest);
+                return E_INTT_RESULT_SUCCESS;
+            }
+        }
+
+        /* ldr.w literal. */
+        if ((hw0 & 0xff7f) == 0xf85f && (hw1 >> 12u) != 15u) {
+            uintptr_t address = (hw0 & 0x80) ? aligned + (hw1 & 0xfff) : aligned - (hw1 & 0xfff);
+            emit_load_barmth(emit, hw1 >> 12u, address, true);
+            return E_INTT_RESULT_SUCCESS;
+        }
+
+        /* adr.w. */
+        if (((hw0 & 0xfbff) == 0xf20f || (hw0 & 0xfbff) == 0xf2af) && !(hw1 & 0x8000)) {
+            uint32_t imm = (((hw0 >> 10u) & 1u) << 11u) | (((hw1 >> 12u) & 7u) << 8u) |
+                (hw1 & 0xffu);
+            uintptr_t value = (hw0 & 0x00a0) == 0x00a0 ? aligned - imm : aligned + imm;
+            emit_load_barmth(emit, (hw1 >> 8u) & 0xf, value, false);
+            return E_INTT_RESULT_SUCCESS;
+        }
+
+        /* any other load from the pc, or a table branch. */
+        if (((hw0 & 0xfe00) == 0xf800 || (hw0 & 0xfff0) == 0xe8d0) && (hw0 & 0xf) == 0xf)
+            goto unsupported;
+        emit_bytes(emit, insn->bytes, 4u);
+        return E_INTT_RESULT_SUCCESS;
+    }
+
+    /* b<cond>, and b. */
+    if ((hw0 & 0xf000) == 0xd000 && ((hw0 >> 8u) & 0xf) < 14u) {
+        dest = (pc + (uintptr_t) sign_extend((hw0 & 0xffu) << 1u, 9u)) | 1u;
+        if (is_displaced(prologue, dest, true))
+            goto displaced;
+        emit_jcc_barmth(emit, (uint16_t)((hw0 & 0xff00) ^ 0x0100), false, dest);
+        return E_INTT_RESULT_SUCCESS;
+    }
+    if ((hw0 & 0xf800) == 0xe000) {
+        dest = (pc + (uintptr_t) sign_extend((hw0 & 0x7ffu) << 1u, 12u)) | 1u;
+        if (is_displaced(prologue, dest, true))
+            goto displaced;
+        emit_jump_barmth(emit, dest);
+        return E_INTT_RESULT_SUCCESS;
+    }
+
+    /* cbz/ cbnz. */
+    if ((hw0 & 0xf500) == 0xb100) {
+        dest = (pc + (((hw0 >> 9u) & 1u) << 6u) + (((hw0 >> 3u) & 0x1fu) << 1u)) | 1u;
+        if (is_displaced(prologue, dest, true))
+            goto displaced;
+        emit_jcc_barmth(emit, (uint16_t)((hw0 & 0xfd07) ^ 0x0800), true, dest);
+        return E_INTT_RESULT_SUCCESS;
+    }
+
+    /* ldr literal, and adr. */
+    if ((hw0 & 0xf800) == 0x4800) {
+        emit_load_barmth(emit, (hw0 >> 8u) & 7u, aligned + (hw0 & 0xffu) * 4u, true);
+        return E_INTT_RESULT_SUCCESS;
+    }
+    if ((hw0 & 0xf800) == 0xa000) {
+        emit_load_barmth(emit, (hw0 >> 8u) & 7u, aligned + (hw0 & 0xffu) * 4u, false);
+        return E_INTT_RESULT_SUCCESS;
+    }
+
+    /* an it block can't be split, and add/ mov/ cmp can't read the pc from elsewhere. */
+    if ((hw0 & 0xff00) == 0xbf00 && (hw0 & 0xf))
+        goto unsupported;
+    if ((hw0 & 0xfc00) == 0x4400 && ((hw0 >> 8u) & 3u) != 3u) {
+        uint32_t rm = (hw0 >> 3u) & 0xf, rdn = ((hw0 >> 4u) & 8u) | (hw0 & 7u);
+        if (rm == 15u || (((hw0 >> 8u) & 3u) != 2u && rdn == 15u))
+            goto unsupported;
+    }
+    emit_bytes(emit, insn->bytes, 2u);
+    return E_INTT_RESULT_SUCCESS;
+
+displaced:
+    /* NOLINTNEXTLINE */
+    fprintf(stderr, "barmth; branch into the displaced instructions at %p.\n", insn->address);
+    return E_INTT_RESULT_FAILURE;
+unsupported:
+    /* NOLINTNEXTLINE */
+    fprintf(stderr, "barmth; cannot relocate instruction at %p.\n", insn->address);
+    return E_INTT_RESULT_FAILURE;
+}
+
+/**
+ * @brief build the entry patch on arm32; ldr pc, [pc, #-4] and the address, or in thumb
+ *  ldr.w pc, [pc, #0] (after a nop, if unaligned) and the address.
+ *
+ * @param tramp the entry patch to be filled in.
+ * @param mocked the function it is to jump to.
+ * @param is_thumb if the function is thumb.
+ */
+internal void
+entry_barm(tramp_t* tramp, const void* mocked, bool is_thumb) {
+    emit_t emit = { .base = (uintptr_t) tramp->entry };
+    if (is_thumb)
+        emit_jump_barmth(&emit, (uintptr_t) mocked);
+    else {
+        emit_u32(&emit, 0xe51ff004);
+        emit_u32(&emit, (uint32_t)(uintptr_t) mocked);
+    }
+    /* NOLINTNEXTLINE */
+    memcpy(tramp->entry_bytes, emit.bytes, emit.size);
+    tramp->size = emit.size;
+}
+
+/**
+ * @brief is code near enough to what branches to it, with room for a page of it?
+ *
+ * @param code the code.
+ * @param near what branches to it.
+ * @return if it is, always on i386.
+ */
+internal bool
+is_near(const void* code, const void* near) {
+#if defined(TRAMP_NEAR_RANGE)
+    uintptr_t at = (uintptr_t) code, origin = (uintptr_t) near;
+    return (at > origin ? at - origin : origin - at) < TRAMP_NEAR_RANGE - guard_page_size();
+#else
+    (void) code;
+    (void) near;
+    return true;
+#endif
+}
+
+/**
+ * @brief map a page for trampolines near enough to a function to be branched to from it, by
+ *  hinting at addresses moving away from it.
+ *
+ * @param near the function.
+ * @param anywhere if the page may be anywhere once none near could be mapped.
+ * @return the page, or 0x0 if none could be mapped.
+ */
+internal uint8_t*
+page_map(const void* near, bool anywhere) {
+    size_t page = guard_page_size();
+    int prot = PROT_READ | PROT_EXEC, flags = MAP_PRIVATE | MAP_ANONYMOUS;
+#if defined(TRAMP_NEAR_RANGE)
+    uintptr_t origin = (uintptr_t) near & ~(uintptr_t)(page - 1u);
+    for (uintptr_t distance = TRAMP_NEAR_STEP; distance < TRAMP_NEAR_RANGE;
+         distance += TRAMP_NEAR_STEP) {
+        uintptr_t hints[2u] = { origin + distance, origin > distance ? origin - distance : 0u };
+        for (size_t i = 0u; i < 2u; i++) {
+            if (hints[i] == 0u)
+                continue;
+            uint8_t* mapped = mmap((void*) hints[i], page, prot, flags, -1, 0);
+            if (mapped == MAP_FAILED)
+                continue;
+            if (is_near(mapped, near))
+                return mapped;
+            munmap(mapped, page);
+        }
+    }
+    if (!anywhere)
+        return 0x0;
+#else
+    (void) near;
+    (void) anywhere;
+#endif
+    uint8_t* mapped = mmap(0x0, page, prot, flags, -1, 0);
+    return mapped != MAP_FAILED ? mapped : 0x0;
+}
+
+/**
+ * @brief find room for a trampoline, in a page in range of the function or a new one.
+ *
+ * @param near the function.
+ * @param anywhere if the code only jumps absolutely, so the page may be out of range.
+ * @return the page.
+ */
+internal tramp_page_t*
+page_find(const void* near, bool anywhere) {
+    size_t page = guard_page_size();
+    _vforeach_it(&l_pages, tramp_page_t, candidate, i)
+        if (candidate.used + TRAMP_CODE_MAX <= page && (anywhere || is_near(candidate.base, near)))
+            return &l_pages.data[i];
+    _endforeach;
+
+    /* o.w. a new page, near if one can be. */
+    tramp_page_t fresh = { page_map(near, anywhere), 0u };
+    if (fresh.base == 0x0 || !tramp_pages_push(&l_pages, fresh)) {
+        /* NOLINTNEXTLINE */
+        fprintf(stderr, "tapi, tramp_page; could not map a page for trampolines.\n");
+        return 0x0;
+    }
+    return &l_pages.data[l_pages.length - 1u];
+}
+
+/**
+ * @brief write code into the next free room of a page, keeping the rest of the page; nothing
+ *  runs the free room yet, so it is copied as is, even with live patching.
+ *
+ * @param page the page.
+ * @param emit the code, generated for where it runs.
+ * @return if it was written.
+ */
+internal bool
+page_put(tramp_page_t* page, const emit_t* emit) {
+    if (emit->overflow)
+        return false;
+    guard_list_t guards = { 0 };
+    if (!e_intt_passed(guard_open(&guards, (void*) emit->base, emit->size, 0x0)))
+        return false;
+    /* NOLINTNEXTLINE */
+    memcpy((void*) emit->base, emit->bytes, emit->size);
+    guard_close(&guards);
+    __builtin___clear_cache((char*) emit->base, (char*) emit->base + emit->size);
+    page->used += (emit->size + 15u) & ~(size_t) 15u;
+    return true;
+}
+
+/**
+ * @brief build the entry patch of a function to a mocked function, and the trampoline to the
+ *  original; nothing is written to the function itself.
+ *
+ * @param target the function to be patched.
+ * @param mocked the function it is to jump to.
+ * @param tramp the entry patch and trampoline to be filled in.
+ * @return ref. to intt.h for enum, fails if the prologue reads the pc in a way that can't be
+ *  relocated, the function branches into it, a call in it returns into the patch, or the
+ *  function is smaller than the patch.
+ */
+e_intt_result_t
+tramp_create(void* target, const void* mocked, tramp_t* tramp) {
+    /* the entry patch decides how much of the prologue is displaced. */
+    arch_t architecture = get_arch();
+    bool is_thumb = architecture.arch == CS_ARCH_ARM && (uintptr_t) target & 1u;
+    /* NOLINTNEXTLINE */
+    memset(tramp, 0, sizeof *tramp);
+    tramp->entry = (void*)((uintptr_t) target & ~(uintptr_t)(is_thumb ? 1u : 0u));
+    bool is_64 = architecture.mode == CS_MODE_64;
+    if (architecture.arch == CS_ARCH_X86)
+        entry_bx86(tramp, mocked, is_64);
+    else if (architecture.arch == CS_ARCH_AARCH64)
+        entry_barm64(tramp, mocked);
+    else entry_barm(tramp, mocked, is_thumb);
+    det_prologue_t prologue;
+    if (!e_intt_passed(det_prologue(target, tramp->size, &prologue)))
+        return E_INTT_RESULT_FAILURE;
+
+    /* nothing in the rest of the function may branch into them either (to the start is a call
+     *  of the function, and goes to the mock like any other). */
+    const det_scan_t* scan = det_scan(target, 0x1000);
+    if (scan == 0x0)
+        return E_INTT_RESULT_FAILURE;
+    for (size_t i = 0u; i < scan->branch_count; i++) {
+        if (is_displaced(&prologue, scan->branches[i], false)) {
+            /* NOLINTNEXTLINE */
+            fprintf(stderr, "tapi, tramp_create; the function branches into the displaced "
+                            "instructions at %p.\n", (void*) scan->branches[i]);
+            return E_INTT_RESULT_FAILURE;
+        }
+    }
+
+    /* nor may a displaced call return into the patch; a thread still in the callee when it is
+     *  written would come back to the middle of it. */
+    for (size_t i = 0u; i < prologue.count; i++) {
+        const det_insn_t* insn = &prologue.insns[i];
+        uintptr_t back = (uintptr_t) insn->address + insn->size;
+        if (back < (uintptr_t) tramp->entry + tramp->size &&
+            is_call(insn, architecture, is_thumb)) {
+            /* NOLINTNEXTLINE */
+            fprintf(stderr, "tapi, tramp_create; the call at %p returns into the entry "
+                            "patch.\n", insn->address);
+            return E_INTT_RESULT_FAILURE;
+        }
+    }
+    /* NOLINTNEXTLINE */
+    memcpy(tramp->orig_bytes, tramp->entry, tramp->size);
+
+    /* relocate the displaced instructions into a trampoline, and jump back after them; on arm
+     *  and aarch64 it only jumps absolutely, so it can be anywhere, but on x86 a rip-relative
+     *  operand has to stay in range. */
+    pthread_mutex_lock(&l_lock);
+    leak_pause();
+    tramp_page_t* page = page_find(target, architecture.arch != CS_ARCH_X86);
+    if (page == 0x0) {
+        leak_resume();
+        pthread_mutex_unlock(&l_lock);
+        return E_INTT_RESULT_FAILURE;
+    }
+    emit_t emit = { .base = (uintptr_t)(page->base + page->used) };
+    e_intt_result_t result = E_INTT_RESULT_SUCCESS;
+    for (size_t i = 0u; i < prologue.count && e_intt_passed(result); i++) {
+        const det_insn_t* insn = &prologue.insns[i];
+        if (architecture.arch == CS_ARCH_X86)
+            result = relocate_bx86(&emit, insn, &prologue, is_64);
+        else if (architecture.arch == CS_ARCH_AARCH64)
+            result = relocate_barm64(&emit, insn, &prologue);
+        else if (is_thumb)
+            result = relocate_barmth(&emit, insn, &prologue);
+        else result = relocate_barm(&emit, insn, &prologue);
+    }
+    uintptr_t back = (uintptr_t) tramp->entry + prologue.size;
+    if (architecture.arch == CS_ARCH_X86)
+        emit_jump_bx86(&emit, back, is_64);
+    else if (architecture.arch == CS_ARCH_AARCH64)
+        emit_jump_barm64(&emit, back);
+    else if (is_thumb)
+        emit_jump_barmth(&emit, back | 1u);
+    else {
+        emit_u32(&emit, 0xe51ff004);
+        emit_u32(&emit, (uint32_t) back);
+    }
+
+    /* write it to the page, and keep the rest of the page for the next one. */
+    if e_intt_passed(result) {
+        if (page_put(page, &emit))
+            tramp->code = (void*)(emit.base | (is_thumb ? 1u : 0u));
+        else result = E_INTT_RESULT_FAILURE;
+    }
+    leak_resume();
+    pthread_mutex_unlock(&l_lock);
+    return result;
+}
+
+/**
+ * @brief place position-independent code (e.g. a dispatch stub) in a page of trampolines near a
+ *  function, within branch range of it, like a veneer; it lives until tramp_release().
+ *
+ * @param near the function it is to be near.
+ * @param code the code.
+ * @param size the size of the code, at most TRAMP_CODE_MAX.
+ * @return where the code was placed, or 0x0 if it couldn't be.
+ */
+void*
+tramp_place(const void* near, const uint8_t* code, size_t size) {
+    if (size > TRAMP_CODE_MAX)
+        return 0x0;
+    pthread_mutex_lock(&l_lock);
+    leak_pause();
+    tramp_page_t* page = page_find(near, false);
+    void* placed = 0x0;
+    if (page != 0x0) {
+        emit_t emit = { .base = (uintptr_t)(page->base + page->used) };
+        emit_bytes(&emit, code, size);
+        if (page_put(page, &emit))
+            placed = (void*) emit.base;
+    }
+    leak_resume();
+    pthread_mutex_unlock(&l_lock);
+    return placed;
+}
+
+/**
+ * @brief get a veneer to a destination out of range of a call, an absolute jump placed near the
+ *  call; veneers are pooled, so every call near one to the same destination shares it.
+ *
+ * @param near the call.
+ * @param dest the destination.
+ * @param is_thumb if the call is a thumb bl, so the veneer has to be thumb code (arm only).
+ * @return the veneer (without the thumb bit), or 0x0 if none could be placed.
+ */
+void*
+tramp_veneer(const void* near, const void* dest, bool is_thumb) {
+    pthread_mutex_lock(&l_lock);
+    _vforeach(&l_veneers, tramp_veneer_t, veneer)
+        if (veneer.dest == dest && veneer.is_thumb == is_thumb && is_near(veneer.code, near)) {
+            pthread_mutex_unlock(&l_lock);
+            return veneer.code;
+        }
+    _endforeach;
+
+    /* o.w. a new one; on arm, ldr pc switches to thumb if the destination is thumb code. */
+    leak_pause();
+    tramp_page_t* page = page_find(near, false);
+    void* placed = 0x0;
+    if (page != 0x0) {
+        emit_t emit = { .base = (uintptr_t)(page->base + page->used) };
+        arch_t architecture = get_arch();
+        if (architecture.arch == CS_ARCH_X86)
+            emit_jump_bx86(&emit, (uintptr_t) dest, architecture.mode == CS_MODE_64);
+        else if (architecture.arch == CS_ARCH_AARCH64)
+            emit_jump_barm64(&emit, (uintptr_t) dest);
+        else if (is_thumb)
+            emit_jump_barmth(&emit, (uintptr_t) dest);
+        else {
+            emit_u32(&emit, 0xe51ff004);
+            emit_u32(&emit, (uint32_t)(uintptr_t) dest);
+        }
+        tramp_veneer_t veneer = { dest, (void*) emit.base, is_thumb };
+        if (page_put(page, &emit) && tramp_veneers_push(&l_veneers, veneer))
+            placed = veneer.code;
+    }
+    leak_resume();
+    pthread_mutex_unlock(&l_lock);
+    return placed;
+}
+
+/** @brief unmap every trampoline; none of them can be called afterwards. */
+void
+tramp_release(void) {
+    pthread_mutex_lock(&l_lock);
+    _vforeach(&l_pages, tramp_page_t, page)
+        munmap(page.base, guard_page_size());
+    _endforeach;
+    tramp_pages_free(&l_pages);
+    tramp_veneers_free(&l_veneers);
+    pthread_mutex_unlock(&l_lock);
+}
@@ -0,0 +1,76 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-10-19
+ */
+#ifndef TRAMP_H
+#define TRAMP_H
+
+/*! @uses size_t. */
+#include <stddef.h>
+
+/*! @uses uint8_t. */
+#include <stdint.h>
+
+/*! @uses bool. */
+#include <stdbool.h>
+
+/*! @uses e_intt_result_t. */
+#include "intt.h"
+
+/* the most bytes an entry patch can take (aarch64, to a target out of range of a b). */
+#define TRAMP_ENTRY_MAX 16u
+
+/**
+ * an entry patch of a function, and the trampoline that keeps the original callable; the
+ *  instructions displaced by the patch are relocated into the trampoline, followed by a jump back
+ *  to the rest of the function.
+ */
+typedef struct {
+    void* entry; /* the start of the function (without the thumb bit). */
+    size_t size; /* the size of the entry patch. */
+    uint8_t orig_bytes[TRAMP_ENTRY_MAX], entry_bytes[TRAMP_ENTRY_MAX]; /* before, and the patch. */
+    void* code; /* the trampoline, callable as the original function (with the thumb bit). */
+} tramp_t;
+
+/**
+ * @brief build the entry patch of a function to a mocked function, and the trampoline to the
+ *  original; nothing is written to the function itself.
+ *
+ * @param target the function to be patched.
+ * @param mocked the function it is to jump to.
+ * @param tramp the entry patch and trampoline to be filled in.
+ * @return ref. to intt.h for enum, fails if the prologue reads the pc in a way that can't be
+ *  relocated, the function branches into it, a call in it returns into the patch, or the
+ *  function is smaller than the patch.
+ */
+e_intt_result_t
+tramp_create(void* target, const void* mocked, tramp_t* tramp);
+
+/**
+ * @brief place position-independent code (e.g. a dispatch stub) in a page of trampolines near a
+ *  function, within branch range of it, like a veneer; it lives until tramp_release().
+ *
+ * @param near the function it is to be near.
+ * @param code the code.
+ * @param size the size of the code, at most the size of a trampoline.
+ * @return where the code was placed, or 0x0 if it couldn't be.
+ */
+void*
+tramp_place(const void* near, const uint8_t* code, size_t size);
+
+/**
+ * @brief get a veneer to a destination out of range of a call, an absolute jump placed near the
+ *  call; veneers are pooled, so every call near one to the same destination shares it.
+ *
+ * @param near the call.
+ * @param dest the destination.
+ * @param is_thumb if the call is a thumb bl, so the veneer has to be thumb code (arm only).
+ * @return the veneer (without the thumb bit), or 0x0 if none could be placed.
+ */
+void*
+tramp_veneer(const void* near, const void* dest, bool is_thumb);
+
+/** @brief unmap every trampoline; none of them can be called afterwards. */
+void
+tramp_release(void);
+#endif /* TRAMP_H */
@@ -5,86 +5,639 @@
  */
 #include <tapi/mock.h>
 
+/*! @uses tapi_spy_t, tapi_spy_reset. */
+#include <tapi/spy.h>
+
 /*! @uses cs_open. */
 #include <capstone/capstone.h>
 
-/*! @uses memcpy. */
+/*! @uses memcpy, memcmp. */
 #include <string.h>
 
-/*! @uses det_function_size. */
+/*! @uses uintptr_t. */
+#include <stdint.h>
+
+/*! @uses dyna_define. */
+#include <tapi/dyna.h>
+
+/*! @uses internal. */
+#include "intt.h"
+
+/*! @uses det_function_size, det_scan, det_call_t. */
 #include "det.h"
 
-/*! @uses patch_call_target. */
+/*! @uses patch_batch_t, patch_encode_call, patch_batch_write_as, patch_batch_commit. */
 #include "patch.h"
+
+/*! @uses frame_alloc. */
+#include "frame.h"
+
+/*! @uses site_t, sites_build, sites_find. */
+#include "sites.h"
+
+/*! @uses tramp_t, tramp_create. */
+#include "tramp.h"
+
+/*! @uses got_slots_t, got_find, got_resolve. */
+#include "got.h"
+
+/*! @uses live_set, e_live_kind_t. */
+#include "live.h"
+
+/*! @uses dispatch_route, dispatch_set. */
+#include "dispatch.h"
+
+/*! @uses leak_pause, leak_resume. */
+#include "leak.h"
+
+/*! @uses pthread_mutex_t, pthread_mutex_lock, pthread_mutex_unlock. */
+#include <pthread.h>
 /** \endcond */
 
+/* a typed vector of mocks. */
+dyna_define(mocks, tapi_mock_t*, 16u)
+
+/*
+ * every mock that is applied, in the order it was; a dispatch mock writes nothing and isn't
+ *  kept here. they are restored before the pages they jump through are released at exit.
+ */
+static pthread_mutex_t l_lock = PTHREAD_MUTEX_INITIALIZER;
+static mocks_t l_applied;
+
+/**
+ * @brief is a call to a function (on arm, with or without the thumb bit)?
+ *
+ * @param dest the destination of the call.
+ * @param function the function.
+ * @return if the call goes to the function.
+ */
+internal bool
+calls_function(const void* dest, const void* function) {
+#if defined(__arm__)
+    return ((uintptr_t) dest & ~(uintptr_t) 1u) == ((uintptr_t) function & ~(uintptr_t) 1u);
+#else
+    return dest == function;
+#endif
+}
+
+/**
+ * @brief copy a call into the sites of a mock.
+ *
+ * @param site the site to be filled in.
+ * @param call the call.
+ */
+internal void
+site_from_call(tapi_mock_site_t* site, const det_call_t* call) {
+    site->call = call->call;
+    site->size = call->size;
+    site->is_thumb = call->is_thumb;
+}
+
+/**
+ * @brief find every call to the target of a mock (within orig, if given), before anything is
+ *  patched; in the index if the function is in it, o.w. by decoding it.
+ *
+ * @param mock the mock whose sites are to be found.
+ */
+internal void
+find_sites(tapi_mock_t* mock) {
+    /* the callers of target are one run in the index, sorted by address. */
+    size_t count, found = 0u;
+    const site_t* sites = sites_find(mock->target, &count);
+    for (size_t i = 0u; i < count; i++)
+        found += mock->orig == 0x0 || sites[i].function == mock->orig;
+    if (found != 0u) {
+        mock->sites = frame_alloc(sizeof *mock->sites * found);
+        if (mock->sites == 0x0) {
+            /* NOLINTNEXTLINE */
+            fprintf(stderr, "tapi, mock_create; frame_alloc failed; could not allocate sites.\n");
+            return;
+        }
+        for (size_t i = 0u; i < count; i++) {
+            if (mock->orig == 0x0 || sites[i].function == mock->orig)
+                site_from_call(&mock->sites[mock->count++], &sites[i].call);
+        }
+        return;
+    }
+
+    /* o.w. decode the function (a static function without a symbol, a stripped program...). */
+    const det_scan_t* scan = mock->orig != 0x0 ? det_scan(mock->orig, 0x1000) : 0x0;
+    if (scan == 0x0)
+        return;
+    for (size_t i = 0u; i < scan->count; i++)
+        found += calls_function(scan->calls[i].dest, mock->target);
+    if (found == 0u)
+        return;
+    mock->sites = frame_alloc(sizeof *mock->sites * found);
+    if (mock->sites == 0x0) {
+        /* NOLINTNEXTLINE */
+        fprintf(stderr, "tapi, mock_create; frame_alloc failed; could not allocate sites.\n");
+        return;
+    }
+    for (size_t i = 0u; i < scan->count; i++) {
+        if (calls_function(scan->calls[i].dest, mock->target))
+            site_from_call(&mock->sites[mock->count++], &scan->calls[i]);
+    }
+}
+
 /**
- * @brief mock the first call occurrence to a target with a call
- *  to a mocked function instead.
+ * @brief mock every call to a target within a function with a call to a mocked function instead.
  *
  * @param orig the original function to search for target in.
  * @param target the target address to be replaced.
  * @param mocked the function to replace the target call with.
- * @return an allocated mock structure with all data, ready to be applied.
+ * @return a mock structure with all data, ready to be applied, or 0x0 if it couldn't be
+ *  allocated; it is owned by tapi and released when the program exits.
  */
 tapi_mock_t*
 tapi_mock_create(void* orig, void* target, void* mocked) {
-    /* allocate the structure. */
-    tapi_mock_t* mock = calloc(1u, sizeof *mock);
+    /* allocate the structure, it lives as long as the program. */
+    tapi_mock_t* mock = frame_alloc(sizeof *mock);
+    if (mock == 0x0) {
+        /* NOLINTNEXTLINE */
+        fprintf(stderr, "tapi, mock_create; frame_alloc failed; could not allocate the mock.\n");
+        return 0x0;
+    }
     mock->orig = orig;
     mock->target = target;
     mock->mocked = mocked;
-    mock->fun_size = det_function_size(orig, 0x1000); /* we are using a max of 4096 bytes. */
+    /* we are using a max of 4096 bytes; the index has to be built before anything is patched. */
+    mock->fun_size = det_function_size(orig, 0x1000);
+    sites_build();
+    find_sites(mock);
     return mock;
 };
 
 /**
- * @brief apply the mocks patch in memory; write stub to route to
- *  the given mocked function pointer.
+ * @brief mock every call to a target, from any function in the program, with a call to a mocked
+ *  function instead; the callers are found in an index of every call site in the executable
+ *  (and in loaded shared objects, with TAPI_MOCK_SHARED=1), built once on first use.
  *
- * @param mock the mock to be applied.
+ * @param target the target address to be replaced.
+ * @param mocked the function to replace the target calls with.
+ * @return a mock of every call site, ready to be applied, or 0x0 if nothing calls target; it is
+ *  owned by tapi and released when the program exits.
  */
-void
-tapi_mock_apply(tapi_mock_t* mock) {
-    /* determine call info. */
-    det_call_t* call = det_call_target(mock->orig, mock->target);
-    if (call == 0x0) {
+tapi_mock_t*
+tapi_mock_create_all(void* target, void* mocked) {
+    sites_build();
+    tapi_mock_t* mock = frame_alloc(sizeof *mock);
+    if (mock == 0x0) {
         /* NOLINTNEXTLINE */
-        fprintf(stderr, "tapi, mock_apply; cannot find target call in function.\n");
-        return;
+        fprintf(stderr, "tapi, mock_create_all; frame_alloc failed; could not allocate the "
+                        "mock.\n");
+        return 0x0;
+    }
+    mock->target = target;
+    mock->mocked = mocked;
+    find_sites(mock);
+    if (mock->count == 0u) {
+        /* NOLINTNEXTLINE */
+        fprintf(stderr, "tapi, mock_create_all; no call to target found in the program.\n");
+        return 0x0;
+    }
+    return mock;
+}
+
+/**
+ * @brief mock a target for every caller by patching its entry with a jump to a mocked function;
+ *  the instructions displaced by the jump are relocated into a trampoline, so the original can
+ *  still be called through `original`. the cost doesn't depend on the number of callers.
+ *
+ * @param target the target function to be replaced.
+ * @param mocked the function to jump to instead.
+ * @return a mock of the entry of target, ready to be applied, or 0x0 if its prologue can't be
+ *  relocated; it is owned by tapi and released when the program exits.
+ */
+tapi_mock_t*
+tapi_mock_create_entry(void* target, void* mocked) {
+    tramp_t tramp;
+    if (!e_intt_passed(tramp_create(target, mocked, &tramp))) {
+        /* NOLINTNEXTLINE */
+        fprintf(stderr, "tapi, mock_create_entry; cannot relocate the prologue of target.\n");
+        return 0x0;
     }
 
-    mock->call = call->call;
-    mock->size = call->size;
+    /* the entry is the only site, with its bytes before and after known up front. */
+    tapi_mock_t* mock = frame_alloc(sizeof *mock);
+    tapi_mock_site_t* site = frame_alloc(sizeof *site);
+    if (mock == 0x0 || site == 0x0) {
+        /* NOLINTNEXTLINE */
+        fprintf(stderr, "tapi, mock_create_entry; frame_alloc failed; could not allocate the "
+                        "mock.\n");
+        return 0x0;
+    }
+    mock->target = target;
+    mock->mocked = mocked;
+    mock->kind = E_TAPI_MOCK_KIND_ENTRY;
+    mock->original = tramp.code;
+    mock->sites = site;
+    mock->count = 1u;
+    mock->sites->call = tramp.entry;
+    mock->sites->size = tramp.size;
+    mock->sites->is_thumb = tramp.entry != target;
+    /* NOLINTNEXTLINE */
+    memcpy(mock->sites->orig_bytes, tramp.orig_bytes, tramp.size);
     /* NOLINTNEXTLINE */
-    memcpy(mock->orig_bytes, call->bytes, mock->size);
+    memcpy(mock->sites->mocked_bytes, tramp.entry_bytes, tramp.size);
+    return mock;
+}
 
-    /* apply the patch to the call. */
-    patch_call_target(call, mock->mocked);
+/**
+ * @brief mock a shared-library function (e.g. read, malloc or clock_gettime) by swapping the got
+ *  slots it is called through, in the executable and every loaded shared object but tapi; the
+ *  slots are found from the relocations of each object, nothing is decoded, and relro is
+ *  unprotected only while a slot is written.
+ *
+ * @param symbol the name of the function to be replaced.
+ * @param mocked the function to call instead.
+ * @return a mock of every slot, ready to be applied, or 0x0 if the function isn't called through
+ *  any; it is owned by tapi and released when the program exits.
+ */
+tapi_mock_t*
+tapi_mock_create_got(const char* symbol, void* mocked) {
+    got_slots_t slots = { 0 };
+    if (!e_intt_passed(got_find(symbol, &slots))) {
+        /* NOLINTNEXTLINE */
+        fprintf(stderr, "tapi, mock_create_got; no got slot found for %s.\n", symbol);
+        got_slots_free(&slots);
+        return 0x0;
+    }
 
-    /* we read the new bytes and store. */
-    /* NOLINTNEXTLINE */
-    memcpy(mock->mocked_bytes, mock->call, mock->size);
-    free(call);
-};
+    /* a site per slot; what it held is only kept when applied, lazy binding may still fill it. */
+    tapi_mock_t* mock = frame_alloc(sizeof *mock);
+    tapi_mock_site_t* sites = frame_alloc(sizeof *sites * slots.length);
+    if (mock == 0x0 || sites == 0x0) {
+        /* NOLINTNEXTLINE */
+        fprintf(stderr, "tapi, mock_create_got; frame_alloc failed; could not allocate the "
+                        "mock.\n");
+        got_slots_free(&slots);
+        return 0x0;
+    }
+    mock->target = mock->original = got_resolve(symbol);
+    mock->mocked = mocked;
+    mock->kind = E_TAPI_MOCK_KIND_GOT;
+    mock->sites = sites;
+    _vforeach(&slots, void**, slot)
+        tapi_mock_site_t* site = &mock->sites[mock->count++];
+        site->call = slot;
+        site->size = sizeof mocked;
+        /* NOLINTNEXTLINE */
+        memcpy(site->mocked_bytes, &mocked, sizeof mocked);
+    _endforeach;
+    got_slots_free(&slots);
+    return mock;
+}
 
 /**
- * @brief restore the contents of a function and free the mock.
+ * @brief mock a target for the calling thread only; every call to it in the program is routed,
+ *  once, through a stub that calls the mock applied by the calling thread, or the target if it
+ *  applied none. threads can apply different mocks of the same target at the same time, and
+ *  applying or restoring one patches nothing; restoring one puts back the mock it replaced.
  *
- * @param mock the mock structure to be freed and restored.
+ * @param target the target function to be replaced.
+ * @param mocked the function to call instead, on the thread that applies the mock.
+ * @return a mock of the target, ready to be applied, or 0x0 if nothing calls target, or no call
+ *  to it could be routed; it is owned by tapi and released when the program exits.
  */
-void
-tapi_mock_restore(tapi_mock_t* mock) {
-    /* we can't restore a mock that hasn't been applied... */
-    if (mock->call == 0x0) {
+tapi_mock_t*
+tapi_mock_create_dispatch(void* target, void* mocked) {
+    size_t slot, routed;
+    if (!e_intt_passed(dispatch_route(target, &slot, &routed)))
+        return 0x0;
+
+    /* the calls are already routed, so there are no sites to patch. */
+    tapi_mock_t* mock = frame_alloc(sizeof *mock);
+    if (mock == 0x0) {
         /* NOLINTNEXTLINE */
-        fprintf(stderr, "tapi, mock_restore; cannot restore unapplied mock.\n");
+        fprintf(stderr, "tapi, mock_create_dispatch; frame_alloc failed; could not allocate the "
+                        "mock.\n");
+        return 0x0;
+    }
+    mock->target = mock->original = target;
+    mock->mocked = mocked;
+    mock->kind = E_TAPI_MOCK_KIND_DISPATCH;
+    mock->slot = slot;
+    return mock;
+}
+
+/**
+ * @brief rebuild the call of a site, for patching.
+ *
+ * @param site the site.
+ * @return the call.
+ */
+internal det_call_t
+site_call(const tapi_mock_site_t* site) {
+    return (det_call_t) { .call = site->call, .size = site->size, .is_rel = true,
+                          .is_thumb = site->is_thumb };
+}
+
+/**
+ * @brief the number of bytes of a site that are kept.
+ *
+ * @param site the site.
+ * @return the number of bytes.
+ */
+internal size_t
+site_bytes(const tapi_mock_site_t* site) {
+    return site->size < sizeof site->orig_bytes ? site->size : sizeof site->orig_bytes;
+}
+
+/**
+ * @brief how the sites of a mock are written, with live patching.
+ *
+ * @param mock the mock.
+ * @return ref. to live.h for enum.
+ */
+internal e_live_kind_t
+site_kind(const tapi_mock_t* mock) {
+    if (mock->kind == E_TAPI_MOCK_KIND_GOT)
+        return E_LIVE_KIND_DATA;
+    return mock->kind == E_TAPI_MOCK_KIND_ENTRY ? E_LIVE_KIND_CODE : E_LIVE_KIND_INSN;
+}
+
+/**
+ * @brief keep a mock that was just applied, after every other; the memory is tapi's own, not
+ *  the test's that applied it.
+ *
+ * @param mock the mock.
+ */
+internal void
+track(tapi_mock_t* mock) {
+    pthread_mutex_lock(&l_lock);
+    leak_pause();
+    mocks_push(&l_applied, mock);
+    leak_resume();
+    pthread_mutex_unlock(&l_lock);
+}
+
+/**
+ * @brief forget a mock that was just restored, the other mocks keep their order.
+ *
+ * @param mock the mock.
+ */
+internal void
+untrack(tapi_mock_t* mock) {
+    pthread_mutex_lock(&l_lock);
+    for (size_t i = l_applied.length; i-- > 0u;) {
+        if (l_applied.data[i] == mock) {
+            mocks_splice(&l_applied, i, 1u, 0x0, 0u);
+            break;
+        }
+    }
+    pthread_mutex_unlock(&l_lock);
+}
+
+/**
+ * a site to be applied or restored, and when; a site mocked more than once in a batch is
+ *  applied in order, and restored in reverse.
+ */
+typedef struct {
+    tapi_mock_site_t* site;
+    e_live_kind_t kind;
+    size_t order;
+} restore_t;
+
+/* a typed vector of the sites to be applied or restored. */
+dyna_define(restores, restore_t, 16u)
+
+/**
+ * @brief order sites by their address, then by when they are applied or restored.
+ *
+ * @param a the first site.
+ * @param b the second site.
+ * @return the order, as for qsort.
+ */
+internal int
+compare_restores(const void* a, const void* b) {
+    const restore_t* p = a, *q = b;
+    uintptr_t x = (uintptr_t) p->site->call, y = (uintptr_t) q->site->call;
+    if (x != y)
+        return (x > y) - (x < y);
+    return (p->order > q->order) - (p->order < q->order);
+}
+
+/**
+ * @brief add a call of a mock to a batch, encoded up front so the site keeps the bytes of its
+ *  own mock; a call that can't be patched is kept as it is.
+ *
+ * @param batch the batch to be added to.
+ * @param applied the sites added so far.
+ * @param site the site of the call.
+ * @param target where the call is to go.
+ */
+internal void
+apply_call(patch_batch_t* batch, restores_t* applied, tapi_mock_site_t* site,
+           const void* target) {
+    size_t size = site_bytes(site);
+    /* NOLINTNEXTLINE */
+    memcpy(site->orig_bytes, site->call, size);
+    /* NOLINTNEXTLINE */
+    memcpy(site->mocked_bytes, site->call, size);
+    det_call_t call = site_call(site);
+    uint8_t code[PATCH_CODE_MAX];
+    if (!e_intt_passed(patch_encode_call(&call, target, code)))
         return;
+    /* NOLINTNEXTLINE */
+    memcpy(site->mocked_bytes, code, size);
+    patch_batch_write_as(batch, site->call, site->mocked_bytes, size, E_LIVE_KIND_INSN);
+    restore_t restore = { site, E_LIVE_KIND_INSN, applied->length };
+    restores_push(applied, restore);
+}
+
+/**
+ * @brief apply many mocks at once; every call site of every mock is written in a single batch,
+ *  with one protection change per range of pages rather than two per call.
+ *
+ * @param mocks the mocks to be applied.
+ * @param count the number of mocks.
+ */
+void
+tapi_mock_apply_all(tapi_mock_t** mocks, size_t count) {
+    /* collect every site, keeping its bytes from before. */
+    patch_batch_t batch = { 0 };
+    restores_t applied = { 0 };
+    for (size_t i = 0u; i < count; i++) {
+        tapi_mock_t* mock = mocks[i];
+        if (mock->kind == E_TAPI_MOCK_KIND_DISPATCH) {
+            /* only this thread's calls are redirected, nothing is written; the mock it had is
+             *  kept, to be put back. */
+            if (!mock->applied)
+                mock->previous = dispatch_set(mock->slot, mock->mocked);
+            mock->applied = true;
+            continue;
+        }
+        if (mock->count == 0u) {
+            /* NOLINTNEXTLINE */
+            fprintf(stderr, "tapi, mock_apply; cannot find target call in function.\n");
+            continue;
+        }
+        if (mock->applied)
+            continue;
+        mock->applied = true;
+        track(mock);
+        if (mock->kind == E_TAPI_MOCK_KIND_SPY) {
+            /* every site to its own stub, counting from nothing. */
+            tapi_spy_reset(mock);
+            for (size_t j = 0u; j < mock->count; j++) {
+                tapi_mock_site_t* site = &mock->sites[j];
+                if (mock->spy->stubs[j] != 0x0)
+                    apply_call(&batch, &applied, site, mock->spy->stubs[j]);
+                else {
+                    /* NOLINTNEXTLINE */
+                    memcpy(site->orig_bytes, site->call, site_bytes(site));
+                    /* NOLINTNEXTLINE */
+                    memcpy(site->mocked_bytes, site->call, site_bytes(site));
+                }
+            }
+            continue;
+        }
+        if (mock->kind != E_TAPI_MOCK_KIND_CALL) {
+            /* the entry patch, or the mocked function, is known up front. */
+            for (size_t j = 0u; j < mock->count; j++) {
+                tapi_mock_site_t* site = &mock->sites[j];
+                if (mock->kind == E_TAPI_MOCK_KIND_GOT) {
+                    /* NOLINTNEXTLINE */
+                    memcpy(site->orig_bytes, site->call, site->size);
+                }
+                patch_batch_write_as(&batch, site->call, site->mocked_bytes, site->size,
+                                     site_kind(mock));
+            }
+            continue;
+        }
+        for (size_t j = 0u; j < mock->count; j++)
+            apply_call(&batch, &applied, &mock->sites[j], mock->mocked);
+    }
+
+    /* a call mocked again within the batch had, before, the bytes of the mock under it. */
+    restores_sort(&applied, compare_restores);
+    for (size_t i = 1u; i < applied.length; i++) {
+        tapi_mock_site_t* under = applied.data[i - 1u].site, *site = applied.data[i].site;
+        if (under->call == site->call) {
+            /* NOLINTNEXTLINE */
+            memcpy(site->orig_bytes, under->mocked_bytes, site_bytes(site));
+        }
+    }
+    restores_free(&applied);
+    patch_batch_commit(&batch);
+}
+
+/**
+ * @brief restore many mocks at once, in a single batch like tapi_mock_apply_all(); every site gets
+ *  the bytes it had before it was applied back, nothing is decoded again. a site whose bytes are
+ *  no longer the ones the mock wrote has been changed by something else, and is left as it is.
+ *  a site mocked more than once goes back through each of its mocks in turn, and only the bytes
+ *  it ends up with are written.
+ *
+ * @param mocks the mocks to be restored.
+ * @param count the number of mocks.
+ */
+void
+tapi_mock_restore_all(tapi_mock_t** mocks, size_t count) {
+    /* in reverse, so a site mocked twice goes back through what the first mock saw. */
+    restores_t restores = { 0 };
+    for (size_t i = count; i-- > 0u;) {
+        tapi_mock_t* mock = mocks[i];
+        /* we can't restore a mock that hasn't been applied... */
+        if (!mock->applied) {
+            /* NOLINTNEXTLINE */
+            fprintf(stderr, "tapi, mock_restore; cannot restore unapplied mock.\n");
+            continue;
+        }
+
+        /* we then have to restore the bytes for future tests that could call that function. */
+        mock->applied = false;
+        if (mock->kind == E_TAPI_MOCK_KIND_DISPATCH) {
+            dispatch_set(mock->slot, mock->previous);
+            continue;
+        }
+        untrack(mock);
+        for (size_t j = 0u; j < mock->count; j++) {
+            restore_t restore = { &mock->sites[j], site_kind(mock), restores.length };
+            restores_push(&restores, restore);
+        }
     }
+    restores_sort(&restores, compare_restores);
 
-    /* we then have to restore the bytes for future tests that could call that same function. */
-    det_call_t* call = det_call_target(mock->orig, mock->mocked);
-    patch_call_target(call, mock->target);
-    free(call);
-    free(mock);
-};
\ No newline at end of file
+    /* each mock of a site has to find the bytes it wrote, in memory for the last one applied,
+     *  o.w. in what the mock restored before it puts back. */
+    patch_batch_t batch = { 0 };
+    for (size_t first = 0u, last; first < restores.length; first = last) {
+        void* call = restores.data[first].site->call;
+        const unsigned char* current = call;
+        size_t current_size = site_bytes(restores.data[first].site);
+        const restore_t* final = 0x0;
+        bool changed = false;
+        for (last = first; last < restores.length && restores.data[last].site->call == call;
+             last++) {
+            const restore_t* restore = &restores.data[last];
+            size_t size = site_bytes(restore->site);
+            if (changed)
+                continue;
+            if (size != current_size || memcmp(current, restore->site->mocked_bytes, size) != 0) {
+                /* NOLINTNEXTLINE */
+                fprintf(stderr, "tapi, mock_restore; site at %p was changed while mocked; left "
+                                "as is.\n", call);
+                changed = true;
+                continue;
+            }
+            current = restore->site->orig_bytes;
+            final = restore;
+        }
+        if (final != 0x0)
+            patch_batch_write_as(&batch, call, final->site->orig_bytes, current_size, final->kind);
+    }
+    restores_free(&restores);
+    patch_batch_commit(&batch);
+}
+
+/**
+ * @brief restore every mock that is still applied, the last one applied first; dispatch mocks
+ *  are left to the threads that applied them.
+ */
+void
+tapi_mock_restore_applied(void) {
+    /* restoring forgets each of them, so the list is taken as a whole first. */
+    mocks_t applied = { 0 };
+    pthread_mutex_lock(&l_lock);
+    mocks_push_n(&applied, l_applied.data, l_applied.length);
+    mocks_free(&l_applied);
+    pthread_mutex_unlock(&l_lock);
+    tapi_mock_restore_all(applied.data, applied.length);
+    mocks_free(&applied);
+}
+
+/**
+ * @brief apply the mocks patch in memory; every call site is routed to
+ *  the given mocked function pointer.
+ *
+ * @param mock the mock to be applied.
+ */
+void
+tapi_mock_apply(tapi_mock_t* mock) {
+    tapi_mock_apply_all(&mock, 1u);
+}
+
+/**
+ * @brief restore every call site of a mock; the mock is kept, and can be applied again.
+ *
+ * @param mock the mock structure to be restored.
+ */
+void
+tapi_mock_restore(tapi_mock_t* mock) {
+    tapi_mock_restore_all(&mock, 1u);
+}
+
+/**
+ * @brief patch safely while other threads could be running the patched code (off unless
+ *  TAPI_MOCK_LIVE=1), e.g. to apply mocks under a running thread pool. a call is rewritten with a
+ *  single atomic store on arm, and behind an int3 breakpoint on x86; an entry patch is written
+ *  with every other thread stopped outside of it (by SIGRTMIN, which they must not block).
+ *
+ * @param live is patching to be safe?
+ */
+void
+tapi_mock_set_live(bool live) {
+    live_set(live);
+}
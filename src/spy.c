@@ -0,0 +1,251 @@
+/**
+ * \cond
+ * @author Sean Hobeck
+ * @date 2026-10-19
+ */
+#include <tapi/spy.h>
+
+/*! @uses fprintf, stderr. */
+#include <stdio.h>
+
+/*! @uses memset. */
+#include <string.h>
+
+/*! @uses internal. */
+#include "intt.h"
+
+/*! @uses frame_alloc. */
+#include "frame.h"
+
+/*! @uses dispatch_stub, DISPATCH_ARGS, DISPATCH_GPRS. */
+#include "dispatch.h"
+/** \endcond */
+
+/* the arguments a stub saves, and that are kept of them. */
+#define SPY_ARGS (DISPATCH_ARGS < TAPI_SPY_ARGS ? DISPATCH_ARGS : TAPI_SPY_ARGS)
+
+/** the context of the stub of a site. */
+typedef struct {
+    tapi_spy_t* spy;
+    size_t site;
+} spy_site_t;
+
+/** @return the cycle counter, or 0 where there is none. */
+internal DISPATCH_GPRS uint64_t
+spy_ticks(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __builtin_ia32_rdtsc();
+#elif defined(__aarch64__)
+    uint64_t ticks;
+    __asm__ volatile("mrs %0, cntvct_el0" : "=r"(ticks));
+    return ticks;
+#else
+    return 0u;
+#endif
+}
+
+/**
+ * @brief count and record a call, from the stub of its site; the slot of the call in the ring is
+ *  claimed by moving its sequence from an older call to an odd one, so a reader never takes a
+ *  call that is half written, and of two writers a lap apart only one writes the slot.
+ *
+ * @param context the site.
+ * @param args the saved arguments of the call.
+ * @return where the call goes.
+ */
+internal DISPATCH_GPRS const void*
+spy_record(const void* context, const uintptr_t* args) {
+    const spy_site_t* site = context;
+    tapi_spy_t* spy = site->spy;
+    __atomic_fetch_add(&spy->counts[site->site], 1u, __ATOMIC_RELAXED);
+    uint64_t n = __atomic_fetch_add(&spy->count, 1u, __ATOMIC_RELAXED);
+    tapi_spy_call_t* call = &spy->ring[n % TAPI_SPY_RING];
+
+    /* the slot is still being written, or already holds a later call; this one is dropped. */
+    uint64_t sequence = __atomic_load_n(&call->sequence, __ATOMIC_RELAXED);
+    do {
+        if ((sequence & 1u) != 0u || sequence > 2u * n)
+            return spy->forward;
+    } while (!__atomic_compare_exchange_n(&call->sequence, &sequence, 2u * n + 1u, true,
+                                          __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    for (size_t i = 0u; i < SPY_ARGS; i++)
+        __atomic_store_n(&call->args[i], args[i], __ATOMIC_RELAXED);
+    __atomic_store_n(&call->time, spy_ticks(), __ATOMIC_RELAXED);
+    __atomic_store_n(&call->site, site->site, __ATOMIC_RELAXED);
+    __atomic_store_n(&call->sequence, 2u * n + 2u, __ATOMIC_RELEASE);
+    return spy->forward;
+}
+
+/**
+ * @brief spy on every call to a target within a function (or from anywhere in the program); each
+ *  call is counted and recorded by a stub, and then goes on to a mocked function, or the target.
+ *
+ * @param orig the original function to search for target in, or 0x0 for every caller.
+ * @param target the target function to be spied on.
+ * @param mocked the function the calls go to, or 0x0 for the target itself.
+ * @return a spy mock of every call site, ready to be applied, or 0x0 if nothing calls target, no
+ *  stub could be placed, or every call is thumb code; it is owned by tapi and released when the
+ *  program exits.
+ */
+tapi_mock_t*
+tapi_mock_create_spy(void* orig, void* target, void* mocked) {
+    /* the sites are found like those of a call mock. */
+    tapi_mock_t* mock = orig != 0x0 ? tapi_mock_create(orig, target, mocked)
+                                    : tapi_mock_create_all(target, mocked);
+    if (mock == 0x0 || mock->count == 0u) {
+        /* NOLINTNEXTLINE */
+        fprintf(stderr, "tapi, mock_create_spy; no call to target found.\n");
+        return 0x0;
+    }
+
+    /* a stub per site, near it, that knows which site it is. */
+    tapi_spy_t* spy = frame_alloc(sizeof *spy);
+    uint64_t* counts = frame_alloc(sizeof *counts * mock->count);
+    void** stubs = frame_alloc(sizeof *stubs * mock->count);
+    spy_site_t* sites = frame_alloc(sizeof *sites * mock->count);
+    if (spy == 0x0 || counts == 0x0 || stubs == 0x0 || sites == 0x0) {
+        /* NOLINTNEXTLINE */
+        fprintf(stderr, "tapi, mock_create_spy; frame_alloc failed; could not allocate the spy.\n");
+        return 0x0;
+    }
+    spy->forward = mocked != 0x0 ? mocked : target;
+    spy->counts = counts;
+    spy->stubs = stubs;
+    size_t thumb = 0u;
+    for (size_t i = 0u; i < mock->count; i++) {
+        /* the stub is arm code, a thumb caller would need blx; it isn't spied on. */
+        if (mock->sites[i].is_thumb) {
+            thumb++;
+            continue;
+        }
+        sites[i] = (spy_site_t) { .spy = spy, .site = i };
+        spy->stubs[i] = dispatch_stub(mock->sites[i].call, spy_record, &sites[i]);
+        if (spy->stubs[i] == 0x0) {
+            /* NOLINTNEXTLINE */
+            fprintf(stderr, "tapi, mock_create_spy; no stub could be placed.\n");
+            return 0x0;
+        }
+    }
+    if (thumb == mock->count) {
+        /* NOLINTNEXTLINE */
+        fprintf(stderr, "tapi, mock_create_spy; every call to target is thumb code, none can be "
+                        "spied on.\n");
+        return 0x0;
+    }
+    if (thumb != 0u) {
+        /* NOLINTNEXTLINE */
+        fprintf(stderr, "tapi, mock_create_spy; warning; %zu of the %zu calls to target are thumb "
+                        "code, and aren't spied on.\n", thumb, mock->count);
+    }
+    mock->kind = E_TAPI_MOCK_KIND_SPY;
+    mock->original = target;
+    mock->spy = spy;
+    return mock;
+}
+
+/**
+ * @brief get the number of calls a spy has seen.
+ *
+ * @param mock the spy mock.
+ * @return the number of calls since it was applied, or reset.
+ */
+uint64_t
+tapi_spy_count(const tapi_mock_t* mock) {
+    return mock->spy != 0x0 ? __atomic_load_n(&mock->spy->count, __ATOMIC_ACQUIRE) : 0u;
+}
+
+/**
+ * @brief get the number of calls a spy has seen from one site.
+ *
+ * @param mock the spy mock.
+ * @param site the index of the site.
+ * @return the number of calls from the site, 0 if there is no such site.
+ */
+uint64_t
+tapi_spy_site_count(const tapi_mock_t* mock, size_t site) {
+    if (mock->spy == 0x0 || site >= mock->count)
+        return 0u;
+    return __atomic_load_n(&mock->spy->counts[site], __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief copy a call recorded by a spy.
+ *
+ * @param mock the spy mock.
+ * @param n the call, 0 for the first since it was applied, or reset.
+ * @param call the call to be filled in.
+ * @return if the call was made, and is still in the ring.
+ */
+bool
+tapi_spy_call(const tapi_mock_t* mock, uint64_t n, tapi_spy_call_t* call) {
+    if (mock->spy == 0x0)
+        return false;
+
+    /* the slot has to hold call n before, and still after, it is copied. */
+    tapi_spy_call_t* slot = &mock->spy->ring[n % TAPI_SPY_RING];
+    uint64_t sequence = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+    if (sequence != 2u * n + 2u)
+        return false;
+    for (size_t i = 0u; i < TAPI_SPY_ARGS; i++)
+        call->args[i] = __atomic_load_n(&slot->args[i], __ATOMIC_RELAXED);
+    call->time = __atomic_load_n(&slot->time, __ATOMIC_RELAXED);
+    call->site = __atomic_load_n(&slot->site, __ATOMIC_RELAXED);
+    call->sequence = sequence;
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return __atomic_load_n(&slot->sequence, __ATOMIC_RELAXED) == sequence;
+}
+
+/**
+ * @brief was a call made with a value as one of its arguments?
+ *
+ * @param mock the spy mock.
+ * @param n the call, 0 for the first since it was applied, or reset.
+ * @param arg the index of the argument, below TAPI_SPY_ARGS.
+ * @param value the value.
+ * @return if the call is in the ring, and had the value.
+ */
+bool
+tapi_spy_called_with(const tapi_mock_t* mock, uint64_t n, size_t arg, uintptr_t value) {
+    tapi_spy_call_t call;
+    return arg < TAPI_SPY_ARGS && tapi_spy_call(mock, n, &call) && call.args[arg] == value;
+}
+
+/**
+ * @brief were exactly a number of calls made, with a sequence of values as one of their
+ *  arguments?
+ *
+ * @param mock the spy mock.
+ * @param arg the index of the argument, below TAPI_SPY_ARGS.
+ * @param values the value of the argument in each call, in order.
+ * @param count the number of values.
+ * @return if the spy saw count calls, each of them still in the ring and with its value.
+ */
+bool
+tapi_spy_sequence(const tapi_mock_t* mock, size_t arg, const uintptr_t* values, size_t count) {
+    if (tapi_spy_count(mock) != count)
+        return false;
+    for (size_t i = 0u; i < count; i++) {
+        if (!tapi_spy_called_with(mock, i, arg, values[i]))
+            return false;
+    }
+    return true;
+}
+
+/**
+ * @brief forget every call a spy has seen; nothing may call through the spy meanwhile, a call
+ *  recorded while it is reset can be left half forgotten.
+ *
+ * @param mock the spy mock.
+ */
+void
+tapi_spy_reset(tapi_mock_t* mock) {
+    tapi_spy_t* spy = mock->spy;
+    if (spy == 0x0)
+        return;
+    /* NOLINTNEXTLINE */
+    memset(spy->counts, 0, sizeof *spy->counts * mock->count);
+    /* NOLINTNEXTLINE */
+    memset(spy->ring, 0, sizeof spy->ring);
+    __atomic_store_n(&spy->count, 0u, __ATOMIC_RELEASE);
+}
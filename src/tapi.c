@@ -8,18 +8,30 @@
 /*! @uses fprintf, stderr. */
 #include <stdio.h>
 
-/*! @uses calloc, free. */
-#include <stdlib.h>
-
-/*! @uses strlen, memcpy. */
-#include <string.h>
-
 /*! @uses tapi_mock_t, tapi_apply_mock. */
 #include <tapi/mock.h>
+
+/*! @uses tapi_mock_create_spy. */
+#include <tapi/spy.h>
+
+/*! @uses tapi_alloc_reset, tapi_alloc_stats. */
+#include <tapi/alloc.h>
+
+/*! @uses tapi_arena, tapi_arena_reset. */
+#include <tapi/arena.h>
+
+/*! @uses frame_alloc, frame_intern. */
+#include "frame.h"
+
+/*! @uses leak_begin, leak_end, leak_collect, leak_print, leak_mode. */
+#include "leak.h"
 /** \endcond */
 
+/* a typed vector of test pointers, the suite rarely outgrows its inline storage. */
+dyna_define(test_list, tapi_test_t*, 16u)
+
 /* local testing suite. */
-static dyna_t* l_tests;
+static test_list_t l_tests;
 
 /**
  * @brief set up many tests to be run in concession.
@@ -30,16 +42,14 @@ static dyna_t* l_tests;
 void
 tapi_test_setup(tapi_test_t** tests, size_t count) {
     /* if we already have tests. */
-    if (l_tests != 0x0) {
+    if (l_tests.length != 0u) {
         /* NOLINTNEXTLINE */
         fprintf(stderr, "tapi, setup_tests; tests != null; refer to tapi_add_test().\n");
         return;
     }
 
     /* and we are done. */
-    l_tests = dyna_create();
-    for (size_t i = 0u; i < count; i++)
-        dyna_push(l_tests, tests[i]);
+    test_list_push_n(&l_tests, tests, count);
 }
 
 /**
@@ -49,10 +59,7 @@ tapi_test_setup(tapi_test_t** tests, size_t count) {
  */
 void
 tapi_test_add(tapi_test_t* test) {
-    /* if we don't have tests. */
-    if (l_tests == 0x0)
-        l_tests = dyna_create();
-    dyna_push(l_tests, test); /* very simple push. */
+    test_list_push(&l_tests, test); /* very simple push. */
 };
 
 /** @brief run all the tests set up in concession. */
@@ -60,37 +67,54 @@ void
 tapi_test_run(void) {
     /* iterate through each test, */
     size_t passed = 0u;
-    _foreach_it(l_tests, tapi_test_t*, test, i)
+    _vforeach_it(&l_tests, tapi_test_t*, test, i)
         /* call setup, apply the mocks, */
         if (test->setup != 0x0) test->setup();
-        _foreach_it(test->mocks, tapi_mock_t*, mock, j)
-            tapi_mock_apply(mock);
-        _endforeach;
+        tapi_mock_apply_all(test->mocks.data, test->mocks.length);
 
-        /* call the test, */
+        /* call the test, counting and tracking only what it allocates, */
+        tapi_alloc_reset();
+        uint32_t epoch = leak_begin();
         test->result = test->function();
+        leak_end();
+        test->allocs = tapi_alloc_stats();
+
+        /* then call teardown and restore mocks. */
+        tapi_mock_restore_all(test->mocks.data, test->mocks.length);
+        if (test->teardown != 0x0) test->teardown();
+
+        /* scratch memory does not outlive the test, but its chunks are kept. */
+        tapi_arena_reset(tapi_arena());
+
+        /* whatever the test allocated and is still live now has leaked. */
+        leak_report_t leaks = { 0 };
+        if (epoch != 0u)
+            leak_collect(epoch, &leaks);
+        test->leaks = leaks.count;
+        test->leaked = leaks.bytes;
+        if (leaks.count != 0u && leak_mode() == E_TAPI_LEAK_FAIL &&
+            test->result == E_TAPI_TEST_RESULT_PASSED)
+            test->result = E_TAPI_TEST_RESULT_FAILED;
+
+        /* and report. */
         if (test->result == E_TAPI_TEST_RESULT_PASSED) {
             passed++;
-            printf("[%zu/%zu] tapi: %s, passed.\n", passed, l_tests->length, test->name);
+            printf("[%zu/%zu] tapi: %s, passed.\n", passed, l_tests.length, test->name);
         }
         else if (test->result == E_TAPI_TEST_RESULT_SKIPPED) {
-            printf("[%zu/%zu] tapi: %s, skipped.\n", passed, l_tests->length, test->name);
+            printf("[%zu/%zu] tapi: %s, skipped.\n", passed, l_tests.length, test->name);
         }
         else {
-            printf("[%zu/%zu] tapi: %s, failed.\n", passed, l_tests->length, test->name);
+            printf("[%zu/%zu] tapi: %s, failed.\n", passed, l_tests.length, test->name);
         }
-
-        /* then call teardown and restore mocks. */
-        _foreach_it(test->mocks, tapi_mock_t*, mock, j)
-            tapi_mock_restore(mock);
-        _endforeach;
-        if (test->teardown != 0x0) test->teardown();
+        leak_print(&leaks, stdout);
     _endforeach;
-    printf("tapi; total tests passed: [%zu/%zu].\n", passed, l_tests->length);
+    printf("tapi; total tests passed: [%zu/%zu].\n", passed, l_tests.length);
 };
 
 /**
- * @brief make a new test given minimal information.
+ * @brief make a new test given minimal information; the test and its name live in tapi's
+ *  internal arena until the program exits, the mocks are kept inline until there are many.
  *
  * @param name the name of the test.
  * @param function the test function to be used.
@@ -98,12 +122,13 @@ tapi_test_run(void) {
 tapi_test_t*
 tapi_test_make(const char* name, tapi_test_func_t function) {
     /* allocate and make the structure. */
-    tapi_test_t* test = calloc(2, sizeof *test);
-    size_t length = strlen(name);
-    test->name = calloc(1u, length);
-    /* NOLINTNEXTLINE */
-    strncpy(test->name, name, length);
-    test->mocks = dyna_create();
+    tapi_test_t* test = frame_alloc(sizeof *test);
+    if (test == 0x0) {
+        /* NOLINTNEXTLINE */
+        fprintf(stderr, "tapi, test_make; frame_alloc failed; could not allocate the test.\n");
+        return 0x0;
+    }
+    test->name = frame_intern(name);
     test->function = function;
     return test;
 }
@@ -118,27 +143,110 @@ tapi_test_make(const char* name, tapi_test_func_t function) {
  */
 void
 tapi_test_add_mock(tapi_test_t* test, void* tested, void* target, void* mocked) {
-    /* create a dynamic array if it doesn't already exist. */
-    if (test->mocks == 0x0)
-        test->mocks = dyna_create();
-
-    /* create the mock ptr and push it onto the dynamic array. */
+    /* create the mock ptr and push it onto the vector of mocks. */
     tapi_mock_t* mock = tapi_mock_create(tested, target, mocked);
-    dyna_push(test->mocks, mock);
+    if (mock != 0x0)
+        tapi_mocks_push(&test->mocks, mock);
+}
+
+/**
+ * @brief add a mock of every call to a target, from any function in the program, to a test.
+ *
+ * @param test the test to be altered.
+ * @param target the target address to redirect to mock.
+ * @param mocked the mocked result to be redirected to.
+ * @return the number of call sites mocked.
+ */
+size_t
+tapi_test_add_mock_all(tapi_test_t* test, void* target, void* mocked) {
+    tapi_mock_t* mock = tapi_mock_create_all(target, mocked);
+    if (mock == 0x0)
+        return 0u;
+    tapi_mocks_push(&test->mocks, mock);
+    return mock->count;
 }
 
 /**
- * @brief free and destroy a list of tests after they have been ran.
+ * @brief add a mock of a target to a test that patches the entry of the target itself, so every
+ *  caller is redirected (indirect and cross-library calls too).
  *
- * @param tests the tests to be freed (this also frees all of its elements, including mocks).
+ * @param test the test to be altered.
+ * @param target the target function to redirect to mock.
+ * @param mocked the mocked result to be redirected to.
+ * @return the mock, whose `original` still calls the target, or 0x0 if its entry can't be
+ *  patched.
+ */
+tapi_mock_t*
+tapi_test_add_mock_entry(tapi_test_t* test, void* target, void* mocked) {
+    tapi_mock_t* mock = tapi_mock_create_entry(target, mocked);
+    if (mock != 0x0)
+        tapi_mocks_push(&test->mocks, mock);
+    return mock;
+}
+
+/**
+ * @brief add a mock of a shared-library function to a test, swapping the got slots it is called
+ *  through (see tapi_mock_create_got()).
+ *
+ * @param test the test to be altered.
+ * @param symbol the name of the function to redirect to mock.
+ * @param mocked the mocked result to be redirected to.
+ * @return the mock, whose `original` is the real function, or 0x0 if there is no slot to swap.
+ */
+tapi_mock_t*
+tapi_test_add_mock_got(tapi_test_t* test, const char* symbol, void* mocked) {
+    tapi_mock_t* mock = tapi_mock_create_got(symbol, mocked);
+    if (mock != 0x0)
+        tapi_mocks_push(&test->mocks, mock);
+    return mock;
+}
+
+/**
+ * @brief add a mock of a target to a test that only applies to the thread running it, so tests
+ *  on other threads can mock the same target differently (see tapi_mock_create_dispatch()).
+ *
+ * @param test the test to be altered.
+ * @param target the target function to redirect to mock.
+ * @param mocked the mocked result to be redirected to.
+ * @return the mock, or 0x0 if nothing calls the target.
+ */
+tapi_mock_t*
+tapi_test_add_mock_dispatch(tapi_test_t* test, void* target, void* mocked) {
+    tapi_mock_t* mock = tapi_mock_create_dispatch(target, mocked);
+    if (mock != 0x0)
+        tapi_mocks_push(&test->mocks, mock);
+    return mock;
+}
+
+/**
+ * @brief add a spy of every call to a target within a tested function (or from anywhere) to a
+ *  test; each call is counted and its arguments recorded (see tapi_mock_create_spy()), then it
+ *  goes on to a mock, or the target. the counts start over every time the test runs.
+ *
+ * @param test the test to be altered.
+ * @param tested the tested function to search through, or 0x0 for every caller.
+ * @param target the target function to spy on.
+ * @param mocked the function the calls go to, or 0x0 for the target.
+ * @return the spy mock, or 0x0 if nothing calls the target.
+ */
+tapi_mock_t*
+tapi_test_add_mock_spy(tapi_test_t* test, void* tested, void* target, void* mocked) {
+    tapi_mock_t* mock = tapi_mock_create_spy(tested, target, mocked);
+    if (mock != 0x0)
+        tapi_mocks_push(&test->mocks, mock);
+    return mock;
+}
+
+/**
+ * @brief free and destroy a list of tests after they have been ran; the tests, their names and
+ *  mocks themselves are released with tapi's internal arena when the program exits.
+ *
+ * @param tests the tests to be freed.
  * @param length the number of tests to be freed.
  */
 void
 tapi_test_destroy(tapi_test_t** tests, size_t length) {
-    /* free each test but not the list itself, that isn't ours. */
-    for (size_t i = 0; i < length; i++) {
-        dyna_free(tests[i]->mocks);
-        free(tests[i]->name);
-        free(tests[i]);
-    }
+    /* free the vector of mocks of each test, but not the list itself, that isn't ours. */
+    for (size_t i = 0; i < length; i++)
+        tapi_mocks_free(&tests[i]->mocks);
 };
\ No newline at end of file
@@ -0,0 +1,152 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-10-19
+ */
+#include <tapi/tapi.h>
+
+/*! @uses tapi_alloc_stats, tapi_assert_max_allocs, tapi_assert_no_alloc, tapi_leak_check. */
+#include <tapi/alloc.h>
+
+/*! @uses malloc, calloc, realloc, free. */
+#include <stdlib.h>
+
+/* the first test, so a later one can read what the runner recorded for it. */
+static tapi_test_t* l_first;
+
+/* the leaking and the tidy test, for the same reason. */
+static tapi_test_t* l_leaky, *l_tidy;
+
+/* blocks the leaking test keeps, and the tidy test frees in its teardown. */
+static void* l_leaked[2], *l_owned;
+
+/* region for the functions that are asserted on. */
+#pragma region helpers
+/* volatile so the allocations cannot be optimized away. */
+void* volatile kept;
+
+e_tapi_test_result_t three_allocs(size_t budget) {
+    for (size_t i = 0u; i < 3u; i++) {
+        kept = malloc(16u);
+        free(kept);
+    }
+    tapi_assert_max_allocs(budget);
+    return E_TAPI_TEST_RESULT_PASSED;
+}
+
+e_tapi_test_result_t scope_without_alloc() {
+    int sum = 0;
+    tapi_assert_no_alloc {
+        for (int i = 0; i < 16; i++)
+            sum += i;
+    }
+    return sum == 120 ? E_TAPI_TEST_RESULT_PASSED : E_TAPI_TEST_RESULT_FAILED;
+}
+
+void free_owned() {
+    free(l_owned);
+}
+
+e_tapi_test_result_t scope_with_alloc() {
+    tapi_assert_no_alloc {
+        kept = malloc(8u);
+    }
+    free(kept);
+    return E_TAPI_TEST_RESULT_PASSED;
+}
+#pragma endregion
+
+/* region for all of the tests. */
+#pragma region tests
+e_tapi_test_result_t test_counts() {
+    /* act. */
+    void* a = malloc(100u);
+    void* b = calloc(4u, 25u);
+    free(a);
+    free(b);
+
+    /* assert. */
+    tapi_alloc_stats_t stats = tapi_alloc_stats();
+    tapi_assert(stats.allocs == 2u && stats.frees == 2u);
+    tapi_assert(stats.bytes == 200u);
+    tapi_assert(stats.peak >= 200u && stats.live == 0u);
+    return E_TAPI_TEST_RESULT_PASSED;
+}
+
+e_tapi_test_result_t test_realloc() {
+    /* act; grow, then free by resizing to nothing. */
+    void* a = malloc(16u);
+    a = realloc(a, 4096u);
+    size_t live = tapi_alloc_stats().live;
+    free(a);
+
+    /* assert. */
+    tapi_alloc_stats_t stats = tapi_alloc_stats();
+    tapi_assert(stats.allocs == 2u && stats.frees == 2u);
+    tapi_assert(live >= 4096u && stats.peak >= 4096u && stats.live == 0u);
+    return E_TAPI_TEST_RESULT_PASSED;
+}
+
+e_tapi_test_result_t test_max_allocs() {
+    /* the budget covers everything allocated since the test started. */
+    tapi_assert(three_allocs(3u) == E_TAPI_TEST_RESULT_PASSED);
+    tapi_assert(three_allocs(6u) == E_TAPI_TEST_RESULT_PASSED);
+    tapi_assert(three_allocs(8u) == E_TAPI_TEST_RESULT_FAILED);
+    return E_TAPI_TEST_RESULT_PASSED;
+}
+
+e_tapi_test_result_t test_no_alloc() {
+    tapi_assert(scope_without_alloc() == E_TAPI_TEST_RESULT_PASSED);
+    tapi_assert(scope_with_alloc() == E_TAPI_TEST_RESULT_FAILED);
+
+    /* the failed assertion returned before the block could be freed. */
+    free(kept);
+    return E_TAPI_TEST_RESULT_PASSED;
+}
+
+e_tapi_test_result_t test_runner_records() {
+    /* the counters were reset for this test, and test_counts' were kept. */
+    tapi_assert(tapi_alloc_stats().allocs == 0u);
+    tapi_assert(l_first->allocs.allocs == 2u && l_first->allocs.bytes == 200u);
+    return E_TAPI_TEST_RESULT_PASSED;
+}
+
+e_tapi_test_result_t test_leaky() {
+    /* the larger block is reported first. */
+    l_leaked[0] = malloc(16u);
+    l_leaked[1] = malloc(48u);
+    return E_TAPI_TEST_RESULT_PASSED;
+}
+
+e_tapi_test_result_t test_tidy() {
+    /* freed by teardown, which still counts as not leaked. */
+    l_owned = malloc(64u);
+    return E_TAPI_TEST_RESULT_PASSED;
+}
+
+e_tapi_test_result_t test_leaks_recorded() {
+    /* assert; both blocks of the leaking test, and nothing of the tidy one. */
+    tapi_assert(l_leaky->leaks == 2u && l_leaky->leaked == 64u);
+    tapi_assert(l_tidy->leaks == 0u && l_tidy->leaked == 0u);
+    free(l_leaked[0]);
+    free(l_leaked[1]);
+    return E_TAPI_TEST_RESULT_PASSED;
+}
+#pragma endregion
+
+int main() {
+    tapi_leak_check(E_TAPI_LEAK_REPORT);
+    tapi_test_t* test_counts_ = l_first = tapi_test_make("test_counts", test_counts);
+    tapi_test_t* test_realloc_ = tapi_test_make("test_realloc", test_realloc);
+    tapi_test_t* test_max = tapi_test_make("test_max_allocs", test_max_allocs);
+    tapi_test_t* test_none = tapi_test_make("test_no_alloc", test_no_alloc);
+    tapi_test_t* test_runner = tapi_test_make("test_runner_records", test_runner_records);
+    tapi_test_t* test_leaky_ = l_leaky = tapi_test_make("test_leaky", test_leaky);
+    tapi_test_t* test_tidy_ = l_tidy = tapi_test_make("test_tidy", test_tidy);
+    tapi_test_t* test_leaks = tapi_test_make("test_leaks_recorded", test_leaks_recorded);
+    test_tidy_->teardown = free_owned;
+    tapi_test_t* tests[] = { test_counts_, test_realloc_, test_max, test_none, test_runner,
+                             test_leaky_, test_tidy_, test_leaks };
+    tapi_test_setup(tests, 8u);
+    tapi_test_run();
+    return 0;
+}
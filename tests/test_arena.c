@@ -0,0 +1,109 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-10-19
+ */
+#include <tapi/tapi.h>
+
+/*! @uses tapi_arena_t, tapi_arena, etc... */
+#include <tapi/arena.h>
+
+/*! @uses tapi_assert_no_alloc. */
+#include <tapi/alloc.h>
+
+/*! @uses uintptr_t. */
+#include <stdint.h>
+
+/*! @uses memset, strcmp. */
+#include <string.h>
+
+/* what the first test got from the arena of the suite. */
+static void* l_first;
+
+/* region for all of the tests. */
+#pragma region tests
+e_tapi_test_result_t test_alignment() {
+    /* arrange. */
+    tapi_arena_t* arena = tapi_arena_make(0u);
+
+    /* act. */
+    char* a = tapi_arena_alloc(arena, 3u);
+    char* b = tapi_arena_alloc(arena, 5u);
+    char* c = tapi_arena_alloc_aligned(arena, 8u, 256u);
+
+    /* assert. */
+    tapi_assert((uintptr_t) a % 16u == 0u && (uintptr_t) b % 16u == 0u);
+    tapi_assert((uintptr_t) c % 256u == 0u);
+    tapi_assert(b == a + 16 && c > b);
+    tapi_arena_destroy(arena);
+    return E_TAPI_TEST_RESULT_PASSED;
+}
+
+e_tapi_test_result_t test_chunks_reused() {
+    /* arrange; fill more than two chunks, one oversized. */
+    tapi_arena_t* arena = tapi_arena_make(4096u);
+    char* first = tapi_arena_alloc(arena, 1024u);
+    for (size_t i = 0u; i < 8u; i++)
+        tapi_arena_alloc(arena, 1024u);
+    char* large = tapi_arena_alloc(arena, 64u * 1024u);
+    tapi_assert(large != 0x0);
+    /* NOLINTNEXTLINE */
+    memset(large, 0xff, 64u * 1024u);
+
+    /* act; reset, then allocate the same again without touching the system allocator. */
+    tapi_arena_reset(arena);
+    char* again = 0x0;
+    tapi_assert_no_alloc {
+        again = tapi_arena_alloc(arena, 1024u);
+        for (size_t i = 0u; i < 8u; i++)
+            tapi_arena_alloc(arena, 1024u);
+        tapi_arena_alloc(arena, 64u * 1024u);
+    }
+
+    /* assert. */
+    tapi_assert(again == first);
+    tapi_arena_destroy(arena);
+    return E_TAPI_TEST_RESULT_PASSED;
+}
+
+e_tapi_test_result_t test_suite_arena() {
+    int* values = tapi_arena_new(int, 1024u);
+    tapi_assert(values != 0x0 && (uintptr_t) values % _Alignof(int) == 0u);
+    for (int i = 0; i < 1024; i++)
+        values[i] = i;
+    l_first = values;
+    return E_TAPI_TEST_RESULT_PASSED;
+}
+
+e_tapi_test_result_t test_suite_arena_reset() {
+    /* the runner reset the arena after the last test, so we get the same memory. */
+    tapi_assert(tapi_arena_new(int, 1024u) == l_first);
+    return E_TAPI_TEST_RESULT_PASSED;
+}
+
+e_tapi_test_result_t test_interned_names() {
+    /* act; bookkeeping comes from the internal arena, not the system allocator. */
+    tapi_test_t* a = 0x0, *b = 0x0;
+    tapi_assert_no_alloc {
+        a = tapi_test_make("test_interned", test_alignment);
+        b = tapi_test_make("test_interned", test_alignment);
+    }
+
+    /* assert; two tests, one copy of their name. */
+    tapi_assert(a != b && a->name == b->name);
+    tapi_assert(strcmp(a->name, "test_interned") == 0);
+    tapi_assert(a->mocks.length == 0u && a->function == test_alignment);
+    return E_TAPI_TEST_RESULT_PASSED;
+}
+#pragma endregion
+
+int main() {
+    tapi_test_t* test_align = tapi_test_make("test_alignment", test_alignment);
+    tapi_test_t* test_reuse = tapi_test_make("test_chunks_reused", test_chunks_reused);
+    tapi_test_t* test_suite = tapi_test_make("test_suite_arena", test_suite_arena);
+    tapi_test_t* test_reset = tapi_test_make("test_suite_arena_reset", test_suite_arena_reset);
+    tapi_test_t* test_names = tapi_test_make("test_interned_names", test_interned_names);
+    tapi_test_t* tests[] = { test_align, test_reuse, test_suite, test_reset, test_names };
+    tapi_test_setup(tests, 5u);
+    tapi_test_run();
+    return 0;
+}
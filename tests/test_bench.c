@@ -0,0 +1,336 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-10-19
+ */
+#define _GNU_SOURCE
+#include <tapi/tapi.h>
+
+/*! @uses tapi_bench_t, etc... */
+#include <tapi/bench.h>
+
+/*! @uses tapi_quick_capture, etc... */
+#include <tapi/capture.h>
+
+/*! @uses EXIT_SUCCESS, EXIT_FAILURE. */
+#include <stdlib.h>
+
+/*! @uses strstr. */
+#include <string.h>
+
+/*! @uses remove, fopen, fprintf, fclose. */
+#include <stdio.h>
+
+/*! @uses sched_getaffinity, sched_getscheduler, sched_getcpu, CPU_COUNT. */
+#include <sched.h>
+
+/* region for all of the benchmark bodies. */
+#pragma region bench bodies
+void bench_fast(tapi_bench_state_t* state) {
+    (void) state;
+    for (volatile int i = 0; i < 10; i++);
+}
+
+void bench_slow(tapi_bench_state_t* state) {
+    (void) state;
+    for (volatile int i = 0; i < 1000; i++);
+}
+
+void bench_linear(tapi_bench_state_t* state) {
+    for (volatile size_t i = 0; i < state->size * 64u; i++);
+}
+
+void bench_quadratic(tapi_bench_state_t* state) {
+    for (volatile size_t i = 0; i < state->size * state->size; i++);
+}
+
+/* a random cycle through 256 kib of cache lines, every load depends on the last. */
+#define CHASE_LINES 4096u
+size_t chase[CHASE_LINES * 8u];
+
+void bench_chase(tapi_bench_state_t* state) {
+    (void) state;
+    size_t at = 0u;
+    for (size_t i = 0u; i < CHASE_LINES; i++)
+        at = chase[at];
+    tapi_bench_keep(at);
+}
+
+/* a counter per thread, each in its own cache line. */
+struct { _Alignas(64) size_t count; } counters[4];
+
+void bench_count(tapi_bench_state_t* state) {
+    counters[state->thread].count++;
+}
+
+/* the cpus and scheduling policy the benchmark body saw. */
+int seen_cpus, seen_policy;
+
+void bench_isolated(tapi_bench_state_t* state) {
+    (void) state;
+    cpu_set_t set;
+    if (sched_getaffinity(0, sizeof set, &set) == 0)
+        seen_cpus = CPU_COUNT(&set);
+    seen_policy = sched_getscheduler(0);
+}
+#pragma endregion
+
+/* the benchmark the running test made; its teardown takes it out of the suite and frees it,
+ *  even when an assert returned early. */
+tapi_bench_t* made;
+
+void destroy_made(void) {
+    tapi_bench_clear();
+    if (made != 0x0)
+        tapi_bench_destroy(&made, 1u);
+    made = 0x0;
+}
+
+/* region for all of the tests. */
+#pragma region tests
+e_tapi_test_result_t test_mwu_identical() {
+    /* arrange. */
+    double base[] = { 1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0, 8.0 };
+
+    /* act & assert. */
+    double p = tapi_bench_mwu(base, 8u, base, 8u);
+    tapi_assert(p > 0.4);
+    return E_TAPI_TEST_RESULT_PASSED;
+}
+
+e_tapi_test_result_t test_mwu_slower() {
+    /* arrange. */
+    double base[] = { 1.0, 1.1, 0.9, 1.0, 1.05, 0.95, 1.0, 1.02 };
+    double cur[] = { 2.0, 2.1, 1.9, 2.0, 2.05, 1.95, 2.0, 2.02 };
+
+    /* act & assert; slower is significant, faster is not. */
+    tapi_assert(tapi_bench_mwu(base, 8u, cur, 8u) < 0.01);
+    tapi_assert(tapi_bench_mwu(cur, 8u, base, 8u) > 0.99);
+    return E_TAPI_TEST_RESULT_PASSED;
+}
+
+e_tapi_test_result_t test_baseline_regression() {
+    /* arrange; save a baseline of the fast body. */
+    const char* path = "tapi_test_bench_baseline.txt";
+    tapi_bench_t* bench = made = tapi_bench_make("bench_kernel", bench_fast);
+    bench->repetitions = 10u;
+    bench->iterations = 1000u;
+    tapi_bench_add(bench);
+    tapi_quick_capture(stdout, 4096u);
+    tapi_bench_baseline(path, E_TAPI_BENCH_BASELINE_SAVE);
+    int saved = tapi_bench_run();
+
+    /* act; the same benchmark gets slower and is compared against the baseline. */
+    bench->function = bench_slow;
+    tapi_bench_baseline(path, E_TAPI_BENCH_BASELINE_COMPARE);
+    int compared = tapi_bench_run();
+    tapi_quick_end_capture();
+    tapi_bench_clear();
+    remove(path);
+
+    /* assert. */
+    tapi_assert(saved == EXIT_SUCCESS);
+    tapi_assert(compared == EXIT_FAILURE);
+    tapi_assert(bench->result == E_TAPI_TEST_RESULT_FAILED);
+    tapi_assert(strstr(sink->buffer.data, "regressed") != 0x0);
+    tapi_quick_destroy_capture();
+    return E_TAPI_TEST_RESULT_PASSED;
+}
+
+e_tapi_test_result_t test_baseline_long_record() {
+    /* arrange; a baseline record far longer than any fixed line, half of it far faster than the
+     *  body and half far slower, so only a record read whole compares as unchanged. */
+    const char* path = "tapi_test_bench_long.txt";
+    FILE* file = fopen(path, "w");
+    tapi_assert(file != 0x0);
+    fprintf(file, "bench\tbench_long\t5000\t");
+    for (size_t i = 0u; i < 5000u; i++)
+        fprintf(file, i < 2500u ? "0.001 " : "1000000000 ");
+    fprintf(file, "\n");
+    fclose(file);
+    tapi_bench_t* bench = made = tapi_bench_make("bench_long", bench_fast);
+    bench->repetitions = 10u;
+    bench->iterations = 100u;
+    tapi_bench_add(bench);
+
+    /* act. */
+    tapi_quick_capture(stdout, 4096u);
+    tapi_bench_baseline(path, E_TAPI_BENCH_BASELINE_COMPARE);
+    int compared = tapi_bench_run();
+    tapi_quick_end_capture();
+    tapi_bench_clear();
+    tapi_bench_baseline(0x0, E_TAPI_BENCH_BASELINE_NONE);
+    remove(path);
+
+    /* assert. */
+    tapi_assert(compared == EXIT_SUCCESS);
+    tapi_assert(bench->result == E_TAPI_TEST_RESULT_PASSED);
+    tapi_quick_destroy_capture();
+    return E_TAPI_TEST_RESULT_PASSED;
+}
+
+e_tapi_test_result_t test_fit_classes() {
+    /* arrange; exact curves for every class. */
+    size_t sizes[12];
+    double times[5][12];
+    for (size_t i = 0u; i < 12u; i++) {
+        double n = (double)(sizes[i] = (size_t) 1u << (i + 1u));
+        times[0][i] = 40.0;
+        times[1][i] = 3.0 * (double)(i + 1u);
+        times[2][i] = 2.0 * n;
+        times[3][i] = 0.5 * n * (double)(i + 1u);
+        times[4][i] = 0.25 * n * n;
+    }
+
+    /* act & assert. */
+    for (size_t c = 0u; c < 5u; c++)
+        tapi_assert(tapi_bench_fit(sizes, times[c], 12u).complexity == E_TAPI_BENCH_O_1 + c);
+    tapi_bench_fit_t fit = tapi_bench_fit(sizes, times[2], 12u);
+    tapi_assert(fit.coef > 1.99 && fit.coef < 2.01 && fit.rms < 1e-9);
+    return E_TAPI_TEST_RESULT_PASSED;
+}
+
+e_tapi_test_result_t test_sweep_complexity_change() {
+    /* arrange; save a baseline of a linear sweep. */
+    const char* path = "tapi_test_bench_sweep.txt";
+    tapi_bench_t* bench = made = tapi_bench_make("bench_sweep", bench_linear);
+    bench->repetitions = 7u;
+    bench->iterations = 16u;
+    tapi_bench_sweep(bench, 64u, 2048u, 2.0);
+    tapi_bench_add(bench);
+    tapi_quick_capture(stdout, 8192u);
+    tapi_bench_baseline(path, E_TAPI_BENCH_BASELINE_SAVE);
+    tapi_bench_run();
+    e_tapi_bench_complexity_t linear = bench->fit.complexity;
+
+    /* act; the body accidentally became quadratic. */
+    bench->function = bench_quadratic;
+    tapi_bench_baseline(path, E_TAPI_BENCH_BASELINE_COMPARE);
+    int compared = tapi_bench_run();
+    tapi_quick_end_capture();
+    tapi_bench_clear();
+    remove(path);
+
+    /* assert. */
+    tapi_assert(linear == E_TAPI_BENCH_O_N);
+    tapi_assert(bench->fit.complexity == E_TAPI_BENCH_O_N2);
+    tapi_assert(bench->point_count == 6u && bench->points[5].size == 2048u);
+    tapi_assert(compared == EXIT_FAILURE);
+    tapi_assert(strstr(sink->buffer.data, "complexity changed from O(n)") != 0x0);
+    tapi_quick_destroy_capture();
+    return E_TAPI_TEST_RESULT_PASSED;
+}
+
+e_tapi_test_result_t test_cold_cache() {
+    /* arrange; link the lines into a single shuffled cycle. */
+    size_t order[CHASE_LINES];
+    for (size_t i = 0u; i < CHASE_LINES; i++)
+        order[i] = i;
+    srand(42);
+    for (size_t i = CHASE_LINES - 1u; i > 0u; i--) {
+        size_t j = (size_t) rand() % (i + 1u), t = order[i];
+        order[i] = order[j];
+        order[j] = t;
+    }
+    for (size_t i = 0u; i < CHASE_LINES; i++)
+        chase[order[i] * 8u] = order[(i + 1u) % CHASE_LINES] * 8u;
+    tapi_bench_t* bench = made = tapi_bench_make("bench_chase", bench_chase);
+    bench->repetitions = 5u;
+    bench->iterations = 4u;
+    tapi_bench_cache(bench, E_TAPI_BENCH_CACHE_BOTH, chase, sizeof chase);
+    tapi_bench_add(bench);
+
+    /* act. */
+    tapi_quick_capture(stdout, 8192u);
+    tapi_bench_baseline(0x0, E_TAPI_BENCH_BASELINE_NONE);
+    tapi_bench_run();
+    tapi_quick_end_capture();
+    tapi_bench_clear();
+
+    /* assert; missing every cache is several times slower than hitting them. */
+    tapi_assert(bench->cold.median > bench->stats.median * 2.0);
+    tapi_assert(strstr(sink->buffer.data, "ns/op cold") != 0x0);
+    tapi_quick_destroy_capture();
+    return E_TAPI_TEST_RESULT_PASSED;
+}
+
+e_tapi_test_result_t test_thread_scaling() {
+    /* arrange; no machine scales beyond perfectly, so this threshold is always missed. */
+    tapi_bench_t* bench = made = tapi_bench_make("bench_count", bench_count);
+    bench->repetitions = 5u;
+    bench->iterations = 100u;
+    bench->min_time = 2e6;
+    tapi_bench_threads(bench, 3u, 1.5);
+    tapi_bench_add(bench);
+
+    /* act. */
+    tapi_quick_capture(stdout, 16384u);
+    int result = tapi_bench_run();
+    tapi_quick_end_capture();
+    tapi_bench_clear();
+
+    /* assert; 1, 2 and 3 threads, each counting in its own slot. */
+    tapi_assert(bench->scale_count == 3u);
+    tapi_assert(bench->scaling[0].threads == 1u && bench->scaling[2].threads == 3u);
+    tapi_assert(bench->scaling[0].speedup == 1.0 && bench->scaling[1].throughput > 0.0);
+    tapi_assert(counters[0].count != 0u && counters[3].count == 0u);
+    tapi_assert(result == EXIT_FAILURE && bench->result == E_TAPI_TEST_RESULT_FAILED);
+    tapi_assert(strstr(sink->buffer.data, "threads=3:") != 0x0);
+    tapi_assert(strstr(sink->buffer.data, "scaling below threshold") != 0x0);
+    tapi_quick_destroy_capture();
+    return E_TAPI_TEST_RESULT_PASSED;
+}
+
+e_tapi_test_result_t test_isolation_restored() {
+    /* arrange; pin to the cpu we are on, and ask for SCHED_FIFO. */
+    cpu_set_t before;
+    tapi_assert(sched_getaffinity(0, sizeof before, &before) == 0);
+    int policy = sched_getscheduler(0);
+    tapi_bench_t* bench = made = tapi_bench_make("bench_isolated", bench_isolated);
+    bench->repetitions = 3u;
+    bench->iterations = 10u;
+    tapi_bench_add(bench);
+    tapi_bench_isolate(sched_getcpu(), E_TAPI_BENCH_ISOLATE_FIFO);
+
+    /* act. */
+    tapi_quick_capture(stdout, 16384u);
+    tapi_bench_run();
+    tapi_quick_end_capture();
+    tapi_bench_clear();
+    tapi_bench_isolate(-1, E_TAPI_BENCH_ISOLATE_NONE);
+
+    /* assert; what could be applied was seen by the body, and is undone after the run. */
+    cpu_set_t after;
+    tapi_assert(sched_getaffinity(0, sizeof after, &after) == 0);
+    tapi_assert(CPU_EQUAL(&before, &after));
+    tapi_assert(sched_getscheduler(0) == policy);
+    tapi_assert(!(bench->env.flags & E_TAPI_BENCH_ENV_PINNED) || seen_cpus == 1);
+    tapi_assert(!(bench->env.flags & E_TAPI_BENCH_ENV_FIFO) || seen_policy == SCHED_FIFO);
+    tapi_quick_destroy_capture();
+    return E_TAPI_TEST_RESULT_PASSED;
+}
+#pragma endregion
+
+int main() {
+    tapi_test_t* test_identical = tapi_test_make("test_mwu_identical", test_mwu_identical);
+    tapi_test_t* test_slower = tapi_test_make("test_mwu_slower", test_mwu_slower);
+    tapi_test_t* test_regression = tapi_test_make("test_baseline_regression",
+        test_baseline_regression);
+    tapi_test_t* test_long = tapi_test_make("test_baseline_long_record",
+        test_baseline_long_record);
+    tapi_test_t* test_fit = tapi_test_make("test_fit_classes", test_fit_classes);
+    tapi_test_t* test_sweep = tapi_test_make("test_sweep_complexity_change",
+        test_sweep_complexity_change);
+    tapi_test_t* test_cold = tapi_test_make("test_cold_cache", test_cold_cache);
+    tapi_test_t* test_threads = tapi_test_make("test_thread_scaling", test_thread_scaling);
+    tapi_test_t* test_isolation = tapi_test_make("test_isolation_restored",
+        test_isolation_restored);
+    tapi_test_t* benched[] = { test_regression, test_long, test_sweep, test_cold, test_threads,
+                               test_isolation };
+    for (size_t i = 0u; i < 6u; i++)
+        benched[i]->teardown = destroy_made;
+    tapi_test_t* tests[] = { test_identical, test_slower, test_regression, test_long, test_fit,
+                             test_sweep, test_cold, test_threads, test_isolation };
+    tapi_test_setup(tests, 9u);
+    tapi_test_run();
+    return 0;
+}
@@ -0,0 +1,120 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-10-19
+ */
+#include <tapi/tapi.h>
+
+/*! @uses dyna_t, dyna_make, dyna_pop, dyna_define, etc... */
+#include <tapi/dyna.h>
+
+/*! @uses tapi_assert_no_alloc. */
+#include <tapi/alloc.h>
+
+/* a vector of integers with room for four inline. */
+dyna_define(ints, int, 4u)
+
+/* region for the functions that are asserted on. */
+#pragma region helpers
+int compare_ints(const void* a, const void* b) {
+    int x = *(const int*) a, y = *(const int*) b;
+    return (x > y) - (x < y);
+}
+#pragma endregion
+
+/* region for all of the tests. */
+#pragma region tests
+e_tapi_test_result_t test_inline_storage() {
+    /* arrange. */
+    ints_t vector = { 0 };
+
+    /* act; the first four stay inline, the fifth moves them onto the heap. */
+    tapi_assert_no_alloc {
+        for (int i = 0; i < 4; i++)
+            ints_push(&vector, i);
+    }
+    tapi_assert(vector.data == vector.inline_ && vector.capacity == 4u);
+    tapi_assert(ints_push(&vector, 4));
+
+    /* assert. */
+    tapi_assert(vector.data != vector.inline_ && vector.capacity >= 5u);
+    int sum = 0;
+    _vforeach(&vector, int, value)
+        sum += value;
+    _endforeach;
+    tapi_assert(vector.length == 5u && sum == 10);
+    tapi_assert(ints_pop(&vector) == 4 && vector.length == 4u);
+    ints_free(&vector);
+    tapi_assert(vector.data == 0x0 && vector.length == 0u);
+    return E_TAPI_TEST_RESULT_PASSED;
+}
+
+e_tapi_test_result_t test_bulk() {
+    /* arrange. */
+    ints_t vector = { 0 };
+    const int values[] = { 0, 1, 2, 3, 4, 5 }, inserted[] = { 7, 8, 9 };
+
+    /* act; replace 2 and 3 with 7, 8 and 9, then drop the 7 again. */
+    tapi_assert(ints_reserve(&vector, 16u) && vector.capacity >= 16u);
+    tapi_assert(ints_push_n(&vector, values, 6u));
+    tapi_assert(ints_splice(&vector, 2u, 2u, inserted, 3u));
+    const int spliced[] = { 0, 1, 7, 8, 9, 4, 5 };
+    tapi_assert(vector.length == 7u);
+    for (size_t i = 0u; i < 7u; i++)
+        tapi_assert(vector.data[i] == spliced[i]);
+    tapi_assert(ints_splice(&vector, 2u, 1u, 0x0, 0u));
+
+    /* assert. */
+    const int removed[] = { 0, 1, 8, 9, 4, 5 };
+    tapi_assert(vector.length == 6u);
+    for (size_t i = 0u; i < 6u; i++)
+        tapi_assert(vector.data[i] == removed[i]);
+    ints_free(&vector);
+    return E_TAPI_TEST_RESULT_PASSED;
+}
+
+e_tapi_test_result_t test_swap_remove_sort() {
+    /* arrange. */
+    ints_t vector = { 0 };
+    const int values[] = { 5, 3, 9, 1, 7 };
+    ints_push_n(&vector, values, 5u);
+
+    /* act; the last element takes the place of the removed one. */
+    tapi_assert(ints_swap_remove(&vector, 1u) == 3);
+    tapi_assert(vector.length == 4u && vector.data[1] == 7);
+    ints_sort(&vector, compare_ints);
+
+    /* assert. */
+    const int sorted[] = { 1, 5, 7, 9 };
+    for (size_t i = 0u; i < 4u; i++)
+        tapi_assert(vector.data[i] == sorted[i]);
+    ints_free(&vector);
+    return E_TAPI_TEST_RESULT_PASSED;
+}
+
+e_tapi_test_result_t test_dyna_make() {
+    /* arrange. */
+    int a = 1, b = 2, c = 3;
+    void* items[] = { &a, &b, &c };
+
+    /* act; every pointer is copied, and popping keeps the order. */
+    dyna_t* array = dyna_make(items, 3u);
+    void* popped = dyna_pop(array, 0u);
+
+    /* assert. */
+    tapi_assert(popped == &a && array->length == 2u);
+    tapi_assert(dyna_get(array, 0u) == &b && dyna_get(array, 1u) == &c);
+    dyna_free(array);
+    return E_TAPI_TEST_RESULT_PASSED;
+}
+#pragma endregion
+
+int main() {
+    tapi_test_t* test_inline = tapi_test_make("test_inline_storage", test_inline_storage);
+    tapi_test_t* test_bulk_ = tapi_test_make("test_bulk", test_bulk);
+    tapi_test_t* test_swap = tapi_test_make("test_swap_remove_sort", test_swap_remove_sort);
+    tapi_test_t* test_make = tapi_test_make("test_dyna_make", test_dyna_make);
+    tapi_test_t* tests[] = { test_inline, test_bulk_, test_swap, test_make };
+    tapi_test_setup(tests, 4u);
+    tapi_test_run();
+    return 0;
+}
@@ -0,0 +1,120 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-10-19
+ */
+#include <tapi/tapi.h>
+
+/*! @uses tapi_hist_t, etc... */
+#include <tapi/hist.h>
+
+/*! @uses tapi_quick_capture, etc... */
+#include <tapi/capture.h>
+
+/*! @uses strstr. */
+#include <string.h>
+
+/* region for all of the tests. */
+#pragma region tests
+e_tapi_test_result_t test_hist_exact() {
+    /* arrange; small values are counted exactly. */
+    tapi_hist_t* hist = tapi_hist_make();
+    for (uint64_t i = 1u; i <= 100u; i++)
+        tapi_hist_record(hist, i);
+
+    /* assert. */
+    tapi_assert(hist->count == 100u && hist->min == 1u && hist->max == 100u);
+    tapi_assert(tapi_hist_percentile(hist, 50.0) == 50u);
+    tapi_assert(tapi_hist_percentile(hist, 99.0) == 99u);
+    tapi_assert(tapi_hist_percentile(hist, 100.0) == 100u);
+    tapi_assert(tapi_hist_mean(hist) == 50.5);
+    tapi_hist_destroy(hist);
+    return E_TAPI_TEST_RESULT_PASSED;
+}
+
+e_tapi_test_result_t test_hist_relative_error() {
+    /* arrange. */
+    tapi_hist_t* hist = tapi_hist_make();
+
+    /* act & assert; every large value is reported within 1.6% of itself. */
+    for (uint64_t value = 129u; value < (1ull << 40u); value = value * 3u + 7u) {
+        tapi_hist_reset(hist);
+        tapi_hist_record(hist, value);
+        tapi_hist_record(hist, value * 2u);
+        uint64_t p50 = tapi_hist_percentile(hist, 50.0);
+        tapi_assert(p50 >= value && (double)(p50 - value) <= (double) value * 0.016);
+    }
+    tapi_hist_destroy(hist);
+    return E_TAPI_TEST_RESULT_PASSED;
+}
+
+e_tapi_test_result_t test_hist_merge() {
+    /* arrange; two "threads" record disjoint halves. */
+    tapi_hist_t* a = tapi_hist_make();
+    tapi_hist_t* b = tapi_hist_make();
+    for (uint64_t i = 0u; i < 990u; i++)
+        tapi_hist_record(a, 10u);
+    for (uint64_t i = 0u; i < 10u; i++)
+        tapi_hist_record_atomic(b, 100000u);
+
+    /* act. */
+    tapi_hist_merge(a, b);
+
+    /* assert; the tail only shows up past p99. */
+    tapi_assert(a->count == 1000u && a->min == 10u && a->max == 100000u);
+    tapi_assert_p99_below(a, 10u);
+    tapi_assert(tapi_hist_percentile(a, 99.9) >= 100000u);
+    tapi_hist_destroy(a);
+    tapi_hist_destroy(b);
+    return E_TAPI_TEST_RESULT_PASSED;
+}
+
+e_tapi_test_result_t test_hist_over_budget() {
+    /* arrange. */
+    tapi_hist_t* hist = tapi_hist_make();
+    for (uint64_t i = 0u; i < 100u; i++)
+        tapi_hist_record(hist, i < 98u ? 100u : 5000u);
+
+    /* act; timing a statement records a single value. */
+    tapi_hist_time(hist, (void) 0);
+
+    /* assert; the median is within budget, but the tail is not. */
+    tapi_assert(hist->count == 101u);
+    tapi_assert_p50_below(hist, 100u);
+    tapi_assert(tapi_hist_percentile(hist, 99.0) > 1000u);
+    tapi_hist_destroy(hist);
+    return E_TAPI_TEST_RESULT_PASSED;
+}
+
+e_tapi_test_result_t test_hist_export() {
+    /* arrange. */
+    tapi_hist_t* hist = tapi_hist_make();
+    tapi_hist_record(hist, 3u);
+    tapi_hist_record(hist, 3u);
+    tapi_hist_record(hist, 1000u);
+
+    /* act. */
+    tapi_quick_capture(stdout, 512u);
+    tapi_hist_export(hist, stdout);
+    tapi_quick_end_capture();
+
+    /* assert. */
+    tapi_assert(strstr(sink->buffer.data, "\"count\":3") != 0x0);
+    tapi_assert(strstr(sink->buffer.data, "[3,3,2]") != 0x0);
+    tapi_assert(strstr(sink->buffer.data, "\"p999\":1000") != 0x0);
+    tapi_quick_destroy_capture();
+    tapi_hist_destroy(hist);
+    return E_TAPI_TEST_RESULT_PASSED;
+}
+#pragma endregion
+
+int main() {
+    tapi_test_t* test_exact = tapi_test_make("test_hist_exact", test_hist_exact);
+    tapi_test_t* test_error = tapi_test_make("test_hist_relative_error", test_hist_relative_error);
+    tapi_test_t* test_merge = tapi_test_make("test_hist_merge", test_hist_merge);
+    tapi_test_t* test_budget = tapi_test_make("test_hist_over_budget", test_hist_over_budget);
+    tapi_test_t* test_export = tapi_test_make("test_hist_export", test_hist_export);
+    tapi_test_t* tests[] = { test_exact, test_error, test_merge, test_budget, test_export };
+    tapi_test_setup(tests, 5u);
+    tapi_test_run();
+    return 0;
+}
@@ -2,11 +2,33 @@
  * @author Sean Hobeck
  * @date 2026-02-23
  */
+#define _GNU_SOURCE
 #include <tapi/tapi.h>
 
 /*! @uses tapi_mock_return. */
 #include <tapi/mock.h>
 
+/*! @uses tapi_spy_count, tapi_assert_calls, etc... */
+#include <tapi/spy.h>
+
+/*! @uses tapi_bench_t, etc... */
+#include <tapi/bench.h>
+
+/*! @uses tapi_quick_capture, etc... */
+#include <tapi/capture.h>
+
+/*! @uses strstr. */
+#include <string.h>
+
+/*! @uses getpid. */
+#include <unistd.h>
+
+/*! @uses pthread_t, pthread_create, pthread_join. */
+#include <pthread.h>
+
+/*! @uses mmap, mprotect. */
+#include <sys/mman.h>
+
 /* region for all of the test call targets and assembly specific fuctions. */
 #pragma region test call targets
 int target_function(int x) {
@@ -92,6 +114,48 @@ int asm_caller_thumb() {
 }
 #endif
 
+int indirect_target(int x) {
+    return x;
+}
+
+/* the pointer an indirect call goes through, like a got slot; read-only once relocated (relro),
+ *  as only a call through such a slot is mocked. */
+int (* const indirect_slot)(int) = indirect_target;
+
+/* what -fno-plt emits for a call into another object; through the slot, not to the target. */
+#if defined(__x86_64__)
+int indirect_caller(int x);
+__asm__(".text\n"
+        ".globl indirect_caller\n"
+        ".type indirect_caller, @function\n"
+        "indirect_caller:\n"
+        "    sub $8, %rsp\n"
+        "    call *indirect_slot(%rip)\n"
+        "    add $1, %eax\n"
+        "    add $8, %rsp\n"
+        "    ret\n"
+        ".size indirect_caller, .-indirect_caller\n");
+#elif defined(__aarch64__)
+int indirect_caller(int x);
+__asm__(".text\n"
+        ".globl indirect_caller\n"
+        ".type indirect_caller, %function\n"
+        "indirect_caller:\n"
+        "    stp x29, x30, [sp, #-16]!\n"
+        "    adrp x16, indirect_slot\n"
+        "    ldr x16, [x16, :lo12:indirect_slot]\n"
+        "    blr x16\n"
+        "    add w0, w0, #1\n"
+        "    ldp x29, x30, [sp], #16\n"
+        "    ret\n"
+        ".size indirect_caller, .-indirect_caller\n");
+#else
+/* indirect calls aren't patched here, a direct call stands in. */
+int indirect_caller(int x) {
+    return indirect_target(x) + 1;
+}
+#endif
+
 int nested_target(int x) {
     return x * 2;
 }
@@ -114,6 +178,358 @@ int conditional_caller(int use_target) {
     }
     return 0;
 }
+
+int multi_target(int x) {
+    return x;
+}
+
+int multi_caller(int n) {
+    /* the target is called in the loop, and again on the error path. */
+    if (n < 0)
+        return multi_target(-1);
+    int sum = 0;
+    for (int i = 0; i < n; i++)
+        sum += multi_target(i);
+    return sum;
+}
+
+int shared_target(int x) {
+    return x - 1;
+}
+
+int shared_caller_a(int x) {
+    return shared_target(x) * 2;
+}
+
+int shared_caller_b(int x) {
+    return shared_target(x) * 3;
+}
+
+int stacked_target(int x) {
+    return x;
+}
+
+int stacked_caller(int x) {
+    return stacked_target(x) + 1;
+}
+
+int entry_target(int x) {
+    return x * 3 + 1;
+}
+
+/* called through a pointer, where no call site names the target. */
+int (*volatile entry_pointer)(int) = entry_target;
+
+/* the value a pc-relative load in a prologue reads. */
+int reloc_value = 40;
+
+/* prologues that read the pc, each displaced by an entry patch and relocated into a trampoline;
+ *  jcc gives x + 1 (or -1 for 0), call 2x + 1, and literal x + 40. inner loops back into its own
+ *  prologue, and spin branches from it back to its start, neither can be relocated. */
+int reloc_jcc(int x);
+int reloc_call(int x);
+int reloc_literal(int x);
+int reloc_inner(int x, int n);
+int reloc_spin(int x);
+#if defined(__x86_64__)
+__asm__(".text\n"
+        ".globl reloc_jcc, reloc_call, reloc_double, reloc_literal, reloc_inner, reloc_spin\n"
+        ".type reloc_jcc, @function\n"
+        "reloc_jcc:\n"
+        "    test %edi, %edi\n"
+        "    jz 1f\n"
+        "    lea 1(%rdi), %eax\n"
+        "    ret\n"
+        "1:  mov $-1, %eax\n"
+        "    ret\n"
+        ".size reloc_jcc, .-reloc_jcc\n"
+        ".type reloc_call, @function\n"
+        "reloc_call:\n"
+        "    call reloc_double\n"
+        "    add $1, %eax\n"
+        "    ret\n"
+        ".size reloc_call, .-reloc_call\n"
+        ".type reloc_double, @function\n"
+        "reloc_double:\n"
+        "    lea (%rdi, %rdi), %eax\n"
+        "    ret\n"
+        ".size reloc_double, .-reloc_double\n"
+        ".type reloc_literal, @function\n"
+        "reloc_literal:\n"
+        "    mov reloc_value(%rip), %eax\n"
+        "    add %edi, %eax\n"
+        "    ret\n"
+        ".size reloc_literal, .-reloc_literal\n"
+        ".type reloc_inner, @function\n"
+        "reloc_inner:\n"
+        "    xor %eax, %eax\n"
+        "1:  add %edi, %eax\n"
+        "    dec %esi\n"
+        "    jnz 1b\n"
+        "    ret\n"
+        ".size reloc_inner, .-reloc_inner\n"
+        ".type reloc_spin, @function\n"
+        "reloc_spin:\n"
+        "    dec %edi\n"
+        "    jnz reloc_spin\n"
+        "    xor %eax, %eax\n"
+        "    ret\n"
+        ".size reloc_spin, .-reloc_spin\n");
+#elif defined(__aarch64__)
+/* an entry patch displaces a single instruction here; call is a b to a function giving 2x + 1,
+ *  and nothing can branch strictly within one instruction, so inner is plain. */
+__asm__(".text\n"
+        ".globl reloc_jcc, reloc_call, reloc_double, reloc_literal, reloc_inner, reloc_spin\n"
+        ".type reloc_jcc, %function\n"
+        "reloc_jcc:\n"
+        "    cbz w0, 1f\n"
+        "    add w0, w0, #1\n"
+        "    ret\n"
+        "1:  mov w0, #-1\n"
+        "    ret\n"
+        ".size reloc_jcc, .-reloc_jcc\n"
+        ".type reloc_call, %function\n"
+        "reloc_call:\n"
+        "    b reloc_double\n"
+        "    ret\n"
+        ".size reloc_call, .-reloc_call\n"
+        ".type reloc_double, %function\n"
+        "reloc_double:\n"
+        "    lsl w0, w0, #1\n"
+        "    add w0, w0, #1\n"
+        "    ret\n"
+        ".size reloc_double, .-reloc_double\n"
+        ".type reloc_literal, %function\n"
+        "reloc_literal:\n"
+        "    ldr w1, 1f\n"
+        "    add w0, w0, w1\n"
+        "    ret\n"
+        "1:  .word 40\n"
+        ".size reloc_literal, .-reloc_literal\n"
+        ".type reloc_inner, %function\n"
+        "reloc_inner:\n"
+        "    mul w0, w0, w1\n"
+        "    ret\n"
+        ".size reloc_inner, .-reloc_inner\n"
+        ".type reloc_spin, %function\n"
+        "reloc_spin:\n"
+        "    cbnz w0, reloc_spin\n"
+        "    ret\n"
+        ".size reloc_spin, .-reloc_spin\n");
+#elif defined(__arm__)
+__asm__(".text\n"
+        ".arm\n"
+        ".globl reloc_jcc, reloc_call, reloc_double, reloc_literal, reloc_inner, reloc_spin\n"
+        ".type reloc_jcc, %function\n"
+        "reloc_jcc:\n"
+        "    cmp r0, #0\n"
+        "    beq 1f\n"
+        "    add r0, r0, #1\n"
+        "    bx lr\n"
+        "1:  mvn r0, #0\n"
+        "    bx lr\n"
+        ".size reloc_jcc, .-reloc_jcc\n"
+        ".type reloc_call, %function\n"
+        "reloc_call:\n"
+        "    push {r4, lr}\n"
+        "    bl reloc_double\n"
+        "    add r0, r0, #1\n"
+        "    pop {r4, pc}\n"
+        ".size reloc_call, .-reloc_call\n"
+        ".type reloc_double, %function\n"
+        "reloc_double:\n"
+        "    add r0, r0, r0\n"
+        "    bx lr\n"
+        ".size reloc_double, .-reloc_double\n"
+        ".type reloc_literal, %function\n"
+        "reloc_literal:\n"
+        "    ldr r1, 1f\n"
+        "    add r0, r0, r1\n"
+        "    bx lr\n"
+        "1:  .word 40\n"
+        ".size reloc_literal, .-reloc_literal\n"
+        ".type reloc_inner, %function\n"
+        "reloc_inner:\n"
+        "    mov r2, #0\n"
+        "1:  add r2, r2, r0\n"
+        "    subs r1, r1, #1\n"
+        "    bne 1b\n"
+        "    mov r0, r2\n"
+        "    bx lr\n"
+        ".size reloc_inner, .-reloc_inner\n"
+        ".type reloc_spin, %function\n"
+        "reloc_spin:\n"
+        "    subs r0, r0, #1\n"
+        "    bne reloc_spin\n"
+        "    bx lr\n"
+        ".size reloc_spin, .-reloc_spin\n");
+#else
+/* i386 has no pc-relative loads, the compiler's prologues stand in. */
+int reloc_jcc(int x) {
+    return x != 0 ? x + 1 : -1;
+}
+
+int reloc_call(int x) {
+    return nested_target(x) + 1;
+}
+
+int reloc_literal(int x) {
+    return x + reloc_value;
+}
+
+int reloc_inner(int x, int n) {
+    return x * n;
+}
+
+int reloc_spin(int x) {
+    return x;
+}
+#endif
+
+int expensive_target(int x) {
+    for (volatile int i = 0; i < 1000; i++);
+    return x;
+}
+
+int expensive_caller(int x) {
+    return expensive_target(x) + 1;
+}
+
+int live_target(int x) {
+    return x + 3;
+}
+
+int live_caller(int x) {
+    return live_target(x) + 1;
+}
+
+/* set once the threads calling into live mocks are to stop, and how many results were wrong. */
+int live_stop, live_wrong;
+
+void* live_worker(void* arg) {
+    int pid = *(int*) arg;
+    while (!__atomic_load_n(&live_stop, __ATOMIC_ACQUIRE)) {
+        /* either the original or the mock, never anything in between. */
+        int result = live_caller(2), id = getpid();
+        if ((result != 6 && result != 12) || (id != pid && id != 4242))
+            __atomic_fetch_add(&live_wrong, 1, __ATOMIC_RELAXED);
+    }
+    return 0x0;
+}
+
+int live_entry_target(int x) {
+    return x * 5;
+}
+
+/* set once the threads running through a live entry mock are to stop, and how many were wrong. */
+int live_entry_stop, live_entry_wrong;
+
+void* live_entry_worker(void* arg) {
+    (void) arg;
+    while (!__atomic_load_n(&live_entry_stop, __ATOMIC_ACQUIRE)) {
+        /* the original or the mock, the threads are stopped outside of the entry it's written. */
+        int result = live_entry_target(2);
+        if (result != 10 && result != 13)
+            __atomic_fetch_add(&live_entry_wrong, 1, __ATOMIC_RELAXED);
+    }
+    return 0x0;
+}
+
+int dispatch_target(int x) {
+    return x * 2;
+}
+
+int dispatch_caller(int x) {
+    return dispatch_target(x) + 1;
+}
+
+/* a thread with its own dispatch mock, and how many of its calls didn't go to it. */
+typedef struct {
+    tapi_mock_t* mock;
+    int expected, wrong;
+} dispatch_run_t;
+
+void* dispatch_worker(void* arg) {
+    dispatch_run_t* run = arg;
+    tapi_mock_apply(run->mock);
+    for (int i = 0; i < 100000; i++)
+        run->wrong += dispatch_caller(i) != run->expected;
+    tapi_mock_restore(run->mock);
+    return 0x0;
+}
+
+/* a thread creating mocks like one made before, at the same time as others, and how many of
+ *  them it got wrong. */
+typedef struct {
+    tapi_mock_t* like;
+    int wrong;
+} create_run_t;
+
+void* create_worker(void* arg) {
+    create_run_t* run = arg;
+    for (int i = 0; i < 256; i++) {
+        tapi_mock_t* mock = tapi_mock_create(run->like->orig, run->like->target,
+                                             run->like->mocked);
+        run->wrong += mock == 0x0 || mock->count != run->like->count;
+    }
+    return 0x0;
+}
+
+int spy_target(int a, long b) {
+    return a + (int) b;
+}
+
+int spy_caller(int n) {
+    int sum = 0;
+    for (int i = 0; i < n; i++)
+        sum += spy_target(i, i * 10l);
+    return sum;
+}
+
+int far_target(int x) {
+    return x;
+}
+
+int far_caller(int x) {
+    return far_target(x) + 1;
+}
+
+/* a mock mapped far out of range of a call to it, as if from a far away shared object; it
+ *  returns 77, or 0x0 if no page that far could be mapped. */
+void* far_mock_map() {
+#if defined(__x86_64__) || defined(__i386__)
+    static const unsigned char code[] = { 0xb8, 0x4d, 0x00, 0x00, 0x00, 0xc3 };
+#elif defined(__aarch64__)
+    static const unsigned int code[] = { 0x528009a0, 0xd65f03c0 };
+#elif defined(__arm__)
+    static const unsigned int code[] = { 0xe3a0004d, 0xe12fff1e };
+#endif
+    unsigned long long distance = sizeof(void*) == 8u ? 8ull << 30u : 1ull << 28u;
+    void* hint = (void*)(((uintptr_t) far_caller + (uintptr_t) distance) & ~(uintptr_t) 0xfffu);
+#if defined(MAP_FIXED_NOREPLACE)
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE;
+#else
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+#endif
+    void* page = mmap(hint, 4096u, PROT_READ | PROT_WRITE, flags, -1, 0);
+    if (page == MAP_FAILED)
+        return 0x0;
+
+    /* the hint is only a hint without MAP_FIXED_NOREPLACE (or on older kernels). */
+    uintptr_t from = (uintptr_t) far_caller, to = (uintptr_t) page;
+    if ((to > from ? to - from : from - to) < (uintptr_t) distance / 2u) {
+        munmap(page, 4096u);
+        return 0x0;
+    }
+    memcpy(page, code, sizeof code);
+    mprotect(page, 4096u, PROT_READ | PROT_EXEC);
+    __builtin___clear_cache((char*) page, (char*) page + sizeof code);
+    return page;
+}
+
+void bench_expensive_caller(tapi_bench_state_t* state) {
+    tapi_bench_keep(expensive_caller((int) state->index));
+}
 #pragma endregion
 
 /* region for all of the setups and mock return values. */
@@ -127,8 +543,25 @@ tapi_mock_return(mock_asm_target_aarch64, int, 0x100);
 tapi_mock_return(mock_asm_target_arm32, int, 0x100);
 tapi_mock_return(mock_asm_target_thumb, int, 0x100);
 #endif
+tapi_mock_return(mock_indirect_target, int, 0x100);
 tapi_mock_return(mock_nested_target, int, 42);
 tapi_mock_return(mock_conditional_target, int, 999);
+tapi_mock_return(mock_expensive_target, int, 1);
+tapi_mock_return(mock_shared_target, int, 7);
+tapi_mock_return(mock_multi_target, int, 1);
+tapi_mock_return(mock_stacked_a, int, 10);
+tapi_mock_return(mock_stacked_b, int, 20);
+tapi_mock_return(mock_entry_target, int, 9);
+tapi_mock_return(mock_reloc, int, 500);
+tapi_mock_return(mock_getpid, int, 4242);
+tapi_mock_return(mock_live_target, int, 11);
+tapi_mock_return(mock_live_entry_target, int, 13);
+tapi_mock_return(mock_dispatch_a, int, 100);
+tapi_mock_return(mock_dispatch_b, int, 200);
+
+/* the entry and got mocks, for calling the originals, and the spy. */
+tapi_mock_t* entry_mock, *got_mock, *spy_mock;
+void* far_mock;
 #pragma endregion
 
 /* region for all of the tests. */
@@ -170,6 +603,13 @@ e_tapi_test_result_t test_asm_thumb_mock() {
 }
 #endif
 
+e_tapi_test_result_t test_indirect_mock() {
+    /* act & assert; the call through the slot was patched, the slot itself wasn't. */
+    tapi_assert(indirect_caller(2) == 0x101);
+    tapi_assert(indirect_slot(2) == 2);
+    return E_TAPI_TEST_RESULT_PASSED;
+}
+
 e_tapi_test_result_t test_nested_mock() {
     /* act & assert. */
     int result = nested_caller();
@@ -183,6 +623,329 @@ e_tapi_test_result_t test_conditional_mock() {
     tapi_assert(result == 999);
     return E_TAPI_TEST_RESULT_PASSED;
 }
+
+e_tapi_test_result_t test_multi_site_mock() {
+    /* act & assert; both calls were redirected. */
+    tapi_assert(multi_caller(4) == 4);
+    tapi_assert(multi_caller(-3) == 1);
+    return E_TAPI_TEST_RESULT_PASSED;
+}
+
+e_tapi_test_result_t test_multi_site_restored() {
+    /* act & assert; and both were restored together. */
+    tapi_assert(multi_caller(4) == 6);
+    tapi_assert(multi_caller(-3) == -1);
+    return E_TAPI_TEST_RESULT_PASSED;
+}
+
+e_tapi_test_result_t test_mock_all_callers() {
+    /* act & assert; both callers were found without listing either of them. */
+    tapi_assert(shared_caller_a(100) == 14);
+    tapi_assert(shared_caller_b(100) == 21);
+    return E_TAPI_TEST_RESULT_PASSED;
+}
+
+/* restore mocks in one batch, and whether any of their sites was taken as changed. */
+bool restore_warned(tapi_mock_t** mocks, size_t count) {
+    tapi_quick_capture(stderr, 4096u);
+    tapi_mock_restore_all(mocks, count);
+    tapi_quick_end_capture();
+    bool warned = strstr(sink->buffer.data, "changed while mocked") != 0x0;
+    tapi_quick_destroy_capture();
+    return warned;
+}
+
+e_tapi_test_result_t test_stacked_restore() {
+    /* arrange; two mocks of the same call, the second applied over the first. */
+    tapi_mock_t* mocks[2] = { tapi_mock_create(stacked_caller, stacked_target, mock_stacked_a),
+                              tapi_mock_create(stacked_caller, stacked_target, mock_stacked_b) };
+    tapi_assert(mocks[0] != 0x0 && mocks[1] != 0x0);
+    tapi_mock_apply(mocks[0]);
+    tapi_mock_apply(mocks[1]);
+    int stacked = stacked_caller(1);
+
+    /* act; both are restored in one batch. */
+    bool warned = restore_warned(mocks, 2u);
+
+    /* assert; the site went back through both mocks, neither took it as changed. */
+    tapi_assert(stacked == 21);
+    tapi_assert(!warned);
+    tapi_assert(stacked_caller(1) == 2);
+
+    /* act again; both are applied in one batch too, each keeps the bytes of its own patch. */
+    tapi_mock_apply_all(mocks, 2u);
+    stacked = stacked_caller(1);
+    warned = restore_warned(mocks, 2u);
+
+    /* assert. */
+    tapi_assert(stacked == 21);
+    tapi_assert(!warned);
+    tapi_assert(stacked_caller(1) == 2);
+    return E_TAPI_TEST_RESULT_PASSED;
+}
+
+e_tapi_test_result_t test_changed_restore() {
+    /* arrange; the call is put back behind the mock's back, as by something else patching it. */
+    tapi_mock_t* mock = tapi_mock_create(stacked_caller, stacked_target, mock_stacked_a);
+    tapi_assert(mock != 0x0 && mock->count == 1u);
+    tapi_mock_apply(mock);
+    int mocked = stacked_caller(1);
+    tapi_mock_site_t* site = &mock->sites[0];
+    char* page = (char*)((uintptr_t) site->call & ~(uintptr_t) 0xfffu);
+    size_t length = (size_t)((char*) site->call + site->size - page);
+    tapi_assert(mprotect(page, length, PROT_READ | PROT_WRITE | PROT_EXEC) == 0);
+    memcpy(site->call, site->orig_bytes, site->size);
+    mprotect(page, length, PROT_READ | PROT_EXEC);
+    __builtin___clear_cache((char*) site->call, (char*) site->call + site->size);
+
+    /* act. */
+    tapi_quick_capture(stderr, 4096u);
+    tapi_mock_restore(mock);
+    tapi_quick_end_capture();
+    bool warned = strstr(sink->buffer.data, "changed while mocked") != 0x0;
+    tapi_quick_destroy_capture();
+
+    /* assert; the change was noticed, and left as it is. */
+    tapi_assert(mocked == 11);
+    tapi_assert(warned);
+    tapi_assert(stacked_caller(1) == 2);
+    return E_TAPI_TEST_RESULT_PASSED;
+}
+
+e_tapi_test_result_t test_entry_mock() {
+    /* act & assert; direct and indirect calls are both redirected, the original still runs. */
+    tapi_assert(entry_mock != 0x0);
+    int (*original)(int) = (int (*)(int)) entry_mock->original;
+    tapi_assert(entry_target(5) == 9);
+    tapi_assert(entry_pointer(5) == 9);
+    tapi_assert(original(5) == 16);
+    return E_TAPI_TEST_RESULT_PASSED;
+}
+
+e_tapi_test_result_t test_entry_restored() {
+    /* act & assert; the entry was restored after the last test. */
+    tapi_assert(entry_target(5) == 16);
+    tapi_assert(entry_pointer(2) == 7);
+    return E_TAPI_TEST_RESULT_PASSED;
+}
+
+e_tapi_test_result_t test_entry_relocated() {
+    /* arrange; each prologue reads the pc in its own way. */
+    void* targets[3] = { reloc_jcc, reloc_call, reloc_literal };
+    tapi_mock_t* mocks[3];
+    for (size_t i = 0u; i < 3u; i++) {
+        mocks[i] = tapi_mock_create_entry(targets[i], mock_reloc);
+        tapi_assert(mocks[i] != 0x0);
+    }
+    int (*jcc)(int) = (int (*)(int)) mocks[0]->original;
+    int (*call)(int) = (int (*)(int)) mocks[1]->original;
+    int (*literal)(int) = (int (*)(int)) mocks[2]->original;
+
+    /* act; the targets go to the mock, the originals run the relocated prologues. */
+    tapi_mock_apply_all(mocks, 3u);
+    int mocked = reloc_jcc(4) + reloc_call(4) + reloc_literal(4);
+    int taken = jcc(0), not_taken = jcc(4), called = call(4), loaded = literal(2);
+    tapi_mock_restore_all(mocks, 3u);
+
+    /* assert. */
+    tapi_assert(mocked == 1500);
+    tapi_assert(taken == -1 && not_taken == 5);
+    tapi_assert(called == 9);
+    tapi_assert(loaded == 42);
+    tapi_assert(reloc_jcc(4) == 5 && reloc_call(4) == 9 && reloc_literal(2) == 42);
+
+    /* and neither a loop into the displaced instructions nor one back to the start is patched. */
+#if defined(__x86_64__) || defined(__arm__)
+    tapi_assert(tapi_mock_create_entry(reloc_inner, mock_reloc) == 0x0);
+#endif
+#if !defined(__i386__)
+    tapi_assert(tapi_mock_create_entry(reloc_spin, mock_reloc) == 0x0);
+#endif
+    return E_TAPI_TEST_RESULT_PASSED;
+}
+
+e_tapi_test_result_t test_got_mock() {
+    /* act & assert; the call into libc goes through the swapped slot, the original doesn't. */
+    tapi_assert(got_mock != 0x0);
+    int (*original)(void) = (int (*)(void)) got_mock->original;
+    tapi_assert(getpid() == 4242);
+    tapi_assert(original() != 4242 && original() > 0);
+    return E_TAPI_TEST_RESULT_PASSED;
+}
+
+e_tapi_test_result_t test_got_restored() {
+    /* act & assert; the slot was restored after the last test. */
+    tapi_assert(got_mock != 0x0);
+    int (*original)(void) = (int (*)(void)) got_mock->original;
+    tapi_assert(getpid() == original());
+    return E_TAPI_TEST_RESULT_PASSED;
+}
+
+e_tapi_test_result_t test_live_mock() {
+    /* arrange; threads keep calling through the call site and the got slot. */
+    tapi_mock_set_live(true);
+    tapi_mock_t* mocks[2] = { tapi_mock_create(live_caller, live_target, mock_live_target),
+                              tapi_mock_create_got("getpid", mock_getpid) };
+    int pid = getpid();
+    pthread_t threads[4];
+    for (size_t i = 0u; i < 4u; i++)
+        pthread_create(&threads[i], 0x0, live_worker, &pid);
+
+    /* act; the mocks are applied and restored under them. */
+    for (size_t i = 0u; i < 200u; i++) {
+        tapi_mock_apply_all(mocks, 2u);
+        tapi_mock_restore_all(mocks, 2u);
+    }
+    __atomic_store_n(&live_stop, 1, __ATOMIC_RELEASE);
+    for (size_t i = 0u; i < 4u; i++)
+        pthread_join(threads[i], 0x0);
+    tapi_mock_set_live(false);
+
+    /* assert; nobody ran half a patch, and everything was restored. */
+    tapi_assert(live_wrong == 0);
+    tapi_assert(live_caller(2) == 6);
+    tapi_assert(getpid() == pid);
+    return E_TAPI_TEST_RESULT_PASSED;
+}
+
+e_tapi_test_result_t test_live_entry_mock() {
+    /* arrange; threads keep running through the entry, which can't be a single store. */
+    tapi_mock_t* mock = tapi_mock_create_entry(live_entry_target, mock_live_entry_target);
+    tapi_assert(mock != 0x0);
+    tapi_mock_set_live(true);
+    pthread_t threads[4];
+    for (size_t i = 0u; i < 4u; i++)
+        pthread_create(&threads[i], 0x0, live_entry_worker, 0x0);
+
+    /* act; the entry is written with every other thread stopped, and put back the same way. */
+    for (size_t i = 0u; i < 50u; i++) {
+        tapi_mock_apply(mock);
+        tapi_mock_restore(mock);
+    }
+    __atomic_store_n(&live_entry_stop, 1, __ATOMIC_RELEASE);
+    for (size_t i = 0u; i < 4u; i++)
+        pthread_join(threads[i], 0x0);
+    tapi_mock_set_live(false);
+
+    /* assert; nobody ran into half an entry patch, and the original still runs. */
+    int (*original)(int) = (int (*)(int)) mock->original;
+    tapi_assert(live_entry_wrong == 0);
+    tapi_assert(live_entry_target(2) == 10);
+    tapi_assert(original(2) == 10);
+    return E_TAPI_TEST_RESULT_PASSED;
+}
+
+e_tapi_test_result_t test_dispatch_mock() {
+    /* arrange; two threads mock the same target differently, this one doesn't at all. */
+    tapi_mock_t* a = tapi_mock_create_dispatch(dispatch_target, mock_dispatch_a);
+    tapi_mock_t* b = tapi_mock_create_dispatch(dispatch_target, mock_dispatch_b);
+    tapi_assert(a != 0x0 && b != 0x0);
+    dispatch_run_t runs[2] = { { a, 101, 0 }, { b, 201, 0 } };
+    pthread_t threads[2];
+
+    /* act. */
+    for (size_t i = 0u; i < 2u; i++)
+        pthread_create(&threads[i], 0x0, dispatch_worker, &runs[i]);
+    int wrong = 0;
+    for (int i = 0; i < 100000; i++)
+        wrong += dispatch_caller(3) != 7;
+    for (size_t i = 0u; i < 2u; i++)
+        pthread_join(threads[i], 0x0);
+
+    /* assert; every thread only ever saw its own mock. */
+    tapi_assert(runs[0].wrong == 0 && runs[1].wrong == 0 && wrong == 0);
+    tapi_assert(dispatch_caller(3) == 7);
+
+    /* mocks stacked on one thread unwind in order. */
+    tapi_mock_apply(a);
+    tapi_mock_apply(b);
+    tapi_assert(dispatch_caller(3) == 201);
+    tapi_mock_restore(b);
+    tapi_assert(dispatch_caller(3) == 101);
+    tapi_mock_restore(a);
+    tapi_assert(dispatch_caller(3) == 7);
+    return E_TAPI_TEST_RESULT_PASSED;
+}
+
+e_tapi_test_result_t test_threaded_create() {
+    /* arrange; what a mock made by a single thread looks like. */
+    tapi_mock_t* mock = tapi_mock_create(multi_caller, multi_target, mock_multi_target);
+    tapi_assert(mock != 0x0);
+    create_run_t runs[4];
+    pthread_t threads[4];
+
+    /* act; every thread allocates from the same internal arena at once. */
+    for (size_t i = 0u; i < 4u; i++) {
+        runs[i] = (create_run_t) { mock, 0 };
+        pthread_create(&threads[i], 0x0, create_worker, &runs[i]);
+    }
+    for (size_t i = 0u; i < 4u; i++)
+        pthread_join(threads[i], 0x0);
+
+    /* assert; every mock was whole, and the calls weren't touched. */
+    for (size_t i = 0u; i < 4u; i++)
+        tapi_assert(runs[i].wrong == 0);
+    tapi_assert(multi_caller(3) == 3);
+    return E_TAPI_TEST_RESULT_PASSED;
+}
+
+e_tapi_test_result_t test_spy_mock() {
+    /* act; the calls still go to the target. */
+    tapi_assert(spy_mock != 0x0);
+    int result = spy_caller(3);
+
+    /* assert; every call was counted, with its arguments. */
+    tapi_assert(result == 33);
+    tapi_assert_calls(spy_mock, 3u);
+    tapi_assert(tapi_spy_site_count(spy_mock, 0u) == 3u);
+    tapi_assert_arg_sequence(spy_mock, 0u, 0u, 1u, 2u);
+    tapi_assert_arg_sequence(spy_mock, 1u, 0u, 10u, 20u);
+    tapi_assert_call_arg(spy_mock, 2u, 1u, 20u);
+    tapi_assert(!tapi_spy_called_with(spy_mock, 3u, 0u, 3u));
+
+    /* and forgotten once reset. */
+    tapi_spy_reset(spy_mock);
+    tapi_assert_calls(spy_mock, 0u);
+    tapi_assert(spy_caller(1) == 0);
+    tapi_assert_arg_sequence(spy_mock, 1u, 0u);
+    return E_TAPI_TEST_RESULT_PASSED;
+}
+
+e_tapi_test_result_t test_far_mock() {
+    if (far_mock == 0x0)
+        return E_TAPI_TEST_RESULT_SKIPPED;
+
+    /* act & assert; the call goes through a veneer near it. */
+    tapi_assert(far_caller(1) == 78);
+    return E_TAPI_TEST_RESULT_PASSED;
+}
+
+e_tapi_test_result_t test_bench_isolated_mock() {
+    /* arrange. */
+    tapi_bench_t* bench = tapi_bench_make("bench_expensive_caller", bench_expensive_caller);
+    bench->repetitions = 8u;
+    bench->iterations = 200u;
+    tapi_bench_add_mock(bench, expensive_caller, expensive_target, mock_expensive_target);
+    tapi_bench_add(bench);
+
+    /* act. */
+    tapi_quick_capture(stdout, 4096u);
+    int status = tapi_bench_run();
+    tapi_quick_end_capture();
+
+    /* the bench goes before any assert can return, its mock would outlive the test. */
+    double stubbed = bench->stats.median, real = bench->real.median;
+    tapi_bench_remove(bench);
+    tapi_bench_destroy(&bench, 1u);
+
+    /* assert; the stubbed dependency is cheaper, and restored once the run ends. */
+    tapi_assert(status == 0);
+    tapi_assert(stubbed < real);
+    tapi_assert(strstr(sink->buffer.data, "with real dependencies") != 0x0);
+    tapi_assert(expensive_caller(41) == 42);
+    tapi_quick_destroy_capture();
+    return E_TAPI_TEST_RESULT_PASSED;
+}
 #pragma endregion
 
 int main() {
@@ -203,18 +966,54 @@ int main() {
     tapi_test_t* test4 = tapi_test_make("test_asm_thumb_mock", test_asm_thumb_mock);
     tapi_test_add_mock(test4, asm_caller_thumb, asm_target_thumb, mock_asm_target_thumb);
 #endif
+    tapi_test_t* test_indirect = tapi_test_make("test_indirect_mock", test_indirect_mock);
+    tapi_test_add_mock(test_indirect, indirect_caller, indirect_target, mock_indirect_target);
     tapi_test_t* test_nested = tapi_test_make("test_nested_mock", test_nested_mock);
     tapi_test_add_mock(test_nested, nested_middle, nested_target, mock_nested_target);
     tapi_test_t* test_cond = tapi_test_make("test_conditional_mock", test_conditional_mock);
     tapi_test_add_mock(test_cond, conditional_caller, conditional_target, mock_conditional_target);
+    tapi_test_t* test_multi = tapi_test_make("test_multi_site_mock", test_multi_site_mock);
+    tapi_test_add_mock(test_multi, multi_caller, multi_target, mock_multi_target);
+    tapi_test_t* test_restored = tapi_test_make("test_multi_site_restored",
+                                                test_multi_site_restored);
+    tapi_test_t* test_all = tapi_test_make("test_mock_all_callers", test_mock_all_callers);
+    tapi_test_add_mock_all(test_all, shared_target, mock_shared_target);
+    tapi_test_t* test_stacked = tapi_test_make("test_stacked_restore", test_stacked_restore);
+    tapi_test_t* test_changed = tapi_test_make("test_changed_restore", test_changed_restore);
+    tapi_test_t* test_entry = tapi_test_make("test_entry_mock", test_entry_mock);
+    entry_mock = tapi_test_add_mock_entry(test_entry, entry_target, mock_entry_target);
+    tapi_test_t* test_entry_back = tapi_test_make("test_entry_restored", test_entry_restored);
+    tapi_test_t* test_relocated = tapi_test_make("test_entry_relocated", test_entry_relocated);
+    tapi_test_t* test_got = tapi_test_make("test_got_mock", test_got_mock);
+    got_mock = tapi_test_add_mock_got(test_got, "getpid", mock_getpid);
+    tapi_test_t* test_got_back = tapi_test_make("test_got_restored", test_got_restored);
+    tapi_test_t* test_live = tapi_test_make("test_live_mock", test_live_mock);
+    tapi_test_t* test_live_entry = tapi_test_make("test_live_entry_mock", test_live_entry_mock);
+    tapi_test_t* test_dispatch = tapi_test_make("test_dispatch_mock", test_dispatch_mock);
+    tapi_test_t* test_create = tapi_test_make("test_threaded_create", test_threaded_create);
+    tapi_test_t* test_spy = tapi_test_make("test_spy_mock", test_spy_mock);
+    spy_mock = tapi_test_add_mock_spy(test_spy, spy_caller, spy_target, 0x0);
+    tapi_test_t* test_far = tapi_test_make("test_far_mock", test_far_mock);
+    far_mock = far_mock_map();
+    if (far_mock != 0x0)
+        tapi_test_add_mock(test_far, far_caller, far_target, far_mock);
+    tapi_test_t* test_bench = tapi_test_make("test_bench_isolated_mock", test_bench_isolated_mock);
 
     /* setup test array. */
 #if defined(__arm__)
-    tapi_test_t* tests[] = { test1, test2, test4, test_nested, test_cond };
-    tapi_test_setup(tests, 5u);
+    tapi_test_t* tests[] = { test1, test2, test4, test_indirect, test_nested, test_cond,
+                             test_multi, test_restored, test_all, test_stacked, test_changed,
+                             test_entry, test_entry_back, test_relocated, test_got, test_got_back,
+                             test_live, test_live_entry, test_dispatch, test_create, test_spy,
+                             test_far, test_bench };
+    tapi_test_setup(tests, 23u);
 #else
-    tapi_test_t* tests[] = { test1, test2, test_nested, test_cond };
-    tapi_test_setup(tests, 4u);
+    tapi_test_t* tests[] = { test1, test2, test_indirect, test_nested, test_cond, test_multi,
+                             test_restored, test_all, test_stacked, test_changed, test_entry,
+                             test_entry_back, test_relocated, test_got, test_got_back, test_live,
+                             test_live_entry, test_dispatch, test_create, test_spy, test_far,
+                             test_bench };
+    tapi_test_setup(tests, 22u);
 #endif
     tapi_test_run();
     return 0;